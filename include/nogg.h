@@ -31,6 +31,13 @@ extern "C" {
  */
 typedef struct vorbis_t vorbis_t;
 
+/**
+ * vorbis_mux_t:  Type of a demultiplexer handle, used to decode several
+ * Vorbis streams interleaved in a single Ogg file (see the "Decoding
+ * multiplexed streams" section below).
+ */
+typedef struct vorbis_mux_t vorbis_mux_t;
+
 
 /**
  * vorbis_callbacks_t:  Structure containing callbacks for reading from a
@@ -117,6 +124,18 @@ typedef struct vorbis_callbacks_t {
 } vorbis_callbacks_t;
 
 
+/**
+ * vorbis_stats_t:  Structure holding signal statistics for a single
+ * channel, as returned by vorbis_analyze().
+ */
+typedef struct vorbis_stats_t {
+    /* Peak (maximum absolute) sample value. */
+    float peak;
+    /* Root-mean-square sample value. */
+    float rms;
+} vorbis_stats_t;
+
+
 /**
  * vorbis_error_t:  Type of error codes returned from vorbis_*() functions.
  */
@@ -151,6 +170,11 @@ typedef enum vorbis_error_t {
     /* A read operation attempted to read past the end of the stream
      * (for a packet-submission decoder, past the end of the packet). */
     VORBIS_ERROR_STREAM_END = 103,
+    /* The audio format of a chained stream changed at the start of a new
+     * link (see VORBIS_OPTION_CHAINED_STREAMS).  All data from the
+     * previous link has been returned, and subsequent read operations
+     * will return data in the new format. */
+    VORBIS_ERROR_STREAM_CHANGED = 104,
 
     /*---- Error codes for decode-time errors ----*/
 
@@ -169,18 +193,24 @@ typedef enum vorbis_error_t {
  * VORBIS_OPTION_*:  Option flags for vorbis_open_*().
  */
 
-/* Use the given number of bits (0-24) for direct lookup of Huffman codes.
- * More bits increases the number of codes which can be looked up without
- * a full search, but also requires more memory (2^n entries, where one
- * entry is 2 bytes).  A value of zero disables the accelerated lookup;
- * invalid values (greater than 24) are treated as the default.  The
- * default is 10. */
+/* Use the given number of bits (0-24) as the nominal size of the tables
+ * used for direct lookup of Huffman codes.  More bits increases the number
+ * of codes which can be looked up without a full search, but also
+ * requires more memory (up to 2^n entries per codebook on average, where
+ * one entry is 2 bytes).  The size of each table is chosen based on the
+ * codes in the corresponding codebook: codebooks with only short codes use
+ * smaller tables, and codebooks with many long codes may use tables up to
+ * 4 bits larger if memory saved on other tables permits.  A value of zero
+ * disables the accelerated lookup, including the secondary lookup tables
+ * for longer codes; invalid values (greater than 24) are treated as the
+ * default.  The default is 10. */
 #define VORBIS_OPTION_FAST_HUFFMAN_LENGTH(n)    (1U << 5 | ((n) & 31))
 
-/* Disable binary search of Huffman codes not found in the direct lookup
- * table, using a simple linear search instead.  This is a size/speed
- * tradeoff, reducing performance in exchange for not needing to store an
- * extra sorted copy of the Huffman table. */
+/* Disable table-driven lookup of Huffman codes not found in the direct
+ * lookup table, using a simple linear search instead.  This is a
+ * size/speed tradeoff, reducing performance in exchange for not needing
+ * to store an extra sorted copy of the Huffman table and its secondary
+ * lookup tables. */
 #define VORBIS_OPTION_NO_HUFFMAN_BINARY_SEARCH  (1U << 6)
 
 /* Disable precomputation of the result of scalar residue decoding.  This
@@ -203,10 +233,58 @@ typedef enum vorbis_error_t {
 
 /* Indicate that the caller will only request samples in 16-bit integer
  * format.  This improves performance and slightly reduces memory usage,
- * but calling vorbis_read_float() on a handle created with this option set
- * will fail. */
+ * but calling vorbis_read_float(), vorbis_read_int24(), or
+ * vorbis_read_int32() on a handle created with this option set will
+ * fail.  At most one of the VORBIS_OPTION_READ_*_ONLY options may be
+ * given; if more than one is set, the open call fails with
+ * VORBIS_ERROR_INVALID_ARGUMENT. */
 #define VORBIS_OPTION_READ_INT16_ONLY           (1U << 10)
 
+/* Apply triangular (TPDF) dither with an amplitude of +/-1 LSB when
+ * converting decoded audio to 16-bit integer samples.  This decorrelates
+ * quantization error from the signal at the cost of a slight increase in
+ * the noise floor.  The option affects vorbis_read_int16() (including
+ * when VORBIS_OPTION_READ_INT16_ONLY is set) but not the other read
+ * functions. */
+#define VORBIS_OPTION_DITHER_INT16              (1U << 11)
+
+/* Indicate that the caller will only request samples in packed 24-bit or
+ * 32-bit integer format, respectively.  As with
+ * VORBIS_OPTION_READ_INT16_ONLY, decoded audio is converted to the
+ * requested format as it is interleaved, so no separate conversion pass
+ * is needed when reading; calling any other read function on a handle
+ * created with one of these options set will fail. */
+#define VORBIS_OPTION_READ_INT24_ONLY           (1U << 12)
+#define VORBIS_OPTION_READ_INT32_ONLY           (1U << 13)
+
+/* Decode chained (concatenated) streams.  Without this option, decoding
+ * stops at the end of the first Ogg Vorbis bitstream in the stream.  With
+ * this option, when a bitstream ends and is followed by the start of a
+ * new Vorbis bitstream, the decoder reads the new bitstream's headers and
+ * continues decoding.  If the new bitstream has the same channel count
+ * and sampling rate, the transition is seamless; otherwise, the read
+ * operation which reaches the end of the previous bitstream returns
+ * VORBIS_ERROR_STREAM_CHANGED, vorbis_channels() and vorbis_rate() are
+ * updated to the new format, and any settings made with
+ * vorbis_set_output_rate(), vorbis_set_downmix(), or
+ * vorbis_set_channel_mask() are cleared.  (Settings are also cleared if
+ * the new bitstream uses larger blocks than the previous one while the
+ * output is being resampled.)  In either case, sample positions returned
+ * by vorbis_tell() continue across the transition.  Seeking is not
+ * supported on a handle opened with this option, and vorbis_length()
+ * always returns -1. */
+#define VORBIS_OPTION_CHAINED_STREAMS           (1U << 14)
+
+
+/**
+ * VORBIS_RESAMPLE_QUALITY_*:  Quality settings for vorbis_set_output_rate().
+ * Higher quality settings use longer filters, giving a sharper cutoff
+ * and better stopband rejection at the cost of more computation.
+ */
+#define VORBIS_RESAMPLE_QUALITY_LOW     0  // 8-tap filter.
+#define VORBIS_RESAMPLE_QUALITY_MEDIUM  1  // 16-tap filter.
+#define VORBIS_RESAMPLE_QUALITY_HIGH    2  // 32-tap filter.
+
 /*************************************************************************/
 /**************** Interface: Library version information *****************/
 /*************************************************************************/
@@ -290,10 +368,10 @@ extern vorbis_t *vorbis_open_file(
  * Decoders created using this function will not attempt to parse an Ogg
  * stream; instead, the caller is expected to submit sequential Vorbis
  * packets through the vorbis_submit_packet() function.  Audio data can be
- * read through the usual vorbis_read_int16() and vorbis_read_float()
- * functions, which will return 0 with the error VORBIS_ERROR_STREAM_END
- * once all data has been read from the packet.  The caller must read all
- * audio data from one packet before submitting the next packet.
+ * read through the usual vorbis_read_*() functions, which will return 0
+ * with the error VORBIS_ERROR_STREAM_END once all data has been read from
+ * the packet.  The caller must read all audio data from one packet before
+ * submitting the next packet.
  *
  * The Vorbis header packets should not be submitted via
  * vorbis_submit_packet(); instead, the identification and setup header
@@ -304,7 +382,9 @@ extern vorbis_t *vorbis_open_file(
  * with packet-submission decoders:
  *    - vorbis_length() (always returns -1)
  *    - vorbis_bitrate() (returns 0 if no bitrate found in the ID packet)
- *    - vorbis_seek() (always returns false)
+ *    - vorbis_seek() (always returns false; use vorbis_packet_reset()
+ *      to resume decoding at a different packet)
+ *    - vorbis_skip() (always fails with VORBIS_ERROR_INVALID_OPERATION)
  *
  * This interface is useful when decoding Vorbis data stored in something
  * other than an Ogg container, such as audio from a WebM file.
@@ -345,6 +425,9 @@ extern void vorbis_close(vorbis_t *handle);
 
 /**
  * vorbis_channels:  Return the number of channels in the given stream.
+ * If a downmix has been configured with vorbis_set_downmix(), this is the
+ * number of output channels rather than the number of channels encoded
+ * in the stream.
  *
  * [Parameters]
  *     handle: Handle to operate on.
@@ -356,6 +439,9 @@ extern int vorbis_channels(const vorbis_t *handle);
 /**
  * vorbis_rate:  Return the sampling rate of the given stream.
  *
+ * If an output rate has been set with vorbis_set_output_rate(), this
+ * function returns that rate rather than the rate of the stream itself.
+ *
  * Note that the returned value is unsigned, to match the Vorbis
  * specification.  Sampling rates of 2^31 or greater are not likely to
  * occur in real-world streams but are permitted by the specification,
@@ -378,6 +464,9 @@ extern uint32_t vorbis_rate(const vorbis_t *handle);
  * is cached so that subsequent calls on the same stream will return
  * immediately.
  *
+ * If an output rate has been set with vorbis_set_output_rate(), the
+ * returned length is the number of samples at the output rate.
+ *
  * [Parameters]
  *     handle: Handle to operate on.
  * [Return value]
@@ -414,6 +503,108 @@ extern int64_t vorbis_length(const vorbis_t *handle);
  */
 extern int32_t vorbis_bitrate(const vorbis_t *handle);
 
+/*************************************************************************/
+/******************* Interface: Configuring PCM output *******************/
+/*************************************************************************/
+
+/**
+ * vorbis_set_output_rate:  Resample decoded audio data to the given
+ * sampling rate.  Resampling is performed on each decoded frame before
+ * the data is returned by the vorbis_read_*() functions, using a
+ * polyphase windowed-sinc filter whose length is selected by the quality
+ * parameter.
+ *
+ * When an output rate is set, all sample positions and counts reported or
+ * accepted by the library (such as the values used by vorbis_seek(),
+ * vorbis_tell(), and vorbis_length()) are in units of output samples.
+ * After a seek, the resampling filter is primed with audio data preceding
+ * the seek position, so the returned data is identical to that which
+ * would have been returned by reading continuously from the beginning of
+ * the stream.  For packet-mode decoders, the final samples held in the
+ * filter delay line are not returned, since the end of the stream is not
+ * known.
+ *
+ * This function may only be called before any audio data has been
+ * decoded; otherwise it fails with VORBIS_ERROR_INVALID_OPERATION.  The
+ * input and output rates must both be no greater than 1048576 Hz, and
+ * must not differ by more than a factor of 16.
+ *
+ * [Parameters]
+ *     handle: Handle to operate on.
+ *     rate: Output sampling rate, in Hz.  If zero or equal to the stream's
+ *         sampling rate, resampling is disabled.
+ *     quality: Resampling quality (VORBIS_RESAMPLE_QUALITY_*).
+ *     error_ret: Pointer to variable to receive the error code from the
+ *         operation (always VORBIS_NO_ERROR on success).  May be NULL if
+ *         the error code is not needed.
+ * [Return value]
+ *     True on success, false on error.
+ */
+extern int vorbis_set_output_rate(vorbis_t *handle, uint32_t rate,
+                                  int quality, vorbis_error_t *error_ret);
+
+/**
+ * vorbis_set_downmix:  Mix the stream's channels down to a smaller number
+ * of output channels using the given matrix.  Output channel o of each
+ * sample is computed as the sum over all stream channels c of
+ * matrix[o*N+c] times the value of channel c, where N is the number of
+ * channels in the stream.  No clipping is performed on the mixed data
+ * other than the usual clamping when converting to integer formats.
+ *
+ * The mix is applied to each decoded (and, if applicable, resampled)
+ * frame before the data is interleaved, so the vorbis_read_*() functions
+ * return interleaved data with the given number of output channels, and
+ * vorbis_channels() returns that number.  The matrix is copied, so the
+ * caller may free it after this function returns.
+ *
+ * This function may only be called before any audio data has been
+ * decoded; otherwise it fails with VORBIS_ERROR_INVALID_OPERATION.
+ *
+ * [Parameters]
+ *     handle: Handle to operate on.
+ *     channels: Number of output channels (1 through the number of
+ *         channels in the stream), or zero to disable downmixing.
+ *     matrix: Mixing coefficients (channels rows of N values each).
+ *         Ignored if channels is zero.
+ *     error_ret: Pointer to variable to receive the error code from the
+ *         operation (always VORBIS_NO_ERROR on success).  May be NULL if
+ *         the error code is not needed.
+ * [Return value]
+ *     True on success, false on error.
+ */
+extern int vorbis_set_downmix(vorbis_t *handle, int channels,
+                              const float *matrix, vorbis_error_t *error_ret);
+
+/**
+ * vorbis_set_channel_mask:  Select which of the stream's channels are to
+ * be decoded.  Channels not selected are returned as silence, and the
+ * decoder skips as much of the work of reconstructing them as possible.
+ * Channels coupled with a selected channel in the stream (such as the
+ * other channel of a stereo pair) must still be partially decoded, so the
+ * savings depend on how the stream was encoded; the data for all channels
+ * must also still be read from the stream.
+ *
+ * This function may be called at any time.  If a channel is newly
+ * selected while decoding, the first frame of that channel returned after
+ * the call may not be fully reconstructed, since the decoder does not
+ * have the previous frame's data for that channel.  To avoid this, seek
+ * to the desired position after changing the mask.
+ *
+ * [Parameters]
+ *     handle: Handle to operate on.
+ *     mask: Bitmask of channels to decode, with bit N (1<<N) selecting
+ *         channel N.  At least one of the stream's channels must be
+ *         selected.  Channels 64 and above, if any, are always decoded.
+ *         Pass ~0 to decode all channels (the default).
+ *     error_ret: Pointer to variable to receive the error code from the
+ *         operation (always VORBIS_NO_ERROR on success).  May be NULL if
+ *         the error code is not needed.
+ * [Return value]
+ *     True on success, false on error.
+ */
+extern int vorbis_set_channel_mask(vorbis_t *handle, uint64_t mask,
+                                   vorbis_error_t *error_ret);
+
 /*************************************************************************/
 /********** Interface: Setting and getting the decode position ***********/
 /*************************************************************************/
@@ -445,6 +636,37 @@ extern int32_t vorbis_bitrate(const vorbis_t *handle);
  */
 extern int vorbis_seek(vorbis_t *handle, int64_t position);
 
+/**
+ * vorbis_seek_approximate:  Seek to a position near the given sample
+ * index, and return the position actually reached.  The new position is
+ * the beginning of the first complete frame on the Ogg page containing
+ * the requested sample, which is always at or before that sample and is
+ * typically within a few thousand samples of it.
+ *
+ * Unlike vorbis_seek(), this function does not need to scan forward to
+ * the exact sample or decode the frame preceding it, so it requires
+ * significantly less I/O and processing time.  This makes it suitable
+ * for uses such as scrubbing previews where sample accuracy is not
+ * needed.  (If vorbis_build_frame_map() has been called, the seek is
+ * performed exactly as for vorbis_seek().)
+ *
+ * The caveats documented for vorbis_seek() apply to this function as
+ * well.  This function fails with VORBIS_ERROR_STREAM_NOT_SEEKABLE if
+ * called on an unseekable stream or a handle opened with
+ * vorbis_open_packet().
+ *
+ * [Parameters]
+ *     handle: Handle to operate on.
+ *     position: Position to seek to, in samples.
+ *     error_ret: Pointer to variable to receive the error code from the
+ *         operation (always VORBIS_NO_ERROR on success).  May be NULL if
+ *         the error code is not needed.
+ * [Return value]
+ *     New decode position, in samples, or -1 on failure.
+ */
+extern int64_t vorbis_seek_approximate(vorbis_t *handle, int64_t position,
+                                       vorbis_error_t *error_ret);
+
 /**
  * vorbis_tell:  Return the current decode position, which is the index of
  * the next sample to be returned by one of the vorbis_read_*() functions.
@@ -468,6 +690,247 @@ extern int vorbis_seek(vorbis_t *handle, int64_t position);
  */
 extern int64_t vorbis_tell(const vorbis_t *handle);
 
+/**
+ * vorbis_skip:  Advance the decode position by the given number of
+ * samples, discarding the intervening audio data.  The effect is the same
+ * as reading and discarding that many samples with one of the
+ * vorbis_read_*() functions, but most of the skipped audio is not
+ * actually decoded: the decoder reads only the header of each packet,
+ * and fully decodes only the last few frames before the new position.
+ * This makes it possible to skip quickly through a stream on which
+ * vorbis_seek() cannot be used, such as a stream read from a pipe or
+ * network socket.
+ *
+ * If output resampling has been enabled with vorbis_set_output_rate(),
+ * all skipped audio is decoded normally, so this function offers no
+ * speed advantage over reading the data.
+ *
+ * This function fails with VORBIS_ERROR_INVALID_OPERATION if called on a
+ * handle opened with vorbis_open_packet().
+ *
+ * [Parameters]
+ *     handle: Handle to operate on.
+ *     count: Number of samples to skip.
+ *     error_ret: Pointer to variable to receive the error code from the
+ *         operation (always VORBIS_NO_ERROR if the requested number of
+ *         samples was skipped).  May be NULL if the error code is not
+ *         needed.
+ * [Return value]
+ *     Number of samples skipped.  This will be less than count if the end
+ *     of the stream was reached or a decoding error occurred.
+ */
+extern int64_t vorbis_skip(vorbis_t *handle, int64_t count,
+                           vorbis_error_t *error_ret);
+
+/**
+ * vorbis_build_seek_index:  Scan the entire stream and build an index of
+ * Ogg page positions, so that subsequent seeks can go directly to the
+ * page containing the target sample rather than searching for it.  The
+ * stream length is also determined, so vorbis_length() will return
+ * immediately after this function succeeds.  The current decode position
+ * is not changed.
+ *
+ * Scanning the stream requires reading the header of every page in the
+ * stream, so for large streams this can take significant time; use
+ * vorbis_export_seek_index() and vorbis_load_seek_index() to save the
+ * index and reuse it the next time the stream is opened.  The index
+ * itself is compact, typically requiring 32 bytes of memory and 5-7 bytes
+ * of serialized data per Ogg page.
+ *
+ * This function fails with VORBIS_ERROR_STREAM_NOT_SEEKABLE if called on
+ * an unseekable stream or a handle opened with vorbis_open_packet().
+ *
+ * [Parameters]
+ *     handle: Handle to operate on.
+ *     error_ret: Pointer to variable to receive the error code from the
+ *         operation (always VORBIS_NO_ERROR on success).  May be NULL if
+ *         the error code is not needed.
+ * [Return value]
+ *     True (nonzero) on success, false (zero) on failure.
+ */
+extern int vorbis_build_seek_index(vorbis_t *handle,
+                                   vorbis_error_t *error_ret);
+
+/**
+ * vorbis_export_seek_index:  Serialize the stream's seek index (built
+ * with vorbis_build_seek_index() or loaded with vorbis_load_seek_index())
+ * into a byte buffer.  The format of the data is internal to libnogg,
+ * but is independent of machine word size and byte order.
+ *
+ * The return value is always the number of bytes required to store the
+ * index, so the caller can pass buf = NULL (and size = 0) to obtain the
+ * size of buffer to allocate.  If buf is not NULL but size is smaller
+ * than the required size, nothing is stored and the function fails with
+ * VORBIS_ERROR_INVALID_ARGUMENT (but still returns the required size).
+ * If the handle has no seek index, the function fails with
+ * VORBIS_ERROR_INVALID_OPERATION and returns zero.
+ *
+ * [Parameters]
+ *     handle: Handle to operate on.
+ *     buf: Buffer into which to store the serialized index, or NULL to
+ *         only return the required size.
+ *     size: Size of buf, in bytes.
+ *     error_ret: Pointer to variable to receive the error code from the
+ *         operation (always VORBIS_NO_ERROR on success).  May be NULL if
+ *         the error code is not needed.
+ * [Return value]
+ *     Size of the serialized index, in bytes, or zero on error.
+ */
+extern int32_t vorbis_export_seek_index(vorbis_t *handle, void *buf,
+                                        int32_t size,
+                                        vorbis_error_t *error_ret);
+
+/**
+ * vorbis_load_seek_index:  Load a seek index previously serialized with
+ * vorbis_export_seek_index(), replacing any existing index.  The stream
+ * itself is not read, so this function can be called immediately after
+ * opening the stream to make seeks and vorbis_length() calls fast.
+ *
+ * The data is checked against the stream's length and Ogg bitstream
+ * serial number, and for internal consistency; if the data is malformed
+ * or appears to belong to a different stream, the function fails with
+ * VORBIS_ERROR_INVALID_ARGUMENT and the existing index (if any) is left
+ * unchanged.  These checks cannot detect every possible mismatch (for
+ * example, a stream which has been modified in place without changing
+ * its length), so the caller should take care to only load an index for
+ * the stream from which it was exported.
+ *
+ * This function fails with VORBIS_ERROR_STREAM_NOT_SEEKABLE if called on
+ * an unseekable stream or a handle opened with vorbis_open_packet().
+ *
+ * [Parameters]
+ *     handle: Handle to operate on.
+ *     data: Serialized index data.
+ *     size: Size of the data, in bytes.
+ *     error_ret: Pointer to variable to receive the error code from the
+ *         operation (always VORBIS_NO_ERROR on success).  May be NULL if
+ *         the error code is not needed.
+ * [Return value]
+ *     True (nonzero) on success, false (zero) on failure.
+ */
+extern int vorbis_load_seek_index(vorbis_t *handle, const void *data,
+                                  int32_t size, vorbis_error_t *error_ret);
+
+/**
+ * vorbis_build_frame_map:  Scan the entire stream and record the location
+ * and window shape of every audio packet, so that subsequent seeks can
+ * start decoding at exactly the right packet without scanning any data.
+ * This makes sample-accurate seeks considerably cheaper, at a memory cost
+ * of 24 bytes per packet (roughly 60-120 kilobytes per minute of 44.1kHz
+ * audio, depending on the encoder's choice of block sizes).  The current
+ * decode position is not changed.
+ *
+ * Like vorbis_build_seek_index(), this function reads the entire stream,
+ * so it can take significant time for large streams.
+ *
+ * This function fails with VORBIS_ERROR_STREAM_NOT_SEEKABLE if called on
+ * an unseekable stream or a handle opened with vorbis_open_packet().
+ *
+ * [Parameters]
+ *     handle: Handle to operate on.
+ *     error_ret: Pointer to variable to receive the error code from the
+ *         operation (always VORBIS_NO_ERROR on success).  May be NULL if
+ *         the error code is not needed.
+ * [Return value]
+ *     True (nonzero) on success, false (zero) on failure.
+ */
+extern int vorbis_build_frame_map(vorbis_t *handle, vorbis_error_t *error_ret);
+
+/**
+ * vorbis_set_probe_window:  Set the amount of data read from the stream
+ * at each probe point while searching for the target page of a seek.
+ * By default, page searches read the stream in small pieces as needed,
+ * which can result in many separate read calls for each probe; this is
+ * costly when each read has a high fixed latency, such as for data
+ * fetched over a network.  When a probe window is set, each probe instead
+ * reads the given number of bytes with a single read call, and the data
+ * is retained so that probes falling within the same window (as is
+ * typical in the final steps of a search) require no further reads.
+ *
+ * A window of 32-64 kilobytes is usually enough to hold several pages of
+ * audio data.  Passing a size of zero restores the default behavior.
+ *
+ * This function fails with VORBIS_ERROR_STREAM_NOT_SEEKABLE if called on
+ * an unseekable stream or a handle opened with vorbis_open_packet().
+ *
+ * [Parameters]
+ *     handle: Handle to operate on.
+ *     size: Probe window size, in bytes (0 through 16777216), or zero to
+ *         disable buffered probing.
+ *     error_ret: Pointer to variable to receive the error code from the
+ *         operation (always VORBIS_NO_ERROR on success).  May be NULL if
+ *         the error code is not needed.
+ * [Return value]
+ *     True (nonzero) on success, false (zero) on failure.
+ */
+extern int vorbis_set_probe_window(vorbis_t *handle, int32_t size,
+                                   vorbis_error_t *error_ret);
+
+/**
+ * vorbis_snapshot:  Save the current decode state of the stream into a
+ * caller-supplied buffer, so that decoding can later be returned to the
+ * current position with vorbis_restore().  This is intended for looping
+ * playback: restoring a snapshot taken at the loop point requires no
+ * page search and no decoding, and the audio returned after the restore
+ * is identical to that returned after the snapshot was taken.
+ *
+ * The snapshot includes the overlap data from the most recently decoded
+ * frame and any decoded audio data which has not yet been read, so its
+ * size depends on the stream's block size, channel count, and position;
+ * it is typically a few kilobytes per channel.  As with
+ * vorbis_export_seek_index(), the return value is always the required
+ * size, so the caller can pass buf = NULL (and size = 0) to obtain the
+ * size of buffer to allocate.  If buf is not NULL but size is smaller than
+ * the required size, nothing is stored and the function fails with
+ * VORBIS_ERROR_INVALID_ARGUMENT (but still returns the required size).
+ *
+ * The snapshot data is only valid for the handle from which it was taken
+ * (or another handle opened on the same stream with the same options),
+ * and only within the same process.
+ *
+ * This function fails with VORBIS_ERROR_STREAM_NOT_SEEKABLE if called on
+ * an unseekable stream or a handle opened with vorbis_open_packet(), and
+ * with VORBIS_ERROR_INVALID_OPERATION if an output rate has been set with
+ * vorbis_set_output_rate().
+ *
+ * [Parameters]
+ *     handle: Handle to operate on.
+ *     buf: Buffer into which to store the snapshot, or NULL to only
+ *         return the required size.
+ *     size: Size of buf, in bytes.
+ *     error_ret: Pointer to variable to receive the error code from the
+ *         operation (always VORBIS_NO_ERROR on success).  May be NULL if
+ *         the error code is not needed.
+ * [Return value]
+ *     Size of the snapshot, in bytes, or zero on error.
+ */
+extern int32_t vorbis_snapshot(vorbis_t *handle, void *buf, int32_t size,
+                               vorbis_error_t *error_ret);
+
+/**
+ * vorbis_restore:  Return the stream to the decode position saved with
+ * vorbis_snapshot().  The stream is repositioned with the "seek"
+ * callback, but no data is read until audio data is next requested.
+ * Any unread audio data from before the call is discarded.
+ *
+ * This function fails with VORBIS_ERROR_INVALID_ARGUMENT if the data is
+ * not a valid snapshot for this handle, and otherwise under the same
+ * conditions as vorbis_snapshot().
+ *
+ * [Parameters]
+ *     handle: Handle to operate on.
+ *     buf: Buffer containing snapshot data.
+ *     size: Size of the snapshot data, in bytes (as returned from
+ *         vorbis_snapshot()).
+ *     error_ret: Pointer to variable to receive the error code from the
+ *         operation (always VORBIS_NO_ERROR on success).  May be NULL if
+ *         the error code is not needed.
+ * [Return value]
+ *     True (nonzero) on success, false (zero) on failure.
+ */
+extern int vorbis_restore(vorbis_t *handle, const void *buf, int32_t size,
+                          vorbis_error_t *error_ret);
+
 /*************************************************************************/
 /*********************** Interface: Reading frames ***********************/
 /*************************************************************************/
@@ -477,10 +940,10 @@ extern int64_t vorbis_tell(const vorbis_t *handle);
  * packet-submission decoder.  The packet will be immediately decoded.
  *
  * This function may only be called when all audio data from the preceding
- * frame (if any) has been read with vorbis_read_int16() or
- * vorbis_read_float().  Calling this function while unread audio data is
- * pending will result in a VORBIS_ERROR_INVALID_OPERATION error, and the
- * submitted packet will be ignored.
+ * frame (if any) has been read with the vorbis_read_*() functions.
+ * Calling this function while unread audio data is pending will result in
+ * a VORBIS_ERROR_INVALID_OPERATION error, and the submitted packet will be
+ * ignored.
  *
  * This function has no effect (and always returns false with a
  * VORBIS_ERROR_INVALID_OPERATION error) when called on a decoder which
@@ -499,6 +962,35 @@ extern int64_t vorbis_tell(const vorbis_t *handle);
 extern int vorbis_submit_packet(vorbis_t *handle, const void *packet,
                                 int32_t packet_len, vorbis_error_t *error_ret);
 
+/**
+ * vorbis_packet_reset:  Reset the decoding state of a packet-submission
+ * decoder so that decoding can resume at an arbitrary packet in the
+ * stream, such as after the caller seeks within a container file.  The
+ * stream's setup data is retained, so this is much cheaper than closing
+ * and reopening the handle.
+ *
+ * After this call, the next packet submitted with vorbis_submit_packet()
+ * is used only to prime the decoder, and any audio data it produces is
+ * discarded.  To obtain audio starting from a given packet, the caller
+ * should first submit the packet immediately preceding it.  Any unread
+ * audio data from before the reset is also discarded.
+ *
+ * This function fails with VORBIS_ERROR_INVALID_OPERATION if called on a
+ * handle not opened with vorbis_open_packet().
+ *
+ * [Parameters]
+ *     handle: Handle to operate on.
+ *     position: Sample position to be returned by vorbis_tell() for the
+ *         first sample decoded after the reset.  Must be nonnegative.
+ *     error_ret: Pointer to variable to receive the error code from the
+ *         operation (always VORBIS_NO_ERROR on success).  May be NULL if
+ *         the error code is not needed.
+ * [Return value]
+ *     True (nonzero) on success, false (zero) on failure.
+ */
+extern int vorbis_packet_reset(vorbis_t *handle, int64_t position,
+                               vorbis_error_t *error_ret);
+
 /**
  * vorbis_read_int16:  Decode and return up to the given number of PCM
  * samples as 16-bit signed integers in the range [-32767,+32767].
@@ -511,6 +1003,10 @@ extern int vorbis_submit_packet(vorbis_t *handle, const void *packet,
  * samples starting from the point at which the decoder recovered from the
  * error.
  *
+ * If the decoder was created with the VORBIS_OPTION_READ_INT24_ONLY or
+ * VORBIS_OPTION_READ_INT32_ONLY option set, this function will fail with
+ * VORBIS_ERROR_INVALID_OPERATION.
+ *
  * [Parameters]
  *     handle: Handle to operate on.
  *     buf: Buffer into which to store decoded audio data.
@@ -540,7 +1036,8 @@ extern int32_t vorbis_read_int16(
  * samples starting from the point at which the decoder recovered from the
  * error.
  *
- * If the decoder was created with the VORBIS_OPTION_READ_INT16_ONLY option
+ * If the decoder was created with the VORBIS_OPTION_READ_INT16_ONLY,
+ * VORBIS_OPTION_READ_INT24_ONLY, or VORBIS_OPTION_READ_INT32_ONLY option
  * set, this function will fail with VORBIS_ERROR_INVALID_ARGUMENT.
  *
  * [Parameters]
@@ -556,6 +1053,242 @@ extern int32_t vorbis_read_int16(
 extern int32_t vorbis_read_float(
     vorbis_t *handle, float *buf, int32_t len, vorbis_error_t *error_ret);
 
+/**
+ * vorbis_read_int24:  Decode and return up to the given number of PCM
+ * samples as packed 24-bit signed integers in the range
+ * [-8388607,+8388607].  Each sample is stored as 3 bytes in little-endian
+ * order (regardless of the native byte order), so the buffer must have
+ * room for len * vorbis_channels(handle) * 3 bytes.  Multichannel audio
+ * data is stored with channels interleaved.
+ *
+ * Error handling is the same as for vorbis_read_int16().
+ *
+ * If the decoder was created with the VORBIS_OPTION_READ_INT16_ONLY or
+ * VORBIS_OPTION_READ_INT32_ONLY option set, this function will fail with
+ * VORBIS_ERROR_INVALID_OPERATION.
+ *
+ * [Parameters]
+ *     handle: Handle to operate on.
+ *     buf: Buffer into which to store decoded audio data.
+ *     len: Number of samples (per channel) to read.
+ *     error_ret: Pointer to variable to receive the error code from the
+ *         operation (or VORBIS_NO_ERROR if no error was encountered).
+ *         May be NULL if the error code is not needed.
+ * [Return value]
+ *     Number of samples successfully read.
+ */
+extern int32_t vorbis_read_int24(
+    vorbis_t *handle, uint8_t *buf, int32_t len, vorbis_error_t *error_ret);
+
+/**
+ * vorbis_read_int32:  Decode and return up to the given number of PCM
+ * samples as 32-bit signed integers in the range
+ * [-2147483647,+2147483647].  Multichannel audio data is stored with
+ * channels interleaved.
+ *
+ * As for vorbis_read_int16() and vorbis_read_int24(), full-scale sample
+ * values of -1.0 and +1.0 map to the minimum and maximum of the output
+ * range, so the scale factor is 2^31-1.
+ *
+ * Error handling is the same as for vorbis_read_int16().
+ *
+ * If the decoder was created with the VORBIS_OPTION_READ_INT16_ONLY or
+ * VORBIS_OPTION_READ_INT24_ONLY option set, this function will fail with
+ * VORBIS_ERROR_INVALID_OPERATION.
+ *
+ * [Parameters]
+ *     handle: Handle to operate on.
+ *     buf: Buffer into which to store decoded audio data.
+ *     len: Number of samples (per channel) to read.
+ *     error_ret: Pointer to variable to receive the error code from the
+ *         operation (or VORBIS_NO_ERROR if no error was encountered).
+ *         May be NULL if the error code is not needed.
+ * [Return value]
+ *     Number of samples successfully read.
+ */
+extern int32_t vorbis_read_int32(
+    vorbis_t *handle, int32_t *buf, int32_t len, vorbis_error_t *error_ret);
+
+/*************************************************************************/
+/********************** Interface: Analyzing audio ***********************/
+/*************************************************************************/
+
+/**
+ * vorbis_analyze:  Decode the remainder of the stream and compute signal
+ * statistics for it without returning any PCM data.  Statistics are
+ * accumulated directly from the decoder's output, so this is faster than
+ * reading the data with vorbis_read_float() and processing it separately.
+ *
+ * Statistics are computed for each channel over the entire analyzed
+ * region, and optionally also for consecutive blocks of a fixed number of
+ * samples (for example, to draw a waveform overview).  The final block
+ * may be shorter than the others if the stream length is not a multiple
+ * of the block size.  In addition, an approximate loudness value for the
+ * analyzed region is returned in LUFS; this is computed as for ITU-R
+ * BS.1770 but without frequency weighting, channel weighting, or gating,
+ * so it is only a rough guide to perceived loudness.
+ *
+ * Analysis starts at the current decode position (including any data
+ * from a partially read frame) and continues to the end of the stream,
+ * after which the stream is positioned at its end as if all data had been
+ * read.  Decoding errors from which the decoder can recover are skipped
+ * over, and VORBIS_ERROR_DECODE_RECOVERED is returned after the end of the
+ * stream has been reached.  If an unrecoverable decoding error occurs,
+ * analysis stops at that point; the statistics for the data analyzed so
+ * far are still returned.
+ *
+ * If the decoder was created with the VORBIS_OPTION_CHAINED_STREAMS option
+ * set, analysis continues across links with the same audio format, but
+ * stops at the end of a link followed by one with a different format.  In
+ * that case, the statistics cover only the data up to the end of the
+ * current link, the stream is left positioned at the start of the new
+ * link with its format applied (as for the read functions), and
+ * VORBIS_ERROR_STREAM_CHANGED is returned.
+ *
+ * This function may not be called on a decoder created with
+ * vorbis_open_packet() or one for which resampling or downmixing has been
+ * configured; it fails with VORBIS_ERROR_INVALID_OPERATION in those cases.
+ *
+ * [Parameters]
+ *     handle: Handle to operate on.
+ *     stats: Array of vorbis_channels() elements into which to store the
+ *         statistics for each channel.  May be NULL if not needed.
+ *     loudness_ret: Pointer to variable to receive the approximate
+ *         loudness, or -INFINITY if the analyzed data is silent.  May be
+ *         NULL if not needed.
+ *     block_size: Number of samples per block for per-block statistics,
+ *         or zero if per-block statistics are not needed.
+ *     block_stats: Array of max_blocks*vorbis_channels() elements into
+ *         which to store per-block statistics, with statistics for channel
+ *         c of block b stored at index b*vorbis_channels()+c.  Blocks past
+ *         the end of the array are not recorded.  Ignored if block_size
+ *         is zero.
+ *     max_blocks: Number of blocks for which block_stats has space.
+ *     error_ret: Pointer to variable to receive the error code from the
+ *         operation (or VORBIS_NO_ERROR if no error was encountered).
+ *         May be NULL if the error code is not needed.
+ * [Return value]
+ *     Number of samples (per channel) analyzed.
+ */
+extern int64_t vorbis_analyze(
+    vorbis_t *handle, vorbis_stats_t *stats, float *loudness_ret,
+    int32_t block_size, vorbis_stats_t *block_stats, int32_t max_blocks,
+    vorbis_error_t *error_ret);
+
+/*************************************************************************/
+/**************** Interface: Decoding multiplexed streams ****************/
+/*************************************************************************/
+
+/**
+ * vorbis_mux_open_callbacks:  Create a new demultiplexer handle for an Ogg
+ * file containing one or more interleaved (multiplexed) Vorbis streams,
+ * such as a file with several language tracks or separate instrument
+ * stems.  A vorbis_open_*() handle decodes only the first Vorbis stream
+ * in such a file, and decoding every stream that way requires reading
+ * the entire file once per stream.  A demultiplexer instead reads each
+ * Ogg page exactly once and passes its packets to a separate decoder for
+ * the stream to which the page belongs.
+ *
+ * The beginning-of-stream pages and header packets of all streams must
+ * precede the first audio data in the file, as required by the Ogg
+ * specification.  This function reads the headers of all streams;
+ * streams which are not Vorbis streams (such as an Ogg Skeleton stream)
+ * are ignored.  Streams which begin after audio data has started (as in
+ * a chained file) are also ignored.
+ *
+ * The file is read sequentially from the beginning, so only the "read"
+ * callback is used from the set of stream data access callbacks.  As
+ * with vorbis_open_callbacks(), the "close" callback is called when the
+ * demultiplexer handle is closed.
+ *
+ * [Parameters]
+ *     callbacks: Set of callbacks to be used to read the file data and
+ *         allocate memory.
+ *     opaque: Opaque pointer value passed through to the callbacks.
+ *     options: Decoder options (bitwise OR of VORBIS_OPTION_* flags),
+ *         applied to the decoder for each stream.
+ *     error_ret: Pointer to variable to receive the error code from the
+ *         operation (always VORBIS_NO_ERROR on success).  May be NULL if
+ *         the error code is not needed.
+ * [Return value]
+ *     Newly-created handle, or NULL on error.
+ */
+extern vorbis_mux_t *vorbis_mux_open_callbacks(
+    vorbis_callbacks_t callbacks, void *opaque, unsigned int options,
+    vorbis_error_t *error_ret);
+
+/**
+ * vorbis_mux_close:  Close a demultiplexer handle, including the decoder
+ * handles for all of its streams.  After calling this function, the
+ * demultiplexer handle and all handles returned by vorbis_mux_stream()
+ * are no longer valid.
+ *
+ * [Parameters]
+ *     mux: Handle to close.  If NULL, this function does nothing.
+ */
+extern void vorbis_mux_close(vorbis_mux_t *mux);
+
+/**
+ * vorbis_mux_streams:  Return the number of Vorbis streams in the file.
+ *
+ * [Parameters]
+ *     mux: Handle to operate on.
+ * [Return value]
+ *     Number of Vorbis streams (always a positive value).
+ */
+extern int vorbis_mux_streams(const vorbis_mux_t *mux);
+
+/**
+ * vorbis_mux_stream:  Return the decoder handle for the given stream.
+ * Streams are numbered from zero in the order in which they appear in
+ * the file.
+ *
+ * The returned handle behaves like a handle created by
+ * vorbis_open_packet(), except that packets are submitted to it by
+ * vorbis_mux_next() rather than by the caller, and the final frame of the
+ * stream is trimmed to the length indicated by the stream's last page
+ * (unless resampling is enabled).  It may be used with the
+ * vorbis_read_*() functions and other functions which accept
+ * packet-mode handles, but it must not be passed to vorbis_close() or
+ * vorbis_submit_packet().
+ *
+ * [Parameters]
+ *     mux: Handle to operate on.
+ *     index: Stream index (0 <= index < vorbis_mux_streams(mux)).
+ * [Return value]
+ *     Decoder handle for the stream, or NULL if index is out of range.
+ */
+extern vorbis_t *vorbis_mux_stream(const vorbis_mux_t *mux, int index);
+
+/**
+ * vorbis_mux_next:  Read the file up to the next complete audio packet,
+ * decode it, and return the index of the stream to which it belongs.
+ * The decoded audio data can then be read from that stream's handle
+ * (see vorbis_mux_stream()) with the vorbis_read_*() functions, which
+ * return VORBIS_ERROR_STREAM_END once all data from the packet has been
+ * read.
+ *
+ * Any data from the stream's previous packet which has not been read is
+ * discarded, so a caller which only needs some of the streams can simply
+ * ignore the others.  (They are still decoded, however.)
+ *
+ * If the packet cannot be decoded, the index of its stream is still
+ * returned, and the decoder's error code (such as
+ * VORBIS_ERROR_DECODE_RECOVERED) is stored in *error_ret; no audio data
+ * will be available from that stream until its next packet.
+ *
+ * [Parameters]
+ *     mux: Handle to operate on.
+ *     error_ret: Pointer to variable to receive the error code from the
+ *         operation (always VORBIS_NO_ERROR on success).  When the end of
+ *         the file is reached, the error code is VORBIS_ERROR_STREAM_END.
+ *         May be NULL if the error code is not needed.
+ * [Return value]
+ *     Index of the stream which received the packet, or -1 on error or
+ *     at the end of the file.
+ */
+extern int vorbis_mux_next(vorbis_mux_t *mux, vorbis_error_t *error_ret);
+
 /*************************************************************************/
 /*************************************************************************/
 
@@ -0,0 +1,339 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "src/common.h"
+#include "src/util/decode-frame.h"
+#include "src/x86.h"
+
+#include <math.h>
+#include <stddef.h>
+
+#ifdef ENABLE_ASM_ARM_NEON
+# include <arm_neon.h>
+#endif
+
+/*************************************************************************/
+/**************************** Helper routines ****************************/
+/*************************************************************************/
+
+/* Accumulated statistics for the analysis.  The "block" fields hold data
+ * for the current block (or the entire stream if per-block statistics
+ * were not requested); these are merged into the "total" fields when
+ * each block is complete. */
+typedef struct analysis_t {
+    int channels;
+    int32_t block_size;  // INT32_MAX if per-block statistics are not needed.
+    vorbis_stats_t *block_stats;
+    int32_t max_blocks;
+    int32_t block_index;
+    int32_t block_fill;
+    float block_peak[256];
+    double block_sum_sq[256];
+    float total_peak[256];
+    double total_sum_sq[256];
+    int64_t total_samples;
+} analysis_t;
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * accumulate:  Update the peak value and sum of squares for a single
+ * channel with the given samples.
+ *
+ * [Parameters]
+ *     src: Sample data.
+ *     count: Number of samples.
+ *     peak: Pointer to peak value to update.
+ *     sum_sq: Pointer to sum of squares to update.
+ */
+static void accumulate(const float *src, int count, float *peak,
+                       double *sum_sq)
+{
+    float local_peak = *peak;
+    float local_sum = 0;
+    int i = 0;
+
+#if defined(ENABLE_ASM_ARM_NEON)
+    if (count >= 4) {
+        float32x4_t vpeak = vdupq_n_f32(local_peak);
+        float32x4_t vsum = vdupq_n_f32(0);
+        for (; i + 4 <= count; i += 4) {
+            const float32x4_t data = vld1q_f32(&src[i]);
+            vpeak = vmaxq_f32(vpeak, vabsq_f32(data));
+            vsum = vmlaq_f32(vsum, data, data);
+        }
+        const float32x2_t peak2 =
+            vpmax_f32(vget_low_f32(vpeak), vget_high_f32(vpeak));
+        local_peak = vget_lane_f32(vpmax_f32(peak2, peak2), 0);
+        const float32x2_t sum2 =
+            vadd_f32(vget_low_f32(vsum), vget_high_f32(vsum));
+        local_sum = vget_lane_f32(vpadd_f32(sum2, sum2), 0);
+    }
+#elif defined(ENABLE_ASM_X86_AVX2)
+    if (count >= 8) {
+        const __m256 abs_mask =
+            _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+        __m256 vpeak = _mm256_set1_ps(local_peak);
+        __m256 vsum = _mm256_setzero_ps();
+        for (; i + 8 <= count; i += 8) {
+            const __m256 data = _mm256_loadu_ps(&src[i]);
+            vpeak = _mm256_max_ps(vpeak, _mm256_and_ps(data, abs_mask));
+            vsum = _mm256_fmadd_ps(data, data, vsum);
+        }
+        __m128 peak4 = _mm_max_ps(_mm256_castps256_ps128(vpeak),
+                                  _mm256_extractf128_ps(vpeak, 1));
+        peak4 = _mm_max_ps(peak4, _mm_movehl_ps(peak4, peak4));
+        peak4 = _mm_max_ss(peak4, _mm_shuffle_ps(peak4, peak4, 1));
+        local_peak = _mm_cvtss_f32(peak4);
+        __m128 sum4 = _mm_add_ps(_mm256_castps256_ps128(vsum),
+                                 _mm256_extractf128_ps(vsum, 1));
+        sum4 = _mm_add_ps(sum4, _mm_movehl_ps(sum4, sum4));
+        sum4 = _mm_add_ss(sum4, _mm_shuffle_ps(sum4, sum4, 1));
+        local_sum = _mm_cvtss_f32(sum4);
+    }
+#elif defined(ENABLE_ASM_X86_SSE2)
+    if (count >= 4) {
+        const __m128 abs_mask = CAST_M128(_mm_set1_epi32(0x7FFFFFFF));
+        __m128 vpeak = _mm_set1_ps(local_peak);
+        __m128 vsum = _mm_setzero_ps();
+        for (; i + 4 <= count; i += 4) {
+            const __m128 data = _mm_loadu_ps(&src[i]);
+            vpeak = _mm_max_ps(vpeak, _mm_and_ps(data, abs_mask));
+            vsum = _mm_add_ps(vsum, _mm_mul_ps(data, data));
+        }
+        vpeak = _mm_max_ps(vpeak, _mm_movehl_ps(vpeak, vpeak));
+        vpeak = _mm_max_ss(vpeak, _mm_shuffle_ps(vpeak, vpeak, 1));
+        local_peak = _mm_cvtss_f32(vpeak);
+        vsum = _mm_add_ps(vsum, _mm_movehl_ps(vsum, vsum));
+        vsum = _mm_add_ss(vsum, _mm_shuffle_ps(vsum, vsum, 1));
+        local_sum = _mm_cvtss_f32(vsum);
+    }
+#endif  // ENABLE_ASM_*
+
+    for (; i < count; i++) {
+        const float sample = src[i];
+        local_peak = fmaxf(local_peak, fabsf(sample));
+        local_sum += sample * sample;
+    }
+
+    *peak = local_peak;
+    *sum_sq += local_sum;
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * finish_block:  Record statistics for the current block and merge them
+ * into the totals for the stream.
+ *
+ * [Parameters]
+ *     analysis: Analysis state.
+ */
+static void finish_block(analysis_t *analysis)
+{
+    const int channels = analysis->channels;
+    if (analysis->block_index < analysis->max_blocks) {
+        vorbis_stats_t *stats =
+            &analysis->block_stats[analysis->block_index * channels];
+        for (int c = 0; c < channels; c++) {
+            stats[c].peak = analysis->block_peak[c];
+            stats[c].rms = (float)sqrt(analysis->block_sum_sq[c]
+                                       / analysis->block_fill);
+        }
+    }
+    for (int c = 0; c < channels; c++) {
+        analysis->total_peak[c] =
+            fmaxf(analysis->total_peak[c], analysis->block_peak[c]);
+        analysis->total_sum_sq[c] += analysis->block_sum_sq[c];
+        analysis->block_peak[c] = 0;
+        analysis->block_sum_sq[c] = 0;
+    }
+    analysis->total_samples += analysis->block_fill;
+    analysis->block_index++;
+    analysis->block_fill = 0;
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * analyze_planar:  Accumulate statistics for a frame of planar data.
+ *
+ * [Parameters]
+ *     analysis: Analysis state.
+ *     src: Source buffer pointer array.
+ *     samples: Number of samples per channel.
+ */
+static void analyze_planar(analysis_t *analysis, float **src, int samples)
+{
+    int offset = 0;
+    while (offset < samples) {
+        const int count = (int)min(
+            samples - offset, analysis->block_size - analysis->block_fill);
+        for (int c = 0; c < analysis->channels; c++) {
+            accumulate(src[c] + offset, count, &analysis->block_peak[c],
+                       &analysis->block_sum_sq[c]);
+        }
+        offset += count;
+        analysis->block_fill += count;
+        if (analysis->block_fill == analysis->block_size) {
+            finish_block(analysis);
+        }
+    }
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * analyze_pending:  Accumulate statistics for any unread data remaining
+ * in the handle's decode buffer, and mark that data as consumed.
+ *
+ * [Parameters]
+ *     analysis: Analysis state.
+ *     handle: Handle to operate on.
+ */
+static void analyze_pending(analysis_t *analysis, vorbis_t *handle)
+{
+    const int channels = analysis->channels;
+    for (; handle->decode_buf_pos < handle->decode_buf_len;
+         handle->decode_buf_pos++)
+    {
+        const int index = handle->decode_buf_pos * channels;
+        for (int c = 0; c < channels; c++) {
+            float sample;
+            if (handle->read_int16_only) {
+                sample = ((const int16_t *)handle->decode_buf)[index+c]
+                         / 32767.0f;
+            } else if (handle->read_int24_only) {
+                const uint8_t *src =
+                    (const uint8_t *)handle->decode_buf + (index+c) * 3;
+                const int32_t value = (int32_t)((uint32_t)src[0] << 8
+                                                | (uint32_t)src[1] << 16
+                                                | (uint32_t)src[2] << 24) >> 8;
+                sample = value / 8388607.0f;
+            } else if (handle->read_int32_only) {
+                sample = (float)(((const int32_t *)handle->decode_buf)[index+c]
+                                 / 2147483647.0);
+            } else {
+                sample = ((const float *)handle->decode_buf)[index+c];
+            }
+            analysis->block_peak[c] =
+                fmaxf(analysis->block_peak[c], fabsf(sample));
+            analysis->block_sum_sq[c] += sample * sample;
+        }
+        analysis->block_fill++;
+        if (analysis->block_fill == analysis->block_size) {
+            finish_block(analysis);
+        }
+    }
+}
+
+/*************************************************************************/
+/*************************** Interface routine ***************************/
+/*************************************************************************/
+
+int64_t vorbis_analyze(
+    vorbis_t *handle, vorbis_stats_t *stats, float *loudness_ret,
+    int32_t block_size, vorbis_stats_t *block_stats, int32_t max_blocks,
+    vorbis_error_t *error_ret)
+{
+    int error = VORBIS_NO_ERROR;
+    analysis_t analysis;
+    analysis.total_samples = 0;
+
+    if (block_size < 0
+     || (block_size > 0 && (max_blocks < 0
+                            || (max_blocks > 0 && !block_stats)))) {
+        error = VORBIS_ERROR_INVALID_ARGUMENT;
+        goto out;
+    }
+    if (handle->packet_mode || handle->resampler || handle->downmix_matrix) {
+        error = VORBIS_ERROR_INVALID_OPERATION;
+        goto out;
+    }
+
+    const int channels = handle->channels;
+    analysis.channels = channels;
+    if (block_size > 0) {
+        analysis.block_size = block_size;
+        analysis.block_stats = block_stats;
+        analysis.max_blocks = max_blocks;
+    } else {
+        analysis.block_size = INT32_MAX;
+        analysis.block_stats = NULL;
+        analysis.max_blocks = 0;
+    }
+    analysis.block_index = 0;
+    analysis.block_fill = 0;
+    for (int c = 0; c < channels; c++) {
+        analysis.block_peak[c] = 0;
+        analysis.block_sum_sq[c] = 0;
+        analysis.total_peak[c] = 0;
+        analysis.total_sum_sq[c] = 0;
+    }
+
+    analyze_pending(&analysis, handle);
+
+    bool recovered = false;
+    for (;;) {
+        float **outputs;
+        int samples;
+        const vorbis_error_t frame_error =
+            decode_frame_planar(handle, &outputs, &samples);
+        if (samples > 0) {
+            analyze_planar(&analysis, outputs, samples);
+        }
+        if (frame_error == VORBIS_ERROR_DECODE_RECOVERED) {
+            recovered = true;
+        } else if (frame_error == VORBIS_ERROR_STREAM_END) {
+            if (recovered) {
+                error = VORBIS_ERROR_DECODE_RECOVERED;
+            }
+            break;
+        } else if (frame_error == VORBIS_ERROR_STREAM_CHANGED) {
+            /* Apply the new link's format as the read functions do, so
+             * the caller can analyze or read the next link. */
+            error = decode_frame(handle, NULL, 0);
+            break;
+        } else if (frame_error != VORBIS_NO_ERROR) {
+            error = frame_error;
+            break;
+        }
+    }
+
+    if (analysis.block_fill > 0) {
+        finish_block(&analysis);
+    }
+
+    double total_ms = 0;
+    for (int c = 0; c < channels; c++) {
+        const double ms = (analysis.total_samples > 0
+                           ? analysis.total_sum_sq[c] / analysis.total_samples
+                           : 0);
+        if (stats) {
+            stats[c].peak = analysis.total_peak[c];
+            stats[c].rms = (float)sqrt(ms);
+        }
+        total_ms += ms;
+    }
+    if (loudness_ret) {
+        *loudness_ret = (total_ms > 0
+                         ? (float)(-0.691 + 10 * log10(total_ms))
+                         : -INFINITY);
+    }
+
+  out:
+    if (error_ret) {
+        *error_ret = error;
+    }
+    return analysis.total_samples;
+}
+
+/*************************************************************************/
+/*************************************************************************/
@@ -10,6 +10,7 @@
 #include "include/nogg.h"
 #include "src/common.h"
 #include "src/util/memory.h"
+#include "src/util/resample.h"
 
 #include <stdlib.h>
 
@@ -20,6 +21,9 @@ void vorbis_close(vorbis_t *handle)
         return;
     }
 
+    resampler_free(handle, handle->resampler);
+    mem_free(handle, handle->downmix_matrix);
+    mem_free(handle, handle->downmix_buf);
     mem_free(handle, handle->decode_buf);
     stb_vorbis_close(handle->decoder);
     if (handle->callbacks.close) {
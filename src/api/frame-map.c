@@ -0,0 +1,46 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "src/common.h"
+
+#include <stddef.h>
+
+
+int vorbis_build_frame_map(vorbis_t *handle, vorbis_error_t *error_ret)
+{
+    int error = VORBIS_NO_ERROR;
+
+    if (handle->packet_mode || handle->data_length < 0) {
+        error = VORBIS_ERROR_STREAM_NOT_SEEKABLE;
+        goto out;
+    }
+
+    /* Building the map disturbs the decoder state, so we restore the
+     * current position with a seek afterward (which will also make use
+     * of the new map). */
+    const int64_t position = vorbis_tell(handle);
+    (void) stb_vorbis_get_error(handle->decoder);
+    if (!stb_vorbis_build_frame_map(handle->decoder)) {
+        if (stb_vorbis_get_error(handle->decoder) == VORBIS_outofmem) {
+            error = VORBIS_ERROR_INSUFFICIENT_RESOURCES;
+        } else {
+            error = VORBIS_ERROR_STREAM_INVALID;
+        }
+    }
+    if (!vorbis_seek(handle, position) && error == VORBIS_NO_ERROR) {
+        error = VORBIS_ERROR_DECODE_FAILED;
+    }
+
+  out:
+    if (error_ret) {
+        *error_ret = error;
+    }
+    return error == VORBIS_NO_ERROR;
+}
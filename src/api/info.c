@@ -9,6 +9,7 @@
 
 #include "include/nogg.h"
 #include "src/common.h"
+#include "src/util/resample.h"
 
 
 int vorbis_channels(const vorbis_t *handle)
@@ -33,6 +34,9 @@ int64_t vorbis_length(const vorbis_t *handle)
     if (stb_vorbis_get_error(handle->decoder) != VORBIS__no_error) {
         return -1;
     }
+    if (handle->resampler) {
+        return (int64_t)resampler_length(handle->resampler, length);
+    }
     return length;
 }
 
@@ -0,0 +1,578 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "src/common.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*************************************************************************/
+/****************** Demultiplexer data type and helpers ******************/
+/*************************************************************************/
+
+/* Ogg page header flags. */
+#define PAGEFLAG_continued_packet  1
+#define PAGEFLAG_first_page        2
+#define PAGEFLAG_last_page         4
+
+/* Length of a Vorbis identification header packet. */
+#define ID_PACKET_LEN  30
+
+/* State for a single Vorbis stream in the file. */
+typedef struct mux_stream_t {
+    /* Ogg bitstream serial number. */
+    uint32_t serial;
+    /* Expected page sequence number of the stream's next page. */
+    uint32_t page_number;
+    /* Number of header packets received so far (0-3). */
+    int headers;
+    /* Identification header packet, saved until the setup header has
+     * been received. */
+    unsigned char id_packet[ID_PACKET_LEN];
+    /* Decoder handle, or NULL if the headers have not yet been read. */
+    vorbis_t *handle;
+    /* Buffer for a packet which spans multiple pages.  Packets which lie
+     * entirely within one page are passed directly from the page buffer
+     * and are not copied here. */
+    unsigned char *packet;
+    int32_t packet_len;
+    int32_t packet_size;
+} mux_stream_t;
+
+struct vorbis_mux_t {
+    /* Callbacks and opaque data pointer. */
+    vorbis_callbacks_t callbacks;
+    void *callback_data;
+    /* Decoder options for new streams. */
+    unsigned int options;
+
+    /* Array of Vorbis streams in the file. */
+    mux_stream_t *streams;
+    int num_streams;
+
+    /* Flag: has the end of the file been reached? */
+    bool eof;
+    /* Flag: has a page other than a beginning-of-stream page been seen?
+     * (Streams which start after this point are ignored.) */
+    bool bos_done;
+
+    /* Header data and body of the current page.  segment_index and
+     * body_pos indicate the next segment to be processed; if
+     * segment_index == segment_count, a new page must be read. */
+    unsigned char page_flag;
+    uint64_t page_granule;
+    mux_stream_t *page_stream;  // NULL if the page is to be skipped.
+    int segment_count;
+    int segment_index;
+    int32_t body_pos;
+    unsigned char segments[255];
+    unsigned char body[255*255];
+};
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * mux_alloc:  Allocate memory using the demultiplexer's callbacks.
+ *
+ * [Parameters]
+ *     mux: Demultiplexer handle.
+ *     size: Size of block to allocate, in bytes.
+ * [Return value]
+ *     Pointer to allocated block, or NULL on allocation failure.
+ */
+static void *mux_alloc(vorbis_mux_t *mux, int32_t size)
+{
+    if (mux->callbacks.malloc) {
+        return (*mux->callbacks.malloc)(mux->callback_data, size, 0);
+    } else {
+        return malloc(size);
+    }
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * mux_free:  Free memory allocated with mux_alloc().
+ *
+ * [Parameters]
+ *     mux: Demultiplexer handle.
+ *     ptr: Pointer to block to free (may be NULL).
+ */
+static void mux_free(vorbis_mux_t *mux, void *ptr)
+{
+    if (mux->callbacks.free) {
+        (*mux->callbacks.free)(mux->callback_data, ptr);
+    } else {
+        free(ptr);
+    }
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * read_data:  Read data from the file.  If not all of the requested data
+ * could be read, the demultiplexer's eof flag is set.
+ *
+ * [Parameters]
+ *     mux: Demultiplexer handle.
+ *     buffer: Buffer into which to read data.
+ *     length: Number of bytes to read.
+ * [Return value]
+ *     True if all requested data was read, false otherwise.
+ */
+static bool read_data(vorbis_mux_t *mux, void *buffer, int32_t length)
+{
+    if (mux->eof) {
+        return false;
+    }
+    if ((*mux->callbacks.read)(mux->callback_data, buffer, length) != length) {
+        mux->eof = true;
+        return false;
+    }
+    return true;
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * add_stream:  Add a new Vorbis stream to the demultiplexer.
+ *
+ * [Parameters]
+ *     mux: Demultiplexer handle.
+ *     serial: Serial number of the stream.
+ *     page_number: Page sequence number of the stream's first page.
+ *     id_packet: Identification header packet (ID_PACKET_LEN bytes).
+ * [Return value]
+ *     True on success, false on allocation failure.
+ */
+static bool add_stream(vorbis_mux_t *mux, uint32_t serial,
+                       uint32_t page_number, const unsigned char *id_packet)
+{
+    mux_stream_t *new_streams =
+        mux_alloc(mux, sizeof(*new_streams) * (mux->num_streams + 1));
+    if (!new_streams) {
+        return false;
+    }
+    if (mux->num_streams > 0) {
+        memcpy(new_streams, mux->streams,
+               sizeof(*new_streams) * mux->num_streams);
+    }
+    mux_free(mux, mux->streams);
+    mux->streams = new_streams;
+
+    mux_stream_t *stream = &mux->streams[mux->num_streams++];
+    stream->serial = serial;
+    stream->page_number = page_number + 1;
+    stream->headers = 1;
+    memcpy(stream->id_packet, id_packet, ID_PACKET_LEN);
+    stream->handle = NULL;
+    stream->packet = NULL;
+    stream->packet_len = 0;
+    stream->packet_size = 0;
+    return true;
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * read_page:  Read the next page from the file and set it up for packet
+ * extraction.  Pages belonging to streams which are not being decoded
+ * are skipped, as are pages which do not begin with the Ogg capture
+ * pattern (the next capture pattern in the file is located instead).
+ * The first page of a new Vorbis stream is consumed by this function
+ * and the stream is added to the stream list.
+ *
+ * [Parameters]
+ *     mux: Demultiplexer handle.
+ *     error_ret: Pointer to variable to receive the error code on failure.
+ * [Return value]
+ *     True if a page was read, false at the end of the file or on error.
+ */
+static bool read_page(vorbis_mux_t *mux, vorbis_error_t *error_ret)
+{
+    *error_ret = VORBIS_ERROR_STREAM_END;
+
+    unsigned char header[27];
+    if (!read_data(mux, header, 4)) {
+        return false;
+    }
+    while (memcmp(header, "OggS", 4) != 0) {
+        memmove(header, header+1, 3);
+        if (!read_data(mux, header+3, 1)) {
+            return false;
+        }
+    }
+    if (!read_data(mux, header+4, sizeof(header)-4)
+     || !read_data(mux, mux->segments, header[26])) {
+        return false;
+    }
+    int32_t body_len = 0;
+    for (int i = 0; i < header[26]; i++) {
+        body_len += mux->segments[i];
+    }
+    if (!read_data(mux, mux->body, body_len)) {
+        return false;
+    }
+    if (header[4] != 0) {
+        /* Unknown Ogg version, so we can't parse the page. */
+        mux->page_stream = NULL;
+        mux->segment_count = mux->segment_index = 0;
+        return true;
+    }
+
+    const unsigned char page_flag = header[5];
+    uint64_t granule = 0;
+    for (int i = 7; i >= 0; i--) {
+        granule = granule<<8 | header[6+i];
+    }
+    const uint32_t serial = (uint32_t)header[14]
+                          | (uint32_t)header[15] << 8
+                          | (uint32_t)header[16] << 16
+                          | (uint32_t)header[17] << 24;
+    const uint32_t page_number = (uint32_t)header[18]
+                               | (uint32_t)header[19] << 8
+                               | (uint32_t)header[20] << 16
+                               | (uint32_t)header[21] << 24;
+
+    mux->page_flag = page_flag;
+    mux->page_granule = granule;
+    mux->page_stream = NULL;
+    mux->segment_count = header[26];
+    mux->segment_index = 0;
+    mux->body_pos = 0;
+
+    if (page_flag & PAGEFLAG_first_page) {
+        if (!mux->bos_done && mux->segment_count == 1
+         && mux->segments[0] == ID_PACKET_LEN
+         && memcmp(mux->body, "\1vorbis", 7) == 0) {
+            if (!add_stream(mux, serial, page_number, mux->body)) {
+                *error_ret = VORBIS_ERROR_INSUFFICIENT_RESOURCES;
+                return false;
+            }
+        }
+        mux->segment_count = 0;
+        return true;
+    }
+    mux->bos_done = true;
+
+    for (int i = 0; i < mux->num_streams; i++) {
+        if (mux->streams[i].serial == serial) {
+            mux->page_stream = &mux->streams[i];
+            break;
+        }
+    }
+    mux_stream_t *stream = mux->page_stream;
+    if (!stream) {
+        mux->segment_count = 0;
+        return true;
+    }
+
+    /* If a page was lost or this page does not continue a packet from
+     * the previous page, drop any partial packet we have; if this page
+     * continues a packet whose beginning we don't have, skip the
+     * continued portion. */
+    if (page_number != stream->page_number
+     || !(page_flag & PAGEFLAG_continued_packet)) {
+        stream->packet_len = 0;
+    }
+    stream->page_number = page_number + 1;
+    if ((page_flag & PAGEFLAG_continued_packet) && stream->packet_len == 0) {
+        while (mux->segment_index < mux->segment_count) {
+            const int length = mux->segments[mux->segment_index++];
+            mux->body_pos += length;
+            if (length < 255) {
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * next_packet:  Return the next complete packet from the file, reading
+ * new pages as needed.
+ *
+ * [Parameters]
+ *     mux: Demultiplexer handle.
+ *     stream_ret: Pointer to variable to receive the stream to which the
+ *         packet belongs.
+ *     packet_ret: Pointer to variable to receive a pointer to the packet
+ *         data.  The data remains valid until the next call to this
+ *         function.
+ *     length_ret: Pointer to variable to receive the packet length,
+ *         in bytes.
+ *     error_ret: Pointer to variable to receive the error code on failure.
+ * [Return value]
+ *     True if a packet was returned, false at the end of the file or on
+ *     error.
+ */
+static bool next_packet(vorbis_mux_t *mux, mux_stream_t **stream_ret,
+                        const unsigned char **packet_ret,
+                        int32_t *length_ret, vorbis_error_t *error_ret)
+{
+    for (;;) {
+        while (mux->segment_index >= mux->segment_count) {
+            if (!read_page(mux, error_ret)) {
+                return false;
+            }
+        }
+
+        mux_stream_t *stream = mux->page_stream;
+        const int32_t start = mux->body_pos;
+        bool complete = false;
+        while (!complete && mux->segment_index < mux->segment_count) {
+            const int length = mux->segments[mux->segment_index++];
+            mux->body_pos += length;
+            complete = (length < 255);
+        }
+        const int32_t length = mux->body_pos - start;
+
+        if (complete && stream->packet_len == 0) {
+            *stream_ret = stream;
+            *packet_ret = &mux->body[start];
+            *length_ret = length;
+            return true;
+        }
+
+        if (stream->packet_len + length > stream->packet_size) {
+            if (stream->packet_len + length > 0x3FFFFFFF) {
+                *error_ret = VORBIS_ERROR_INSUFFICIENT_RESOURCES;
+                return false;
+            }
+            int32_t new_size = max(stream->packet_size * 2, 4096);
+            while (new_size < stream->packet_len + length) {
+                new_size *= 2;
+            }
+            unsigned char *new_packet = mux_alloc(mux, new_size);
+            if (!new_packet) {
+                *error_ret = VORBIS_ERROR_INSUFFICIENT_RESOURCES;
+                return false;
+            }
+            if (stream->packet_len > 0) {
+                memcpy(new_packet, stream->packet, stream->packet_len);
+            }
+            mux_free(mux, stream->packet);
+            stream->packet = new_packet;
+            stream->packet_size = new_size;
+        }
+        memcpy(stream->packet + stream->packet_len, &mux->body[start], length);
+        stream->packet_len += length;
+
+        if (complete) {
+            *stream_ret = stream;
+            *packet_ret = stream->packet;
+            *length_ret = stream->packet_len;
+            stream->packet_len = 0;
+            return true;
+        }
+    }
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * read_headers:  Read the header packets for all Vorbis streams in the
+ * file and create a decoder handle for each stream.
+ *
+ * [Parameters]
+ *     mux: Demultiplexer handle.
+ * [Return value]
+ *     VORBIS_NO_ERROR on success, otherwise an error code.
+ */
+static vorbis_error_t read_headers(vorbis_mux_t *mux)
+{
+    int streams_ready = 0;
+    while (!mux->bos_done || streams_ready < mux->num_streams) {
+        mux_stream_t *stream;
+        const unsigned char *packet;
+        int32_t length;
+        vorbis_error_t error;
+        if (!next_packet(mux, &stream, &packet, &length, &error)) {
+            return (error == VORBIS_ERROR_STREAM_END
+                    ? VORBIS_ERROR_STREAM_INVALID : error);
+        }
+        if (stream->headers == 1) {
+            if (length < 7 || memcmp(packet, "\3vorbis", 7) != 0) {
+                return VORBIS_ERROR_STREAM_INVALID;
+            }
+            stream->headers = 2;
+        } else if (stream->headers == 2) {
+            stream->handle = vorbis_open_packet(
+                stream->id_packet, ID_PACKET_LEN, packet, length,
+                mux->callbacks, mux->callback_data, mux->options, &error);
+            if (!stream->handle) {
+                return error;
+            }
+            stream->headers = 3;
+            streams_ready++;
+        } else {
+            /* Audio data for this stream precedes the headers of another
+             * stream, which is not permitted. */
+            return VORBIS_ERROR_STREAM_INVALID;
+        }
+    }
+
+    if (mux->num_streams == 0) {
+        return VORBIS_ERROR_STREAM_INVALID;
+    }
+    return VORBIS_NO_ERROR;
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * free_mux:  Free all resources used by a demultiplexer handle, except
+ * for the stream data itself (the close callback is not called).
+ *
+ * [Parameters]
+ *     mux: Demultiplexer handle.
+ */
+static void free_mux(vorbis_mux_t *mux)
+{
+    for (int i = 0; i < mux->num_streams; i++) {
+        vorbis_close(mux->streams[i].handle);
+        mux_free(mux, mux->streams[i].packet);
+    }
+    mux_free(mux, mux->streams);
+    mux_free(mux, mux);
+}
+
+/*************************************************************************/
+/************************** Interface routines ***************************/
+/*************************************************************************/
+
+vorbis_mux_t *vorbis_mux_open_callbacks(
+    vorbis_callbacks_t callbacks, void *opaque, unsigned int options,
+    vorbis_error_t *error_ret)
+{
+    vorbis_mux_t *mux = NULL;
+    vorbis_error_t error = VORBIS_NO_ERROR;
+
+    if (!callbacks.read
+     || (callbacks.malloc != NULL) != (callbacks.free != NULL)) {
+        error = VORBIS_ERROR_INVALID_ARGUMENT;
+        goto exit;
+    }
+
+    if (callbacks.malloc) {
+        mux = (*callbacks.malloc)(opaque, sizeof(*mux), 0);
+    } else {
+        mux = malloc(sizeof(*mux));
+    }
+    if (!mux) {
+        error = VORBIS_ERROR_INSUFFICIENT_RESOURCES;
+        goto exit;
+    }
+    mux->callbacks = callbacks;
+    mux->callback_data = opaque;
+    mux->options = options;
+    mux->streams = NULL;
+    mux->num_streams = 0;
+    mux->eof = false;
+    mux->bos_done = false;
+    mux->page_stream = NULL;
+    mux->segment_count = 0;
+    mux->segment_index = 0;
+    mux->body_pos = 0;
+
+    error = read_headers(mux);
+    if (error != VORBIS_NO_ERROR) {
+        free_mux(mux);
+        mux = NULL;
+    }
+
+  exit:
+    if (error_ret) {
+        *error_ret = error;
+    }
+    return mux;
+}
+
+/*-----------------------------------------------------------------------*/
+
+void vorbis_mux_close(vorbis_mux_t *mux)
+{
+    if (!mux) {
+        return;
+    }
+
+    if (mux->callbacks.close) {
+        (*mux->callbacks.close)(mux->callback_data);
+    }
+    free_mux(mux);
+}
+
+/*-----------------------------------------------------------------------*/
+
+int vorbis_mux_streams(const vorbis_mux_t *mux)
+{
+    return mux->num_streams;
+}
+
+/*-----------------------------------------------------------------------*/
+
+vorbis_t *vorbis_mux_stream(const vorbis_mux_t *mux, int index)
+{
+    if (index < 0 || index >= mux->num_streams) {
+        return NULL;
+    }
+    return mux->streams[index].handle;
+}
+
+/*-----------------------------------------------------------------------*/
+
+int vorbis_mux_next(vorbis_mux_t *mux, vorbis_error_t *error_ret)
+{
+    int index = -1;
+    vorbis_error_t error = VORBIS_NO_ERROR;
+
+    mux_stream_t *stream;
+    const unsigned char *packet;
+    int32_t length;
+    do {
+        if (!next_packet(mux, &stream, &packet, &length, &error)) {
+            goto out;
+        }
+    } while (stream->headers < 3);  // Skip stray header packets.
+    index = (int)(stream - mux->streams);
+
+    vorbis_t *handle = stream->handle;
+    handle->decode_buf_pos = handle->decode_buf_len;
+    (void) vorbis_submit_packet(handle, packet, length, &error);
+
+    /* If this was the last packet of the stream, trim any samples past
+     * the end position given by the page's granule position.  (The
+     * resampler does not give us a simple mapping between input and
+     * output positions, so we leave the data alone in that case.) */
+    if ((mux->page_flag & PAGEFLAG_last_page)
+     && mux->segment_index == mux->segment_count
+     && mux->page_granule != ~(uint64_t)0 && !handle->resampler) {
+        const uint64_t end = handle->frame_pos + handle->decode_buf_len;
+        if (end > mux->page_granule) {
+            const uint64_t excess = end - mux->page_granule;
+            if (excess < (uint64_t)handle->decode_buf_len) {
+                handle->decode_buf_len -= (int)excess;
+            } else {
+                handle->decode_buf_len = 0;
+            }
+        }
+    }
+
+  out:
+    if (error_ret) {
+        *error_ret = error;
+    }
+    return index;
+}
+
+/*************************************************************************/
+/*************************************************************************/
@@ -25,13 +25,12 @@ typedef struct vorbis_buffer_info_t {
 } vorbis_buffer_info_t;
 
 /* Internal callback (see comments at open_params_t.open_callback).
- * The buffer pointer is passed in the opaque parameter; the buffer length
- * will separately be stored to vorbis->data_length. */
+ * The buffer pointer and length are passed in the opaque parameter. */
 static void *buffer_open(vorbis_t *handle, void *callback_data)
 {
     vorbis_buffer_info_t *buffer_info = (vorbis_buffer_info_t *)callback_data;
     handle->buffer_data = buffer_info->buffer;
-    handle->data_length = buffer_info->length;
+    handle->buffer_length = buffer_info->length;
     handle->buffer_read_pos = 0;
     return handle;
 }
@@ -39,7 +38,7 @@ static void *buffer_open(vorbis_t *handle, void *callback_data)
 static int64_t buffer_length(void *opaque)
 {
     vorbis_t *handle = (vorbis_t *)opaque;
-    return handle->data_length;
+    return handle->buffer_length;
 }
 
 static int64_t buffer_tell(void *opaque)
@@ -57,8 +56,8 @@ static void buffer_seek(void *opaque, int64_t offset)
 static int32_t buffer_read(void *opaque, void *buffer, int32_t length)
 {
     vorbis_t *handle = (vorbis_t *)opaque;
-    if (length > handle->data_length - handle->buffer_read_pos) {
-        length = (int32_t)(handle->data_length - handle->buffer_read_pos);
+    if (length > handle->buffer_length - handle->buffer_read_pos) {
+        length = (int32_t)(handle->buffer_length - handle->buffer_read_pos);
     }
     memcpy(buffer, handle->buffer_data + handle->buffer_read_pos, length);
     handle->buffer_read_pos += length;
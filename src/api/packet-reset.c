@@ -0,0 +1,45 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "src/common.h"
+#include "src/util/resample.h"
+
+#include <stddef.h>
+
+
+int vorbis_packet_reset(vorbis_t *handle, int64_t position,
+                        vorbis_error_t *error_ret)
+{
+    int error = VORBIS_NO_ERROR;
+
+    if (position < 0) {
+        error = VORBIS_ERROR_INVALID_ARGUMENT;
+        goto out;
+    }
+    if (!handle->packet_mode) {
+        error = VORBIS_ERROR_INVALID_OPERATION;
+        goto out;
+    }
+
+    stb_vorbis_reset_packet_state(handle->decoder);
+    if (handle->resampler) {
+        resampler_reset(handle->resampler, position);
+    }
+    handle->frame_pos = position;
+    handle->decode_buf_pos = 0;
+    handle->decode_buf_len = 0;
+    handle->packet_preroll = 1;
+
+  out:
+    if (error_ret) {
+        *error_ret = error;
+    }
+    return error == VORBIS_NO_ERROR;
+}
@@ -24,7 +24,8 @@ int32_t vorbis_read_float(
         error = VORBIS_ERROR_INVALID_ARGUMENT;
         goto out;
     }
-    if (handle->read_int16_only) {
+    if (handle->read_int16_only || handle->read_int24_only
+     || handle->read_int32_only) {
         error = VORBIS_ERROR_INVALID_OPERATION;
         goto out;
     }
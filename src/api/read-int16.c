@@ -25,6 +25,10 @@ int32_t vorbis_read_int16(
         error = VORBIS_ERROR_INVALID_ARGUMENT;
         goto out;
     }
+    if (handle->read_int24_only || handle->read_int32_only) {
+        error = VORBIS_ERROR_INVALID_OPERATION;
+        goto out;
+    }
 
     const int channels = handle->channels;
     while (count < len) {
@@ -48,7 +52,12 @@ int32_t vorbis_read_int16(
         } else {
             const float *src =
                 (float *)handle->decode_buf + handle->decode_buf_pos * channels;
-            float_to_int16(buf, src, copy * channels);
+            if (handle->dither_int16) {
+                float_to_int16_dither(buf, src, copy * channels,
+                                      handle->dither_state);
+            } else {
+                float_to_int16(buf, src, copy * channels);
+            }
         }
         buf += copy * channels;
         count += copy;
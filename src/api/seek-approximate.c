@@ -0,0 +1,79 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "src/common.h"
+#include "src/util/decode-frame.h"
+#include "src/util/resample.h"
+
+#include <stddef.h>
+
+
+int64_t vorbis_seek_approximate(vorbis_t *handle, int64_t position,
+                                vorbis_error_t *error_ret)
+{
+    int error = VORBIS_NO_ERROR;
+
+    if (position < 0) {
+        error = VORBIS_ERROR_INVALID_ARGUMENT;
+        goto out;
+    }
+    if (handle->packet_mode || handle->data_length < 0) {
+        error = VORBIS_ERROR_STREAM_NOT_SEEKABLE;
+        goto out;
+    }
+
+    uint64_t decode_position = position;
+    if (handle->resampler) {
+        decode_position = resampler_seek(handle->resampler, position);
+    }
+
+    stb_vorbis *decoder = handle->decoder;
+    (void) stb_vorbis_get_error(decoder);
+    const int offset = stb_vorbis_seek_approximate(decoder, decode_position);
+    if (stb_vorbis_get_error(decoder) != VORBIS__no_error) {
+        error = VORBIS_ERROR_DECODE_FAILED;
+        goto out;
+    }
+
+    /* When resampling, resume output at the first output sample at or
+     * after the position we actually reached.  The exact case (offset
+     * nonzero) is left to the resampler as for vorbis_seek(). */
+    if (handle->resampler && offset == 0) {
+        resampler_reset(handle->resampler,
+                        resampler_length(handle->resampler,
+                                         stb_vorbis_tell_pcm(decoder)));
+    }
+
+    handle->frame_pos = stb_vorbis_tell_pcm(decoder);
+    handle->decode_buf_pos = 0;
+    handle->decode_buf_len = 0;
+
+    vorbis_error_t frame_error;
+    do {
+        frame_error = decode_frame(handle, NULL, 0);
+    } while (frame_error == VORBIS_ERROR_DECODE_RECOVERED
+             || (frame_error == VORBIS_NO_ERROR
+                 && handle->decode_buf_len == 0));
+    if (frame_error != VORBIS_NO_ERROR
+     && frame_error != VORBIS_ERROR_STREAM_END) {
+        error = VORBIS_ERROR_DECODE_FAILED;
+        goto out;
+    }
+
+    if (!handle->resampler) {
+        handle->decode_buf_pos += offset;
+    }
+
+  out:
+    if (error_ret) {
+        *error_ret = error;
+    }
+    return error == VORBIS_NO_ERROR ? vorbis_tell(handle) : -1;
+}
@@ -0,0 +1,291 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "src/common.h"
+#include "src/util/memory.h"
+
+#include <stddef.h>
+
+/*
+ * The serialized seek index has the following format.  All numeric
+ * values are stored as unsigned little-endian base-128 varints (7 bits
+ * per byte, with the high bit set on all but the last byte).
+ *
+ *    - Signature: the 4 bytes "NgSx"
+ *    - Format version: 1 byte, currently 1
+ *    - Stream length in bytes
+ *    - Ogg bitstream serial number
+ *    - Number of seek points
+ *    - For each seek point:
+ *         - Gap between the end of the previous page (or the beginning
+ *           of the stream, for the first point) and the page start
+ *         - Page length in bytes
+ *         - Difference between the page's first sample offset and that
+ *           of the previous page (or zero, for the first point)
+ *         - Difference between the page's last and first sample offsets
+ *
+ * Typical pages need 5-7 bytes each.
+ */
+
+/*************************************************************************/
+/**************************** Helper routines ****************************/
+/*************************************************************************/
+
+/* Signature and version at the beginning of serialized data. */
+static const uint8_t index_signature[5] = {'N', 'g', 'S', 'x', 1};
+
+/* Minimum serialized size of a seek point. */
+#define MIN_POINT_SIZE  4
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * put_varint:  Store a value as a varint in a buffer.  If the value does
+ * not fit in the buffer, nothing is stored, but the returned position is
+ * still advanced so that the caller can compute the total size needed.
+ *
+ * [Parameters]
+ *     buf: Output buffer (may be NULL).
+ *     size: Size of output buffer, in bytes.
+ *     pos: Current position in buffer.
+ *     value: Value to store.
+ * [Return value]
+ *     New buffer position.
+ */
+static int64_t put_varint(uint8_t *buf, int64_t size, int64_t pos,
+                          uint64_t value)
+{
+    do {
+        const uint8_t byte = (value & 0x7F) | (value >= 0x80 ? 0x80 : 0);
+        if (buf && pos < size) {
+            buf[pos] = byte;
+        }
+        pos++;
+        value >>= 7;
+    } while (value);
+    return pos;
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * get_varint:  Read a varint from a buffer.
+ *
+ * [Parameters]
+ *     data: Input data.
+ *     size: Size of input data, in bytes.
+ *     pos: Pointer to current position in buffer (updated on success).
+ *     value_ret: Pointer to variable to receive the value.
+ * [Return value]
+ *     True on success, false if the data is truncated or malformed.
+ */
+static bool get_varint(const uint8_t *data, int32_t size, int32_t *pos,
+                       uint64_t *value_ret)
+{
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (*pos >= size) {
+            return false;
+        }
+        const uint8_t byte = data[(*pos)++];
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value_ret = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*************************************************************************/
+/************************** Interface routines ***************************/
+/*************************************************************************/
+
+int vorbis_build_seek_index(vorbis_t *handle, vorbis_error_t *error_ret)
+{
+    int error = VORBIS_NO_ERROR;
+
+    if (handle->packet_mode || handle->data_length < 0) {
+        error = VORBIS_ERROR_STREAM_NOT_SEEKABLE;
+        goto out;
+    }
+
+    (void) stb_vorbis_get_error(handle->decoder);
+    if (!stb_vorbis_build_seek_index(handle->decoder)) {
+        if (stb_vorbis_get_error(handle->decoder) == VORBIS_outofmem) {
+            error = VORBIS_ERROR_INSUFFICIENT_RESOURCES;
+        } else {
+            error = VORBIS_ERROR_STREAM_INVALID;
+        }
+    }
+
+  out:
+    if (error_ret) {
+        *error_ret = error;
+    }
+    return error == VORBIS_NO_ERROR;
+}
+
+/*-----------------------------------------------------------------------*/
+
+int32_t vorbis_export_seek_index(vorbis_t *handle, void *buf, int32_t size,
+                                 vorbis_error_t *error_ret)
+{
+    int error = VORBIS_NO_ERROR;
+    int64_t pos = 0;
+
+    if (size < 0 || (size > 0 && !buf)) {
+        error = VORBIS_ERROR_INVALID_ARGUMENT;
+        goto out;
+    }
+    const stb_vorbis_seek_point *points;
+    const int count = stb_vorbis_get_seek_index(handle->decoder, &points);
+    if (count == 0) {
+        error = VORBIS_ERROR_INVALID_OPERATION;
+        goto out;
+    }
+
+    const stb_vorbis_info info = stb_vorbis_get_info(handle->decoder);
+    uint8_t *out = buf;
+    for (; pos < (int)sizeof(index_signature); pos++) {
+        if (out && pos < size) {
+            out[pos] = index_signature[pos];
+        }
+    }
+    pos = put_varint(out, size, pos, handle->data_length);
+    pos = put_varint(out, size, pos, info.bitstream_id);
+    pos = put_varint(out, size, pos, count);
+    int64_t prev_end = 0;
+    uint64_t prev_first = 0;
+    for (int i = 0; i < count; i++) {
+        const stb_vorbis_seek_point *point = &points[i];
+        pos = put_varint(out, size, pos, point->page_start - prev_end);
+        pos = put_varint(out, size, pos, point->page_end - point->page_start);
+        pos = put_varint(out, size, pos, point->first_sample - prev_first);
+        pos = put_varint(out, size, pos,
+                         point->last_sample - point->first_sample);
+        prev_end = point->page_end;
+        prev_first = point->first_sample;
+    }
+
+    if (pos > INT32_MAX) {
+        error = VORBIS_ERROR_INSUFFICIENT_RESOURCES;
+        pos = 0;
+    } else if (buf && pos > size) {
+        error = VORBIS_ERROR_INVALID_ARGUMENT;
+    }
+
+  out:
+    if (error_ret) {
+        *error_ret = error;
+    }
+    return (int32_t)pos;
+}
+
+/*-----------------------------------------------------------------------*/
+
+int vorbis_load_seek_index(vorbis_t *handle, const void *data, int32_t size,
+                           vorbis_error_t *error_ret)
+{
+    int error = VORBIS_NO_ERROR;
+    stb_vorbis_seek_point *points = NULL;
+
+    if (!data || size < 0) {
+        error = VORBIS_ERROR_INVALID_ARGUMENT;
+        goto out;
+    }
+    if (handle->packet_mode || handle->data_length < 0) {
+        error = VORBIS_ERROR_STREAM_NOT_SEEKABLE;
+        goto out;
+    }
+
+    /* Check that the data is a seek index for this stream. */
+    const uint8_t *in = data;
+    int32_t pos = (int32_t)sizeof(index_signature);
+    if (size < pos) {
+        error = VORBIS_ERROR_INVALID_ARGUMENT;
+        goto out;
+    }
+    for (int i = 0; i < (int)sizeof(index_signature); i++) {
+        if (in[i] != index_signature[i]) {
+            error = VORBIS_ERROR_INVALID_ARGUMENT;
+            goto out;
+        }
+    }
+    const stb_vorbis_info info = stb_vorbis_get_info(handle->decoder);
+    uint64_t stream_length, bitstream_id, count;
+    if (!get_varint(in, size, &pos, &stream_length)
+     || !get_varint(in, size, &pos, &bitstream_id)
+     || !get_varint(in, size, &pos, &count)
+     || stream_length != (uint64_t)handle->data_length
+     || bitstream_id != info.bitstream_id
+     || count == 0
+     || count > (uint64_t)((size - pos) / MIN_POINT_SIZE)) {
+        error = VORBIS_ERROR_INVALID_ARGUMENT;
+        goto out;
+    }
+
+    points = mem_alloc(handle, sizeof(*points) * count, 0);
+    if (!points) {
+        error = VORBIS_ERROR_INSUFFICIENT_RESOURCES;
+        goto out;
+    }
+    uint64_t prev_end = 0;
+    uint64_t prev_first = 0;
+    for (int i = 0; i < (int)count; i++) {
+        uint64_t gap, length, first_delta, span;
+        if (!get_varint(in, size, &pos, &gap)
+         || !get_varint(in, size, &pos, &length)
+         || !get_varint(in, size, &pos, &first_delta)
+         || !get_varint(in, size, &pos, &span)
+         /* Bound each value by the stream length so that the sums below
+          * cannot overflow.  (Sample offsets have no such natural limit,
+          * but overflow there is caught by the consistency checks in
+          * stb_vorbis_set_seek_index().) */
+         || gap > stream_length || length > stream_length) {
+            error = VORBIS_ERROR_INVALID_ARGUMENT;
+            goto out;
+        }
+        points[i].page_start = (int64_t)(prev_end + gap);
+        points[i].page_end = (int64_t)(prev_end + gap + length);
+        points[i].first_sample = prev_first + first_delta;
+        points[i].last_sample = points[i].first_sample + span;
+        if (points[i].first_sample < prev_first
+         || points[i].last_sample < points[i].first_sample) {
+            error = VORBIS_ERROR_INVALID_ARGUMENT;
+            goto out;
+        }
+        prev_end = points[i].page_end;
+        prev_first = points[i].first_sample;
+    }
+    if (pos != size) {
+        error = VORBIS_ERROR_INVALID_ARGUMENT;
+        goto out;
+    }
+
+    (void) stb_vorbis_get_error(handle->decoder);
+    if (!stb_vorbis_set_seek_index(handle->decoder, points, (int)count)) {
+        if (stb_vorbis_get_error(handle->decoder) == VORBIS_outofmem) {
+            error = VORBIS_ERROR_INSUFFICIENT_RESOURCES;
+        } else {
+            error = VORBIS_ERROR_INVALID_ARGUMENT;
+        }
+    }
+
+  out:
+    mem_free(handle, points);
+    if (error_ret) {
+        *error_ret = error;
+    }
+    return error == VORBIS_NO_ERROR;
+}
+
+/*************************************************************************/
+/*************************************************************************/
@@ -10,6 +10,7 @@
 #include "include/nogg.h"
 #include "src/common.h"
 #include "src/util/decode-frame.h"
+#include "src/util/resample.h"
 
 #include <stddef.h>
 
@@ -23,8 +24,15 @@ int vorbis_seek(vorbis_t *handle, int64_t position)
         return 0;
     }
 
+    /* When resampling, the resampler tells us where to start decoding,
+     * and it handles skipping to the target sample itself. */
+    uint64_t decode_position = position;
+    if (handle->resampler) {
+        decode_position = resampler_seek(handle->resampler, position);
+    }
+
     (void) stb_vorbis_get_error(handle->decoder);
-    const int offset = stb_vorbis_seek(handle->decoder, position);
+    const int offset = stb_vorbis_seek(handle->decoder, decode_position);
     if (stb_vorbis_get_error(handle->decoder) != VORBIS__no_error) {
         return 0;
     }
@@ -36,12 +44,15 @@ int vorbis_seek(vorbis_t *handle, int64_t position)
     vorbis_error_t error;
     do {
         error = decode_frame(handle, NULL, 0);
-    } while (error == VORBIS_ERROR_DECODE_RECOVERED);
+    } while (error == VORBIS_ERROR_DECODE_RECOVERED
+             || (error == VORBIS_NO_ERROR && handle->decode_buf_len == 0));
     if (error != VORBIS_NO_ERROR && error != VORBIS_ERROR_STREAM_END) {
         return 0;
     }
 
-    handle->decode_buf_pos += offset;
+    if (!handle->resampler) {
+        handle->decode_buf_pos += offset;
+    }
     return 1;
 }
 
@@ -0,0 +1,36 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "src/common.h"
+
+
+int vorbis_set_channel_mask(vorbis_t *handle, uint64_t mask,
+                            vorbis_error_t *error_ret)
+{
+    int error = VORBIS_NO_ERROR;
+
+    /* At least one of the stream's channels must be selected. */
+    uint64_t valid_mask = ~UINT64_C(0);
+    if (handle->stream_channels < 64) {
+        valid_mask = (UINT64_C(1) << handle->stream_channels) - 1;
+    }
+    if (!(mask & valid_mask)) {
+        error = VORBIS_ERROR_INVALID_ARGUMENT;
+        goto out;
+    }
+
+    stb_vorbis_set_channel_mask(handle->decoder, mask);
+
+  out:
+    if (error_ret) {
+        *error_ret = error;
+    }
+    return error == VORBIS_NO_ERROR;
+}
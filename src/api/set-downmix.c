@@ -0,0 +1,72 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "src/common.h"
+#include "src/util/memory.h"
+#include "src/util/resample.h"
+
+#include <stddef.h>
+#include <string.h>
+
+
+int vorbis_set_downmix(vorbis_t *handle, int channels, const float *matrix,
+                       vorbis_error_t *error_ret)
+{
+    int error = VORBIS_NO_ERROR;
+
+    if (channels < 0 || channels > handle->stream_channels
+     || (channels > 0 && !matrix)) {
+        error = VORBIS_ERROR_INVALID_ARGUMENT;
+        goto out;
+    }
+    if (handle->frame_pos != 0 || handle->decode_buf_len != 0) {
+        error = VORBIS_ERROR_INVALID_OPERATION;
+        goto out;
+    }
+
+    float *new_matrix = NULL;
+    float **downmix_buf = NULL;
+    if (channels > 0) {
+        const int32_t matrix_size =
+            sizeof(*matrix) * channels * handle->stream_channels;
+        new_matrix = mem_alloc(handle, matrix_size, 0);
+        if (!new_matrix) {
+            error = VORBIS_ERROR_INSUFFICIENT_RESOURCES;
+            goto out;
+        }
+        memcpy(new_matrix, matrix, matrix_size);
+
+        const stb_vorbis_info info = stb_vorbis_get_info(handle->decoder);
+        int frame_size = info.max_frame_size;
+        if (handle->resampler) {
+            frame_size =
+                max(frame_size, resampler_max_output(handle->resampler));
+        }
+        downmix_buf = alloc_channel_array(
+            handle, channels, sizeof(float) * frame_size, 64);
+        if (!downmix_buf) {
+            mem_free(handle, new_matrix);
+            error = VORBIS_ERROR_INSUFFICIENT_RESOURCES;
+            goto out;
+        }
+    }
+
+    mem_free(handle, handle->downmix_matrix);
+    mem_free(handle, handle->downmix_buf);
+    handle->downmix_matrix = new_matrix;
+    handle->downmix_buf = downmix_buf;
+    handle->channels = (channels > 0 ? channels : handle->stream_channels);
+
+  out:
+    if (error_ret) {
+        *error_ret = error;
+    }
+    return error == VORBIS_NO_ERROR;
+}
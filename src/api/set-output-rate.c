@@ -0,0 +1,102 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "src/common.h"
+#include "src/util/decode-frame.h"
+#include "src/util/memory.h"
+#include "src/util/resample.h"
+
+#include <stddef.h>
+
+
+int vorbis_set_output_rate(vorbis_t *handle, uint32_t rate, int quality,
+                           vorbis_error_t *error_ret)
+{
+    int error = VORBIS_NO_ERROR;
+
+    if (quality < VORBIS_RESAMPLE_QUALITY_LOW
+     || quality > VORBIS_RESAMPLE_QUALITY_HIGH
+     || rate > RESAMPLE_MAX_RATE) {
+        error = VORBIS_ERROR_INVALID_ARGUMENT;
+        goto out;
+    }
+    if (handle->frame_pos != 0 || handle->decode_buf_len != 0) {
+        error = VORBIS_ERROR_INVALID_OPERATION;
+        goto out;
+    }
+
+    const stb_vorbis_info info = stb_vorbis_get_info(handle->decoder);
+    const uint32_t in_rate = info.sample_rate;
+    if (rate == 0 || rate == in_rate) {
+        resampler_free(handle, handle->resampler);
+        handle->resampler = NULL;
+        handle->rate = in_rate;
+        goto out;
+    }
+    if (in_rate > RESAMPLE_MAX_RATE) {
+        error = VORBIS_ERROR_INVALID_OPERATION;
+        goto out;
+    }
+    if ((uint64_t)rate > (uint64_t)in_rate * 16
+     || (uint64_t)in_rate > (uint64_t)rate * 16) {
+        error = VORBIS_ERROR_INVALID_ARGUMENT;
+        goto out;
+    }
+
+    resampler_t *resampler = resampler_create(
+        handle, in_rate, rate, quality, handle->stream_channels,
+        info.max_frame_size);
+    if (!resampler) {
+        error = VORBIS_ERROR_INSUFFICIENT_RESOURCES;
+        goto out;
+    }
+
+    /* Reallocate the decode buffer (and the downmix buffer, if any) to
+     * hold a full frame of output data.  The decode buffer is sized for
+     * the full stream channel count so that a later vorbis_set_downmix()
+     * call can change the output channel count freely. */
+    const int sample_size = decode_buf_sample_size(handle);
+    const int frame_size =
+        max(resampler_max_output(resampler), info.max_frame_size);
+    void *decode_buf = mem_alloc(
+        handle, sample_size * handle->stream_channels * frame_size, 64);
+    if (!decode_buf) {
+        resampler_free(handle, resampler);
+        error = VORBIS_ERROR_INSUFFICIENT_RESOURCES;
+        goto out;
+    }
+    float **downmix_buf = NULL;
+    if (handle->downmix_buf) {
+        downmix_buf = alloc_channel_array(
+            handle, handle->channels, sizeof(float) * frame_size, 64);
+        if (!downmix_buf) {
+            mem_free(handle, decode_buf);
+            resampler_free(handle, resampler);
+            error = VORBIS_ERROR_INSUFFICIENT_RESOURCES;
+            goto out;
+        }
+    }
+
+    mem_free(handle, handle->decode_buf);
+    handle->decode_buf = decode_buf;
+    if (downmix_buf) {
+        mem_free(handle, handle->downmix_buf);
+        handle->downmix_buf = downmix_buf;
+    }
+    resampler_free(handle, handle->resampler);
+    handle->resampler = resampler;
+    handle->rate = rate;
+
+  out:
+    if (error_ret) {
+        *error_ret = error;
+    }
+    return error == VORBIS_NO_ERROR;
+}
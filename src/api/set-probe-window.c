@@ -0,0 +1,39 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "src/common.h"
+
+#include <stddef.h>
+
+
+int vorbis_set_probe_window(vorbis_t *handle, int32_t size,
+                            vorbis_error_t *error_ret)
+{
+    int error = VORBIS_NO_ERROR;
+
+    if (size < 0 || size > (1<<24)) {
+        error = VORBIS_ERROR_INVALID_ARGUMENT;
+        goto out;
+    }
+    if (handle->packet_mode || handle->data_length < 0) {
+        error = VORBIS_ERROR_STREAM_NOT_SEEKABLE;
+        goto out;
+    }
+
+    if (!stb_vorbis_set_probe_window(handle->decoder, size)) {
+        error = VORBIS_ERROR_INSUFFICIENT_RESOURCES;
+    }
+
+  out:
+    if (error_ret) {
+        *error_ret = error;
+    }
+    return error == VORBIS_NO_ERROR;
+}
@@ -0,0 +1,82 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "src/common.h"
+#include "src/util/decode-frame.h"
+
+#include <stddef.h>
+
+
+int64_t vorbis_skip(vorbis_t *handle, int64_t count,
+                    vorbis_error_t *error_ret)
+{
+    int64_t skipped = 0;
+    int error = VORBIS_NO_ERROR;
+
+    if (count < 0) {
+        error = VORBIS_ERROR_INVALID_ARGUMENT;
+        goto out;
+    }
+    if (handle->packet_mode) {
+        error = VORBIS_ERROR_INVALID_OPERATION;
+        goto out;
+    }
+
+    const uint64_t target =
+        handle->frame_pos + handle->decode_buf_pos + (uint64_t)count;
+    for (;;) {
+        const int skip = (int)min(
+            count - skipped, handle->decode_buf_len - handle->decode_buf_pos);
+        handle->decode_buf_pos += skip;
+        skipped += skip;
+        if (skipped >= count) {
+            break;
+        }
+
+        /* The decoder's sample positions only match ours if the output
+         * is not being resampled; otherwise we just decode and discard. */
+        if (!handle->resampler) {
+            stb_vorbis *decoder = handle->decoder;
+            const uint64_t old_pos =
+                handle->frame_pos + handle->decode_buf_len;
+            (void) stb_vorbis_get_error(decoder);  // Clear any pending error.
+            stb_vorbis_reset_eof(decoder);
+            stb_vorbis_skip(decoder, target);
+            const uint64_t new_pos = stb_vorbis_tell_pcm(decoder);
+            if (new_pos != old_pos) {
+                skipped += (int64_t)(new_pos - old_pos);
+                handle->frame_pos = new_pos;
+                handle->decode_buf_pos = 0;
+                handle->decode_buf_len = 0;
+            }
+            const STBVorbisError stb_error = stb_vorbis_get_error(decoder);
+            if (stb_error == VORBIS_invalid_packet
+             || stb_error == VORBIS_continued_packet_flag_invalid
+             || stb_error == VORBIS_wrong_page_number) {
+                error = VORBIS_ERROR_DECODE_RECOVERED;
+                break;
+            } else if (stb_error != VORBIS__no_error) {
+                error = VORBIS_ERROR_DECODE_FAILED;
+                break;
+            }
+        }
+
+        error = decode_frame(handle, NULL, 0);
+        if (error) {
+            break;
+        }
+    }
+
+  out:
+    if (error_ret) {
+        *error_ret = error;
+    }
+    return skipped;
+}
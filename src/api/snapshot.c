@@ -0,0 +1,173 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "src/common.h"
+#include "src/util/decode-frame.h"
+
+#include <string.h>
+
+/*
+ * A snapshot consists of a snapshot_header_t structure, followed by the
+ * decoder state stored by stb_vorbis_snapshot(), followed by any audio
+ * data which had been decoded but not yet read (in the same format as
+ * the handle's decode buffer).  The data is stored in native byte order
+ * and is only meaningful to the process which created it.
+ */
+
+/*************************************************************************/
+/****************************** Local data *******************************/
+/*************************************************************************/
+
+/* Signature at the beginning of snapshot data. */
+static const char snapshot_signature[4] = {'N', 'g', 'S', 'n'};
+
+/* Header for snapshot data. */
+typedef struct snapshot_header_t {
+    char signature[4];
+    int32_t size;            // Total size of snapshot data.
+    int32_t decoder_size;    // Size of decoder state.
+    int32_t pending;         // Number of samples of pending audio data.
+    int channels;
+    bool read_int16_only;
+    bool read_int24_only;
+    bool read_int32_only;
+    uint64_t position;       // Sample position of the first pending sample.
+    uint32_t dither_state[DITHER_STATE_SIZE];
+} snapshot_header_t;
+
+/*************************************************************************/
+/************************** Interface routines ***************************/
+/*************************************************************************/
+
+int32_t vorbis_snapshot(vorbis_t *handle, void *buf, int32_t size,
+                        vorbis_error_t *error_ret)
+{
+    int error = VORBIS_NO_ERROR;
+    int32_t total_size = 0;
+
+    if (size < 0 || (size > 0 && !buf)) {
+        error = VORBIS_ERROR_INVALID_ARGUMENT;
+        goto out;
+    }
+    if (handle->packet_mode || handle->data_length < 0) {
+        error = VORBIS_ERROR_STREAM_NOT_SEEKABLE;
+        goto out;
+    }
+    if (handle->resampler) {
+        error = VORBIS_ERROR_INVALID_OPERATION;
+        goto out;
+    }
+
+    const int32_t pending = handle->decode_buf_len - handle->decode_buf_pos;
+    const int32_t frame_bytes =
+        decode_buf_sample_size(handle) * handle->channels;
+    const int32_t decoder_size = stb_vorbis_snapshot_size(handle->decoder);
+    total_size = sizeof(snapshot_header_t) + decoder_size
+        + frame_bytes * pending;
+    if (!buf) {
+        goto out;
+    }
+    if (size < total_size) {
+        error = VORBIS_ERROR_INVALID_ARGUMENT;
+        goto out;
+    }
+
+    snapshot_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.signature, snapshot_signature, sizeof(header.signature));
+    header.size = total_size;
+    header.decoder_size = decoder_size;
+    header.pending = pending;
+    header.channels = handle->channels;
+    header.read_int16_only = handle->read_int16_only;
+    header.read_int24_only = handle->read_int24_only;
+    header.read_int32_only = handle->read_int32_only;
+    header.position = handle->frame_pos + handle->decode_buf_pos;
+    memcpy(header.dither_state, handle->dither_state,
+           sizeof(header.dither_state));
+
+    uint8_t *dest = buf;
+    memcpy(dest, &header, sizeof(header));
+    dest += sizeof(header);
+    stb_vorbis_snapshot(handle->decoder, dest);
+    dest += decoder_size;
+    memcpy(dest, (const uint8_t *)handle->decode_buf
+                    + frame_bytes * handle->decode_buf_pos,
+           frame_bytes * pending);
+
+  out:
+    if (error_ret) {
+        *error_ret = error;
+    }
+    return total_size;
+}
+
+/*-----------------------------------------------------------------------*/
+
+int vorbis_restore(vorbis_t *handle, const void *buf, int32_t size,
+                   vorbis_error_t *error_ret)
+{
+    int error = VORBIS_NO_ERROR;
+
+    if (!buf || size < (int32_t)sizeof(snapshot_header_t)) {
+        error = VORBIS_ERROR_INVALID_ARGUMENT;
+        goto out;
+    }
+    if (handle->packet_mode || handle->data_length < 0) {
+        error = VORBIS_ERROR_STREAM_NOT_SEEKABLE;
+        goto out;
+    }
+    if (handle->resampler) {
+        error = VORBIS_ERROR_INVALID_OPERATION;
+        goto out;
+    }
+
+    snapshot_header_t header;
+    memcpy(&header, buf, sizeof(header));
+    const stb_vorbis_info info = stb_vorbis_get_info(handle->decoder);
+    const int32_t frame_bytes =
+        decode_buf_sample_size(handle) * handle->channels;
+    if (memcmp(header.signature, snapshot_signature,
+               sizeof(header.signature)) != 0
+     || header.size != size
+     || header.channels != handle->channels
+     || header.read_int16_only != handle->read_int16_only
+     || header.read_int24_only != handle->read_int24_only
+     || header.read_int32_only != handle->read_int32_only
+     || header.pending < 0 || header.pending > info.max_frame_size
+     || header.decoder_size < 0
+     || header.decoder_size != size - (int32_t)sizeof(header)
+                               - frame_bytes * header.pending) {
+        error = VORBIS_ERROR_INVALID_ARGUMENT;
+        goto out;
+    }
+
+    const uint8_t *in = (const uint8_t *)buf + sizeof(header);
+    if (!stb_vorbis_restore(handle->decoder, in, header.decoder_size)) {
+        error = VORBIS_ERROR_INVALID_ARGUMENT;
+        goto out;
+    }
+    in += header.decoder_size;
+    memcpy(handle->decode_buf, in, frame_bytes * header.pending);
+    handle->frame_pos = header.position;
+    handle->decode_buf_pos = 0;
+    handle->decode_buf_len = header.pending;
+    memcpy(handle->dither_state, header.dither_state,
+           sizeof(handle->dither_state));
+
+  out:
+    if (error_ret) {
+        *error_ret = error;
+    }
+    return error == VORBIS_NO_ERROR;
+}
+
+/*************************************************************************/
+/*************************************************************************/
@@ -10,6 +10,7 @@
 #include "include/nogg.h"
 #include "src/common.h"
 #include "src/util/decode-frame.h"
+#include "src/util/resample.h"
 
 #include <stddef.h>
 
@@ -32,6 +33,17 @@ int vorbis_submit_packet(vorbis_t *handle, const void *packet,
         goto exit;
     }
     error = decode_frame(handle, packet, packet_len);
+    if (handle->packet_preroll
+     && (error == VORBIS_NO_ERROR || error == VORBIS_ERROR_STREAM_END)) {
+        /* This packet only serves to set up the overlap data for the
+         * next one, so drop its output and restore the position set by
+         * vorbis_packet_reset(). */
+        handle->decode_buf_len = 0;
+        if (handle->resampler) {
+            resampler_reset(handle->resampler, handle->frame_pos);
+        }
+        handle->packet_preroll = 0;
+    }
     if (error == VORBIS_ERROR_STREAM_END) {
         /* The packet had no audio data (e.g., the first packet in the
          * stream).  This is not an error for our purposes. */
@@ -59,6 +59,18 @@ struct stb_vorbis;
 # define ALIGN(alignment)  /*nothing*/
 #endif
 
+/**
+ * ALWAYS_INLINE:  Function attribute indicating that the function should
+ * always be inlined.  Used in place of the "inline" keyword.
+ */
+#if IS_GCC(3,1) || IS_CLANG(1,0)
+# define ALWAYS_INLINE  inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+# define ALWAYS_INLINE  __forceinline
+#else
+# define ALWAYS_INLINE  inline
+#endif
+
 /**
  * ASSERT:  Verify that the given condition is true, and abort the program
  * if it is not.  If ENABLE_ASSERT is not defined, the expression is
@@ -177,6 +189,13 @@ struct stb_vorbis;
 /*********************** Data types and constants ************************/
 /*************************************************************************/
 
+/**
+ * DITHER_STATE_SIZE:  Number of uint32_t words of pseudorandom generator
+ * state used by the float_to_int16_dither*() functions.  The state must
+ * be initialized with dither_init() before first use.
+ */
+#define DITHER_STATE_SIZE  8
+
 /*
  * Definition of the vorbis_t stream handle structure.
  */
@@ -190,6 +209,12 @@ struct vorbis_t {
     bool packet_mode;
     /* Decode directly to int16 buffers? (VORBIS_OPTION_READ_INT16_ONLY) */
     bool read_int16_only;
+    /* Decode directly to packed int24 or int32 buffers?
+     * (VORBIS_OPTION_READ_INT24_ONLY, VORBIS_OPTION_READ_INT32_ONLY) */
+    bool read_int24_only;
+    bool read_int32_only;
+    /* Apply dither when converting to int16? (VORBIS_OPTION_DITHER_INT16) */
+    bool dither_int16;
 
     /******** Stream callbacks and related data. ********/
 
@@ -197,13 +222,14 @@ struct vorbis_t {
     vorbis_callbacks_t callbacks;
     /* Opaque data pointer for callbacks. */
     void *callback_data;
-    /* Data buffer and current read position.  These are used by the
-     * open_from_buffer() callbacks to allow the current buffer state to
-     * be stored within the stream handle, avoiding (among other things)
+    /* Data buffer, length, and current read position.  These are used by
+     * the open_from_buffer() callbacks to allow the current buffer state
+     * to be stored within the stream handle, avoiding (among other things)
      * the complexity of ensuring that the buffer state is freed on close
-     * at the cost of an extra 12-16 bytes per handle (which we assume is
+     * at the cost of an extra 20-24 bytes per handle (which we assume is
      * not significant). */
     const char *buffer_data;
+    int64_t buffer_length;
     int64_t buffer_read_pos;
     /* Length of stream data in bytes, or -1 if not a seekable stream. */
     int64_t data_length;
@@ -214,12 +240,23 @@ struct vorbis_t {
 
     /* stb_vorbis decode handle. */
     struct stb_vorbis *decoder;
+    /* Output resampler, or NULL if not resampling. */
+    struct resampler_t *resampler;
+    /* Downmix matrix (channels rows of stream_channels coefficients), or
+     * NULL if not downmixing. */
+    float *downmix_matrix;
+    /* Planar buffers for downmixed data (channels arrays), or NULL if not
+     * downmixing. */
+    float **downmix_buf;
 
     /******** Audio parameters. ********/
 
-    /* Number of channels. */
+    /* Number of output channels.  This differs from stream_channels only
+     * when downmixing. */
     int channels;
-    /* Audio sampling rate, in Hz. */
+    /* Number of channels encoded in the stream. */
+    int stream_channels;
+    /* Audio sampling rate, in Hz.  If resampling, this is the output rate. */
     uint32_t rate;
 
     /******** Decoding state. ********/
@@ -230,13 +267,24 @@ struct vorbis_t {
      * beginning of the stream. */
     uint64_t frame_pos;
     /* Buffer holding decoded audio data for the current frame.  The actual
-     * type is "int16_t *" if the read_int16_only option is set, "float *"
-     * otherwise. */
+     * type is "int16_t *" if the read_int16_only option is set, "uint8_t *"
+     * (3 bytes per sample) if read_int24_only is set, "int32_t *" if
+     * read_int32_only is set, and "float *" otherwise. */
     void *decode_buf;
     /* Number of samples (per channel) of valid data in decode_buf. */
     int decode_buf_len;
     /* Index of next sample (per channel) in decode_buf to consume. */
     int decode_buf_pos;
+    /* Flag: discard the output of the next submitted packet?  (Set by
+     * vorbis_packet_reset() for packet-mode handles.) */
+    unsigned char packet_preroll;
+    /* Flag: has a new link with a different audio format been started in
+     * a chained stream?  (The new format is applied once all data from
+     * the previous link has been returned; see decode_frame().) */
+    unsigned char link_changed;
+    /* Pseudorandom generator state for int16 dither (see
+     * src/util/float-to-int16.h). */
+    uint32_t dither_state[DITHER_STATE_SIZE];
 
 };  /* struct vorbis_t */
 
@@ -264,8 +312,17 @@ typedef struct stb_vorbis_info {
     int32_t max_bitrate;
     int channels;
     int max_frame_size;
+    uint32_t bitstream_id;
 } stb_vorbis_info;
 
+typedef struct stb_vorbis_seek_point {
+    /* File offsets of the beginning and end of the Ogg page. */
+    int64_t page_start, page_end;
+    /* Sample offsets of the first and last fully decoded samples in the
+     * page (as for ProbedPage in src/decode/common.h). */
+    uint64_t first_sample, last_sample;
+} stb_vorbis_seek_point;
+
 typedef enum STBVorbisError
 {
     VORBIS__no_error = 0,
@@ -364,6 +421,20 @@ extern STBVorbisError stb_vorbis_get_error(stb_vorbis *handle);
 #define stb_vorbis_get_info INTERNAL(stb_vorbis_get_info)
 extern stb_vorbis_info stb_vorbis_get_info(stb_vorbis *handle);
 
+/**
+ * stb_vorbis_set_channel_mask:  Set which channels' audio data is needed
+ * by the caller.  Channels not in the mask are returned as silence, and
+ * the decoder skips as much of their processing as the stream's channel
+ * coupling allows.
+ *
+ * [Parameters]
+ *     handle: Decoder handle.
+ *     mask: Bitmask of channels to decode (bit N = channel N).  Channels
+ *         64 and above are always decoded.
+ */
+#define stb_vorbis_set_channel_mask INTERNAL(stb_vorbis_set_channel_mask)
+extern void stb_vorbis_set_channel_mask(stb_vorbis *handle, uint64_t mask);
+
 /**
  * stb_vorbis_stream_length_in_samples:  Return the length of the stream.
  * This function returns 0 (unknown) on an unseekable stream.
@@ -397,6 +468,123 @@ extern uint64_t stb_vorbis_stream_length_in_samples(stb_vorbis *handle);
 #define stb_vorbis_seek INTERNAL(stb_vorbis_seek)
 extern int stb_vorbis_seek(stb_vorbis *handle, uint64_t sample_number);
 
+/**
+ * stb_vorbis_seek_approximate:  Seek to the beginning of the Ogg page
+ * containing the given sample.  Decoding resumes at the first complete
+ * frame on the page, without decoding any preceding data; the sample
+ * position of the first sample to be returned can be retrieved with
+ * stb_vorbis_tell_pcm().  If the target is located by other means than
+ * a page search (such as with a frame map), the seek may be exact, as
+ * indicated by the return value.
+ *
+ * [Parameters]
+ *     handle: Decoder handle.
+ *     sample_number: Sample to seek to (0 is the first sample of the stream).
+ * [Return value]
+ *     Offset of the requested sample in the next frame returned by
+ *     stb_vorbis_get_frame_float() if the seek was exact, otherwise 0.
+ */
+#define stb_vorbis_seek_approximate INTERNAL(stb_vorbis_seek_approximate)
+extern int stb_vorbis_seek_approximate(stb_vorbis *handle,
+                                       uint64_t sample_number);
+
+/**
+ * stb_vorbis_build_seek_index:  Scan the entire stream and record the
+ * position of each Ogg page usable as a seek anchor, so that subsequent
+ * seeks can locate the target page without searching.  This also
+ * determines the stream length.  The current read position is preserved.
+ *
+ * [Parameters]
+ *     handle: Decoder handle.
+ * [Return value]
+ *     True on success, false on error.
+ */
+#define stb_vorbis_build_seek_index INTERNAL(stb_vorbis_build_seek_index)
+extern bool stb_vorbis_build_seek_index(stb_vorbis *handle);
+
+/**
+ * stb_vorbis_get_seek_index:  Return the stream's seek index, if any.
+ *
+ * [Parameters]
+ *     handle: Decoder handle.
+ *     points_ret: Pointer to variable to receive a pointer to the array
+ *         of seek points.  The array remains valid until the handle is
+ *         closed or the seek index is replaced.
+ * [Return value]
+ *     Number of seek points, or 0 if no seek index is present.
+ */
+#define stb_vorbis_get_seek_index INTERNAL(stb_vorbis_get_seek_index)
+extern int stb_vorbis_get_seek_index(stb_vorbis *handle,
+                                     const stb_vorbis_seek_point **points_ret);
+
+/**
+ * stb_vorbis_set_seek_index:  Install a seek index previously obtained
+ * from stb_vorbis_get_seek_index() for the same stream.  The data is
+ * checked for consistency with the stream, but the stream itself is not
+ * read.
+ *
+ * [Parameters]
+ *     handle: Decoder handle.
+ *     points: Array of seek points (copied by this function).
+ *     count: Number of seek points (must be positive).
+ * [Return value]
+ *     True on success; false if the data is not consistent with the
+ *     stream or on allocation failure.
+ */
+#define stb_vorbis_set_seek_index INTERNAL(stb_vorbis_set_seek_index)
+extern bool stb_vorbis_set_seek_index(stb_vorbis *handle,
+                                      const stb_vorbis_seek_point *points,
+                                      int count);
+
+/**
+ * stb_vorbis_set_probe_window:  Set the size of the read buffer used when
+ * probing for pages during a seek.  With a nonzero size, each probe reads
+ * that many bytes from the stream in a single read operation, and later
+ * probes which fall within the same window are served from the buffer.
+ *
+ * [Parameters]
+ *     handle: Decoder handle.
+ *     size: Buffer size, in bytes, or 0 to disable buffering.
+ * [Return value]
+ *     True on success, false on allocation failure.
+ */
+#define stb_vorbis_set_probe_window INTERNAL(stb_vorbis_set_probe_window)
+extern bool stb_vorbis_set_probe_window(stb_vorbis *handle, int32_t size);
+
+/**
+ * stb_vorbis_build_frame_map:  Scan the entire stream and record the
+ * position and window shape of every audio packet, so that subsequent
+ * seeks can position the decoder directly at the required packet without
+ * scanning.  The decoder state is left undefined, so the caller must seek
+ * to a valid position after calling this function.
+ *
+ * [Parameters]
+ *     handle: Decoder handle.
+ * [Return value]
+ *     True on success, false on error.
+ */
+#define stb_vorbis_build_frame_map INTERNAL(stb_vorbis_build_frame_map)
+extern bool stb_vorbis_build_frame_map(stb_vorbis *handle);
+
+/**
+ * stb_vorbis_skip:  Advance the decode position toward the given sample
+ * by reading only the header of each packet, without decoding any audio
+ * data.  Scanning stops a short distance before the target sample, and
+ * the following frame is decoded and discarded so that subsequent frames
+ * decode correctly; the caller must decode and discard any remaining
+ * samples up to the target.  The new position can be retrieved with
+ * stb_vorbis_tell_pcm().
+ *
+ * This function does nothing if the first frame of the stream has not
+ * yet been decoded.  Errors are reported through stb_vorbis_get_error().
+ *
+ * [Parameters]
+ *     handle: Decoder handle.
+ *     target_sample: Sample to skip to.
+ */
+#define stb_vorbis_skip INTERNAL(stb_vorbis_skip)
+extern void stb_vorbis_skip(stb_vorbis *handle, uint64_t target_sample);
+
 /**
  * stb_vorbis_tell_pcm:  Return the current sample offset, which is the end
  * of the frame most recently returned by stb_vorbis_get_frame_float() (i.e.,
@@ -436,6 +624,100 @@ extern uint64_t stb_vorbis_tell_bits(stb_vorbis *handle);
 #define stb_vorbis_reset_eof INTERNAL(stb_vorbis_reset_eof)
 extern void stb_vorbis_reset_eof(stb_vorbis *handle);
 
+/**
+ * stb_vorbis_reset_packet_state:  Discard all state carried over from
+ * previously decoded packets, so that the next packet is decoded as if
+ * it were the first audio packet in the stream.  Only valid for
+ * packet-mode decoders.
+ *
+ * [Parameters]
+ *     handle: Decoder handle.
+ */
+#define stb_vorbis_reset_packet_state INTERNAL(stb_vorbis_reset_packet_state)
+extern void stb_vorbis_reset_packet_state(stb_vorbis *handle);
+
+/**
+ * stb_vorbis_link_pending:  Return whether decoding of a chained stream
+ * has reached the start of a new link.  When this function returns true,
+ * the decoder reports end of stream until stb_vorbis_next_link() is
+ * called.
+ *
+ * [Parameters]
+ *     handle: Decoder handle.
+ * [Return value]
+ *     True if a new link is pending, false if not.
+ */
+#define stb_vorbis_link_pending INTERNAL(stb_vorbis_link_pending)
+extern bool stb_vorbis_link_pending(stb_vorbis *handle);
+
+/**
+ * stb_vorbis_next_link:  Read the headers for a pending link in a chained
+ * stream and prepare to decode its audio data.  The stream parameters
+ * returned by stb_vorbis_get_info() are updated for the new link, and
+ * sample positions continue from the end of the previous link.
+ *
+ * [Parameters]
+ *     handle: Decoder handle.
+ * [Return value]
+ *     True on success, false on error.
+ */
+#define stb_vorbis_next_link INTERNAL(stb_vorbis_next_link)
+extern bool stb_vorbis_next_link(stb_vorbis *handle);
+
+/**
+ * stb_vorbis_set_link_start:  Set the sample position of the first sample
+ * of the current link in a chained stream.  Only valid immediately after
+ * a successful call to stb_vorbis_next_link().
+ *
+ * [Parameters]
+ *     handle: Decoder handle.
+ *     position: Sample position to assign to the start of the link.
+ */
+#define stb_vorbis_set_link_start INTERNAL(stb_vorbis_set_link_start)
+extern void stb_vorbis_set_link_start(stb_vorbis *handle, uint64_t position);
+
+/**
+ * stb_vorbis_snapshot_size:  Return the number of bytes needed to store
+ * the current decoder state with stb_vorbis_snapshot().
+ *
+ * [Parameters]
+ *     handle: Decoder handle.
+ * [Return value]
+ *     Size of the decoder state, in bytes.
+ */
+#define stb_vorbis_snapshot_size INTERNAL(stb_vorbis_snapshot_size)
+extern int32_t stb_vorbis_snapshot_size(stb_vorbis *handle);
+
+/**
+ * stb_vorbis_snapshot:  Save the decoder state needed to resume decoding
+ * from the current stream position: the stream read position and Ogg
+ * page state, the sample position, and the overlap data from the
+ * previous frame.  Only valid for seekable streams.
+ *
+ * [Parameters]
+ *     handle: Decoder handle.
+ *     buf: Buffer into which to store the state (need not be aligned).
+ *         Must have room for stb_vorbis_snapshot_size() bytes.
+ */
+#define stb_vorbis_snapshot INTERNAL(stb_vorbis_snapshot)
+extern void stb_vorbis_snapshot(stb_vorbis *handle, void *buf);
+
+/**
+ * stb_vorbis_restore:  Restore decoder state saved with
+ * stb_vorbis_snapshot().  The stream is repositioned with the seek
+ * callback, but no data is read.
+ *
+ * [Parameters]
+ *     handle: Decoder handle.
+ *     buf: Buffer containing the saved state (need not be aligned).
+ *     size: Size of the saved state, in bytes.
+ * [Return value]
+ *     True on success, false if the data is not valid for this decoder.
+ */
+#define stb_vorbis_restore INTERNAL(stb_vorbis_restore)
+extern bool stb_vorbis_restore(stb_vorbis *handle, const void *buf,
+                               int32_t size);
+
 /**
  * stb_vorbis_get_frame_float:  Decode the next Vorbis frame into
  * floating-point PCM samples.  Only valid for non-packet-mode decoders.
@@ -25,6 +25,10 @@
 /* Maximum number of floor-1 X list entries (defined by the Vorbis spec). */
 #define FLOOR1_X_LIST_MAX  65
 
+/* Number of pages found by seek operations to remember for use in
+ * subsequent seeks. */
+#define PROBE_CACHE_SIZE  32
+
 /* Internal helper which evaluates to "const" when precomputed lookup
  * tables are in use, to ensure that code does not try to overwrite
  * constant data. */
@@ -65,14 +69,23 @@ typedef struct Codebook {
      * from the 16-bit integer multiplicands read from the stream into the
      * corresponding "minimum + delta * multiplicand" values. */
     float *multiplicands;
-    /* Lookup table for O(1) decoding of short codewords. */
+    /* Lookup table for O(1) decoding of short codewords, and the number
+     * of bits (and corresponding mask) used to index it.  The table size
+     * is chosen separately for each codebook. */
     int16_t *fast_huffman;
+    uint32_t fast_huffman_mask;
+    int8_t fast_huffman_length;
     /* Sorted lookup table for binary search of longer codewords. */
     uint32_t *sorted_codewords;
     /* Symbol corresponding to each codeword in sorted_codewords[]. */
     int32_t *sorted_values;
     /* Number of entries in the sorted tables. */
     int32_t sorted_entries;
+    /* Multi-level lookup tables for codewords not resolved by the O(1)
+     * table, or NULL if not used (see compute_long_huffman() in setup.c).
+     * A fast_huffman[] value of -2-k indicates that decoding continues
+     * from long_huffman[k]. */
+    int32_t *long_huffman;
 } Codebook;
 
 /* Data for a type 0 floor curve. */
@@ -86,8 +99,17 @@ typedef struct Floor0 {
     int8_t number_of_books;
     int8_t book_bits;
     uint8_t book_list[16];  // varies
-    /* Lookup table for the map function, for short and long windows. */
-    int16_t *map[2];
+    /* The map function (section 6.2.3 of the spec) is constant over runs
+     * of consecutive indices, so the floor curve only needs to be
+     * evaluated once per run.  For short and long windows respectively,
+     * run_count gives the number of runs, run_end[] gives the index one
+     * past the end of each run, and two_cos_omega[] gives 2*cos(omega)
+     * for each run, padded to a multiple of 4 entries by repeating the
+     * last value.  run_end[] shares the allocated block of
+     * two_cos_omega[0]. */
+    int16_t run_count[2];
+    int16_t *run_end[2];
+    float *two_cos_omega[2];
 } Floor0;
 
 /* Structure holding neighbor indices for Floor1.X_list. */
@@ -176,6 +198,33 @@ typedef struct ProbedPage {
     uint64_t last_decoded_sample;
 } ProbedPage;
 
+/* Data for a single audio packet in a frame map. */
+typedef struct FrameMapEntry {
+    /* File offset of the beginning of the page on which the packet
+     * starts. */
+    int64_t page_start;
+    /* Sample offset of the first fully decoded sample in the frame (the
+     * sample at the left_start window position). */
+    uint64_t frame_start;
+    /* Index of the packet's first segment within its page. */
+    uint8_t segment;
+    /* Length of the left overlap region of the window (left_end -
+     * left_start) and number of fully decoded samples returned by the
+     * frame (right_start - left_start). */
+    uint16_t overlap_len;
+    uint16_t length;
+} FrameMapEntry;
+
+/* Data for a keypoint from an Ogg Skeleton index. */
+typedef struct SkeletonKeypoint {
+    /* File offset of the beginning of the keypoint's page. */
+    int64_t page_start;
+    /* Approximate sample offset of the keypoint, converted from the
+     * index's timestamp.  This is only used to select a page, so it does
+     * not need to be exact. */
+    uint64_t sample;
+} SkeletonKeypoint;
+
 /* The top-level decoder handle structure. */
 struct stb_vorbis {
     /* Basic stream information. */
@@ -212,13 +261,17 @@ struct stb_vorbis {
      * vorbis_t pointer from the libnogg API functions. */
     void *mem_opaque;
 
-    /* Decoder configuration. */
-    uint32_t fast_huffman_mask;
+    /* Decoder configuration.  fast_huffman_length is the nominal size of
+     * the O(1) Huffman lookup tables; each codebook chooses its own size
+     * (see parse_codebooks()). */
     int8_t fast_huffman_length;
     bool huffman_binary_search;
     bool divides_in_residue;
     bool divides_in_codebook;
     bool scan_for_next_page;
+    /* Set of channels whose output is needed (bit N = channel N; channels
+     * 64 and above are always decoded).  See stb_vorbis_set_channel_mask(). */
+    uint64_t channel_mask;
 
     /* Operation results. */
     bool eof;
@@ -227,6 +280,25 @@ struct stb_vorbis {
     /* Have we started decoding yet?  (This flag is set when the handle
      * is created and cleared when the first frmae is decoded.) */
     bool first_decode;
+    /* Should the next frame be decoded without its left half, as for the
+     * first frame of the stream?  (This flag is set by an approximate
+     * seek, which starts decoding without a preceding frame to supply the
+     * overlap data.)  If so, restart_loc gives the sample position of the
+     * center of that frame's window. */
+    bool restart_decode;
+    uint64_t restart_loc;
+
+    /* Chained stream state.  chained_streams is set by the
+     * VORBIS_OPTION_CHAINED_STREAMS option.  link_ended is set when the
+     * last page of the current link has been seen, and link_pending is
+     * set when the first page of the next link has been read (in which
+     * case decoding stops until stb_vorbis_next_link() is called).
+     * link_base is the sample position of the first sample of the current
+     * link, which is added to all granule positions read from its pages. */
+    bool chained_streams;
+    bool link_ended;
+    bool link_pending;
+    uint64_t link_base;
 
     /* Stream configuration. */
     int16_t blocksize[2];
@@ -300,6 +372,49 @@ struct stb_vorbis {
     /* Information about the first and last pages containing audio data.
      * Used in seeking. */
     ProbedPage p_first, p_last;
+    /* Page index used for seeking, or NULL if none has been built or
+     * loaded.  The first entry is always the first audio page, with a
+     * first_sample of 0. */
+    stb_vorbis_seek_point *seek_index;
+    int seek_index_size;
+    /* Pages found while searching in previous seek operations, sorted by
+     * page_start.  Used to narrow the range of subsequent searches. */
+    ProbedPage probe_cache[PROBE_CACHE_SIZE];
+    int probe_cache_len;
+    /* Read buffer used when probing for pages during a seek, so that
+     * each probe needs only one read from the stream (and probes close
+     * to a previous one may need none at all), or NULL if not enabled.
+     * The buffer holds probe_buf_len bytes of stream data starting at
+     * file offset probe_buf_start.  While probe_mode is true, page
+     * lookups read from this buffer, and probe_pos gives the logical
+     * stream read position. */
+    uint8_t *probe_buf;
+    int32_t probe_buf_size;
+    int32_t probe_buf_len;
+    int64_t probe_buf_start;
+    int64_t probe_pos;
+    bool probe_mode;
+    /* Map of every audio packet in the stream, or NULL if none has been
+     * built.  Entries are in stream order. */
+    FrameMapEntry *frame_map;
+    int frame_map_size;
+
+    /* Ogg Skeleton stream data (see skeleton.c).  skeleton_id is only
+     * valid if skeleton_present is true. */
+    bool skeleton_present;
+    /* True once the Skeleton stream's header packets have all been seen
+     * (or we have given up on parsing them). */
+    bool skeleton_done;
+    uint32_t skeleton_id;
+    /* Length of the physical stream as recorded in the Skeleton header,
+     * or 0 if unknown. */
+    uint64_t skeleton_segment_length;
+    /* Buffer for reassembling Skeleton packets which span pages. */
+    uint8_t *skeleton_packet;
+    int32_t skeleton_packet_len, skeleton_packet_size;
+    /* Keypoint index for our Vorbis stream, or NULL if none. */
+    SkeletonKeypoint *skeleton_index;
+    int skeleton_index_size;
 
     /* Accumulator for bits read from the stream. */
     unsigned long acc;
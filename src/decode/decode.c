@@ -50,6 +50,14 @@
 /****************************** Local data *******************************/
 /*************************************************************************/
 
+/* Minimum block size (as a power of 2) for which step 3 of the IMDCT is
+ * performed in cache-sized blocks, and the size of those blocks in
+ * elements (see imdct_step3_blocked()).  1024 elements (4k) leaves room
+ * in a typical 32k L1 cache for the twiddle factors and other data.  The
+ * block size must be a power of 2 no less than 64. */
+#define IMDCT_BLOCK_MIN_BITS  12
+#define IMDCT_BLOCK_SIZE      1024
+
 /* Lookup table for type 1 floor curve generation, copied from the Vorbis
  * specification. */
 static float floor1_inverse_db_table[256] =
@@ -280,17 +288,39 @@ static inline __m256 _mm256_xor_sign(__m256i sign_mask, __m256 value) {
 /**
  * codebook_decode_scalar_raw_slow:  Slow path for Huffman decoding,
  * searching through the lookup tables to decode the next symbol.
+ * fast_code is the (negative) value found in the O(1) lookup table.
  */
 static int32_t codebook_decode_scalar_raw_slow(stb_vorbis *handle,
-                                               const Codebook *book)
+                                               const Codebook *book,
+                                               int fast_code)
 {
     /* Fill the bit accumulator far enough to read any valid code. */
     if (handle->valid_bits < 24) {
         fill_bits(handle);
     }
 
-    /* Find the code using binary search if we can, linear search otherwise. */
-    if (book->sorted_codewords) {
+    /* If the O(1) table links to a multi-level table, walk the subtables
+     * until we reach a leaf entry (see compute_long_huffman() in setup.c).
+     * Otherwise, find the code using binary search if we can, linear
+     * search otherwise. */
+    if (fast_code < -1) {
+        int32_t entry = book->long_huffman[-2 - fast_code];
+        int consumed = book->fast_huffman_length;
+        while (entry < 0) {
+            const int32_t offset = -entry >> 5;
+            const int bits = -entry & 31;
+            entry = book->long_huffman[offset + ((handle->acc >> consumed)
+                                                 & ((1U << bits) - 1))];
+            consumed += bits;
+        }
+        const int len = book->codeword_lengths[entry];
+        handle->acc >>= len;
+        handle->valid_bits -= len;
+        if (UNLIKELY(handle->valid_bits < 0)) {
+            return -1;
+        }
+        return entry;
+    } else if (book->sorted_codewords) {
         const uint32_t code = bit_reverse(handle->acc);
         int32_t low = 0, high = book->sorted_entries;
         /* Invariant: sorted_codewords[low] <= code < sorted_codewords[high] */
@@ -357,7 +387,7 @@ static inline int32_t codebook_decode_scalar_raw(stb_vorbis *handle,
     /* First try the O(1) table.  We only fill the bit accumulator if we
      * don't have enough bits for the fast table, to avoid overhead from
      * repeatedly reading single bytes from the packet. */
-    if (handle->valid_bits < handle->fast_huffman_length) {
+    if (handle->valid_bits < book->fast_huffman_length) {
         /* Note that moving this "semi-fast" path out to a separate
          * function is no faster, and possibly slower (though not
          * significantly so), than just calling fill_bits() here, at least
@@ -365,7 +395,7 @@ static inline int32_t codebook_decode_scalar_raw(stb_vorbis *handle,
         fill_bits(handle);
     }
     const int fast_code =
-        book->fast_huffman[handle->acc & handle->fast_huffman_mask];
+        book->fast_huffman[handle->acc & book->fast_huffman_mask];
     if (fast_code >= 0) {
         const int bits = book->codeword_lengths[fast_code];
         handle->acc >>= bits;
@@ -377,7 +407,7 @@ static inline int32_t codebook_decode_scalar_raw(stb_vorbis *handle,
     }
 
     /* Fall back to the slow (table search) method. */
-    return codebook_decode_scalar_raw_slow(handle, book);
+    return codebook_decode_scalar_raw_slow(handle, book, fast_code);
 }
 
 /*-----------------------------------------------------------------------*/
@@ -707,21 +737,68 @@ static bool codebook_decode_deinterleave_repeat_2(
             return false;
         }
 
-        const int32_t offset = code * book->dimensions;
+        const float *vector = &book->multiplicands[code * book->dimensions];
         int i = 0;
         if (c_inter == 1) {
-            output1[p_inter] += book->multiplicands[offset];
+            output1[p_inter] += vector[0];
             c_inter = 0;
             p_inter++;
             i++;
         }
+        /* Split the vector into even (channel 0) and odd (channel 1)
+         * elements and add them to the outputs a vector at a time.
+         * Codebooks with 4 or 8 dimensions are the usual case. */
+#if defined(ENABLE_ASM_ARM_NEON)
+        for (; i+8 <= len; i += 8, p_inter += 4) {
+            const float32x4x2_t v = vld2q_f32(&vector[i]);
+            vst1q_f32(&output0[p_inter],
+                      vaddq_f32(vld1q_f32(&output0[p_inter]), v.val[0]));
+            vst1q_f32(&output1[p_inter],
+                      vaddq_f32(vld1q_f32(&output1[p_inter]), v.val[1]));
+        }
+        if (i+4 <= len) {
+            const float32x2x2_t v = vld2_f32(&vector[i]);
+            vst1_f32(&output0[p_inter],
+                     vadd_f32(vld1_f32(&output0[p_inter]), v.val[0]));
+            vst1_f32(&output1[p_inter],
+                     vadd_f32(vld1_f32(&output1[p_inter]), v.val[1]));
+            i += 4;
+            p_inter += 2;
+        }
+#elif defined(ENABLE_ASM_X86_SSE2)
+        for (; i+8 <= len; i += 8, p_inter += 4) {
+            const __m128 v_lo = _mm_loadu_ps(&vector[i]);
+            const __m128 v_hi = _mm_loadu_ps(&vector[i+4]);
+            _mm_storeu_ps(&output0[p_inter], _mm_add_ps(
+                              _mm_loadu_ps(&output0[p_inter]),
+                              _mm_shuffle_ps(v_lo, v_hi,
+                                             _MM_SHUFFLE(2,0,2,0))));
+            _mm_storeu_ps(&output1[p_inter], _mm_add_ps(
+                              _mm_loadu_ps(&output1[p_inter]),
+                              _mm_shuffle_ps(v_lo, v_hi,
+                                             _MM_SHUFFLE(3,1,3,1))));
+        }
+        if (i+4 <= len) {
+            /* Load the two output pairs into the low and high halves of
+             * a single register so one add covers both channels. */
+            const __m128 v = _mm_loadu_ps(&vector[i]);
+            __m128 out = _mm_loadl_pi(_mm_setzero_ps(),
+                                      (const __m64 *)&output0[p_inter]);
+            out = _mm_loadh_pi(out, (const __m64 *)&output1[p_inter]);
+            out = _mm_add_ps(out, _mm_shuffle_ps(v, v, _MM_SHUFFLE(3,1,2,0)));
+            _mm_storel_pi((__m64 *)&output0[p_inter], out);
+            _mm_storeh_pi((__m64 *)&output1[p_inter], out);
+            i += 4;
+            p_inter += 2;
+        }
+#endif
         for (; i+2 <= len; i += 2) {
-            output0[p_inter] += book->multiplicands[offset+i];
-            output1[p_inter] += book->multiplicands[offset+i+1];
+            output0[p_inter] += vector[i];
+            output1[p_inter] += vector[i+1];
             p_inter++;
         }
         if (i < len) {
-            output0[p_inter] += book->multiplicands[offset+i];
+            output0[p_inter] += vector[i];
             c_inter++;
         }
 
@@ -731,6 +808,83 @@ static bool codebook_decode_deinterleave_repeat_2(
     return true;
 }
 
+/*-----------------------------------------------------------------------*/
+
+/**
+ * codebook_decode_deinterleave_repeat_fixed:  Read Huffman codes from the
+ * packet and decode them in VQ context using the given codebook,
+ * deinterleaving across "ch" output channels.  This function is a
+ * specialization of codebook_decode_deinterleave_repeat() for the case
+ * of all output channels active and VORBIS_OPTION_DIVIDES_IN_CODEBOOK
+ * disabled; it is always inlined so that callers passing a constant
+ * channel count get code with a compile-time stride.
+ *
+ * If an error occurs, the current packet is flushed.
+ *
+ * [Parameters]
+ *     handle: Stream handle.
+ *     book: Codebook to use.
+ *     outputs: Output vectors for each channel.
+ *     ch: Number of channels.
+ *     n: Length of each output vector.
+ *     total_offset: Offset within the interleaved output vector at which
+ *         to start writing output values.
+ *     total_decode: Total number of elements to read.
+ * [Return value]
+ *     True on success, false on error or end-of-packet.
+ */
+static ALWAYS_INLINE bool codebook_decode_deinterleave_repeat_fixed(
+    stb_vorbis *handle, const Codebook *book, float **outputs, const int ch,
+    int n, int32_t total_offset, int32_t total_decode)
+{
+    if (total_decode > ch*n - total_offset) {
+        total_decode = ch*n - total_offset;
+    }
+    int c_inter = total_offset % ch;
+    int p_inter = total_offset / ch;
+    int len = book->dimensions;
+
+    while (total_decode > 0) {
+        /* Make sure we don't run off the end of the output vectors. */
+        if (len > total_decode) {
+            len = total_decode;
+        }
+
+        const int32_t code = codebook_decode_scalar_for_vq(handle, book);
+        if (UNLIKELY(code < 0)) {
+            return false;
+        }
+
+        const float *vector = &book->multiplicands[code * book->dimensions];
+        int i = 0;
+        /* Finish the interleaved sample left incomplete by the previous
+         * vector, if any. */
+        if (c_inter > 0) {
+            for (; c_inter < ch && i < len; i++, c_inter++) {
+                outputs[c_inter][p_inter] += vector[i];
+            }
+            if (c_inter == ch) {
+                c_inter = 0;
+                p_inter++;
+            }
+        }
+        /* Add whole samples (one value for each channel). */
+        for (; i+ch <= len; i += ch, p_inter++) {
+            for (int c = 0; c < ch; c++) {
+                outputs[c][p_inter] += vector[i+c];
+            }
+        }
+        /* Start the next sample with whatever is left. */
+        for (; i < len; i++, c_inter++) {
+            outputs[c_inter][p_inter] += vector[i];
+        }
+
+        total_decode -= len;
+    }
+
+    return true;
+}
+
 /*************************************************************************/
 /*************************** Floor processing ****************************/
 /*************************************************************************/
@@ -1052,44 +1206,104 @@ static void do_floor0_final(stb_vorbis *handle, const Floor0 *floor,
 {
     float *output = handle->channel_buffers[handle->cur_channel_buffer][ch];
     float *coefficients = handle->coefficients[ch];
-    const int16_t *map = floor->map[(n == handle->blocksize[1])];
-    const float omega_base = M_PIf / floor->bark_map_size;
+    const int blocktype = (n == handle->blocksize[1]);
+    const float *two_cos_omega = floor->two_cos_omega[blocktype];
+    const int16_t *run_end = floor->run_end[blocktype];
+    const int run_count = floor->run_count[blocktype];
+    const int order = floor->order;
     const float scaled_amplitude = (float)amplitude
         / (float)((UINT64_C(1) << floor->amplitude_bits) - 1);
     const float lfv_scale = 0.11512925f * floor->amplitude_offset;
 
-    for (int i = 0; i < floor->order; i++) {
+    for (int i = 0; i < order; i++) {
         coefficients[i] = 2 * cosf(coefficients[i]);
     }
 
+    /* The floor curve is evaluated for 4 runs at a time; two_cos_omega[]
+     * is padded so that reading past the last run is safe.  The products
+     * are computed in the same order in each lane as in the scalar code,
+     * so the results are identical. */
     int i = 0;
-    do {
-        const float two_cos_omega = 2 * cosf(map[i] * omega_base);
-        float p = 0.5, q = 0.5;
+    for (int run = 0; run < run_count; run += 4) {
+        float p[4], q[4];
         int j;
-        for (j = 0; j <= (floor->order - 2) / 2; j++) {
-            p *= coefficients[2*j+1] - two_cos_omega;
-            q *= coefficients[2*j] - two_cos_omega;
-        }
-        if (floor->order % 2 != 0) {
-            q *= coefficients[2*j] - two_cos_omega;
-            /* The spec gives this as "4 - cos^2(omega)", but we use the
-             * equality (a^2-b^2) = (a+b)(a-b) to give us constants
-             * common between both branches of the if statement. */
-            p *= p * (2 + two_cos_omega) * (2 - two_cos_omega);
-            q *= q;
+#if defined(ENABLE_ASM_ARM_NEON)
+        const float32x4_t tco = vld1q_f32(&two_cos_omega[run]);
+        const float32x4_t two = vdupq_n_f32(2);
+        float32x4_t vp = vdupq_n_f32(0.5f), vq = vdupq_n_f32(0.5f);
+        for (j = 0; j <= (order - 2) / 2; j++) {
+            vp = vmulq_f32(vp, vsubq_f32(vdupq_n_f32(coefficients[2*j+1]),
+                                         tco));
+            vq = vmulq_f32(vq, vsubq_f32(vdupq_n_f32(coefficients[2*j]),
+                                         tco));
+        }
+        if (order % 2 != 0) {
+            vq = vmulq_f32(vq, vsubq_f32(vdupq_n_f32(coefficients[2*j]),
+                                         tco));
+            vp = vmulq_f32(vp, vmulq_f32(vmulq_f32(vp, vaddq_f32(two, tco)),
+                                         vsubq_f32(two, tco)));
+            vq = vmulq_f32(vq, vq);
         } else {
-            p *= p * (2 - two_cos_omega);
-            q *= q * (2 + two_cos_omega);
+            vp = vmulq_f32(vp, vmulq_f32(vp, vsubq_f32(two, tco)));
+            vq = vmulq_f32(vq, vmulq_f32(vq, vaddq_f32(two, tco)));
         }
-        const float linear_floor_value =
-            expf(lfv_scale * ((scaled_amplitude / sqrtf(p + q)) - 1));
-        const int iteration_condition = map[i];
-        do {
-            output[i] *= linear_floor_value;
-            i++;
-        } while (map[i] == iteration_condition);
-    } while (i < n/2);
+        vst1q_f32(p, vp);
+        vst1q_f32(q, vq);
+#elif defined(ENABLE_ASM_X86_SSE2)
+        const __m128 tco = _mm_loadu_ps(&two_cos_omega[run]);
+        const __m128 two = _mm_set1_ps(2);
+        __m128 vp = _mm_set1_ps(0.5f), vq = _mm_set1_ps(0.5f);
+        for (j = 0; j <= (order - 2) / 2; j++) {
+            vp = _mm_mul_ps(vp, _mm_sub_ps(_mm_set1_ps(coefficients[2*j+1]),
+                                           tco));
+            vq = _mm_mul_ps(vq, _mm_sub_ps(_mm_set1_ps(coefficients[2*j]),
+                                           tco));
+        }
+        if (order % 2 != 0) {
+            vq = _mm_mul_ps(vq, _mm_sub_ps(_mm_set1_ps(coefficients[2*j]),
+                                           tco));
+            vp = _mm_mul_ps(vp, _mm_mul_ps(_mm_mul_ps(vp, _mm_add_ps(two, tco)),
+                                           _mm_sub_ps(two, tco)));
+            vq = _mm_mul_ps(vq, vq);
+        } else {
+            vp = _mm_mul_ps(vp, _mm_mul_ps(vp, _mm_sub_ps(two, tco)));
+            vq = _mm_mul_ps(vq, _mm_mul_ps(vq, _mm_add_ps(two, tco)));
+        }
+        _mm_storeu_ps(p, vp);
+        _mm_storeu_ps(q, vq);
+#else
+        for (int k = 0; k < 4; k++) {
+            const float tco = two_cos_omega[run+k];
+            p[k] = q[k] = 0.5f;
+            for (j = 0; j <= (order - 2) / 2; j++) {
+                p[k] *= coefficients[2*j+1] - tco;
+                q[k] *= coefficients[2*j] - tco;
+            }
+            if (order % 2 != 0) {
+                q[k] *= coefficients[2*j] - tco;
+                /* The spec gives this as "4 - cos^2(omega)", but we use
+                 * the equality (a^2-b^2) = (a+b)(a-b) to give us
+                 * constants common between both branches of the if
+                 * statement. */
+                p[k] *= p[k] * (2 + tco) * (2 - tco);
+                q[k] *= q[k];
+            } else {
+                p[k] *= p[k] * (2 - tco);
+                q[k] *= q[k] * (2 + tco);
+            }
+        }
+#endif  // ENABLE_ASM_*
+
+        const int limit = min(4, run_count - run);
+        for (int k = 0; k < limit; k++) {
+            const float linear_floor_value =
+                expf(lfv_scale * ((scaled_amplitude / sqrtf(p[k] + q[k])) - 1));
+            const int end = run_end[run+k];
+            for (; i < end; i++) {
+                output[i] *= linear_floor_value;
+            }
+        }
+    }
 }
 
 /*-----------------------------------------------------------------------*/
@@ -1148,7 +1362,7 @@ static void do_floor1_final(stb_vorbis *handle, const Floor1 *floor,
  * [Return value]
  *     True on success, false on end of packet.
  */
-static bool decode_residue_partition_0(
+static ALWAYS_INLINE bool decode_residue_partition_0(
     stb_vorbis *handle, const Codebook *book, int size, int offset,
     float **output_ptr, UNUSED int n, UNUSED int ch)
 {
@@ -1181,7 +1395,7 @@ static bool decode_residue_partition_0(
  * [Return value]
  *     True on success, false on end of packet.
  */
-static bool decode_residue_partition_1(
+static ALWAYS_INLINE bool decode_residue_partition_1(
     stb_vorbis *handle, const Codebook *book, int size, int offset,
     float **output_ptr, UNUSED int n, UNUSED int ch)
 {
@@ -1212,7 +1426,7 @@ static bool decode_residue_partition_1(
  * [Return value]
  *     True on success, false on end of packet.
  */
-static bool decode_residue_partition_2(
+static ALWAYS_INLINE bool decode_residue_partition_2(
     stb_vorbis *handle, const Codebook *book, int size, int offset,
     float **outputs, int n, int ch)
 {
@@ -1238,7 +1452,7 @@ static bool decode_residue_partition_2(
  * [Return value]
  *     True on success, false on end of packet.
  */
-static bool decode_residue_partition_2_2ch(
+static ALWAYS_INLINE bool decode_residue_partition_2_2ch(
     stb_vorbis *handle, const Codebook *book, int size, int offset,
     float **outputs, int n, UNUSED int ch)
 {
@@ -1248,6 +1462,29 @@ static bool decode_residue_partition_2_2ch(
 
 /*-----------------------------------------------------------------------*/
 
+/**
+ * decode_residue_partition_2_Nch:  Decode a single residue partition for
+ * residue type 2 with N channels (3 through 8).  All channels must be
+ * active for decoding.  Parameters are as for decode_residue_partition_2().
+ */
+#define DEFINE_DECODE_RESIDUE_PARTITION_2_NCH(N)                        \
+static ALWAYS_INLINE bool decode_residue_partition_2_##N##ch(           \
+    stb_vorbis *handle, const Codebook *book, int size, int offset,     \
+    float **outputs, int n, UNUSED int ch)                              \
+{                                                                       \
+    return codebook_decode_deinterleave_repeat_fixed(                   \
+        handle, book, outputs, N, n, offset, size);                     \
+}
+DEFINE_DECODE_RESIDUE_PARTITION_2_NCH(3)
+DEFINE_DECODE_RESIDUE_PARTITION_2_NCH(4)
+DEFINE_DECODE_RESIDUE_PARTITION_2_NCH(5)
+DEFINE_DECODE_RESIDUE_PARTITION_2_NCH(6)
+DEFINE_DECODE_RESIDUE_PARTITION_2_NCH(7)
+DEFINE_DECODE_RESIDUE_PARTITION_2_NCH(8)
+#undef DEFINE_DECODE_RESIDUE_PARTITION_2_NCH
+
+/*-----------------------------------------------------------------------*/
+
 /**
  * decode_residue_partition:  Decode a single residue partition.
  *
@@ -1264,7 +1501,7 @@ static bool decode_residue_partition_2_2ch(
  * [Return value]
  *     True on success, false on end of packet.
  */
-static inline bool decode_residue_partition(
+static ALWAYS_INLINE bool decode_residue_partition(
     stb_vorbis *handle, const Residue *res, int pass, int partition_count,
     int vqclass, float **outputs, int n, int ch,
     bool (*do_partition)(
@@ -1307,12 +1544,13 @@ static inline bool decode_residue_partition(
  *         the residue vectors should be stored.  A pointer of NULL
  *         indicates that the given channel should not be decoded (the
  *         "do not decode" state referred to by the specification).
+ *     divides_in_residue: Value of handle->divides_in_residue.
  *     do_partition: Function pointer for the partition decoding function
  *         to use.
  */
-static void decode_residue_common(
-    stb_vorbis *handle, const Residue *res, int type, int n, int ch,
-    float *residue_buffers[],
+static ALWAYS_INLINE void decode_residue_common(
+    stb_vorbis *handle, const Residue *res, const int type, int n, int ch,
+    float *residue_buffers[], const bool divides_in_residue,
     bool (*do_partition)(
         stb_vorbis *handle, const Codebook *book, int size, int offset,
         float **outputs, int n, int ch))
@@ -1329,7 +1567,7 @@ static void decode_residue_common(
         return;
     }
 
-    if (handle->divides_in_residue) {
+    if (divides_in_residue) {
 
         int **classifications = handle->classifications;
 
@@ -1371,7 +1609,7 @@ static void decode_residue_common(
             }  // while (partition_count < partitions_to_read)
         }  // for (int pass = 0; pass < 8; pass++)
 
-    } else {  // !handle->divides_in_residue
+    } else {  // !divides_in_residue
 
         uint8_t ***part_classdata = handle->classifications;
 
@@ -1412,8 +1650,41 @@ static void decode_residue_common(
             }  // while (partition_count < partitions_to_read)
         }  // for (int pass = 0; pass < 8; pass++)
 
-    }  // if (handle->divides_in_residue)
+    }  // if (divides_in_residue)
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * decode_residue_*:  Instances of decode_residue_common() for each residue
+ * type, VORBIS_OPTION_DIVIDES_IN_RESIDUE setting, and partition decoding
+ * function.  Since the partition decoding function is known at compile
+ * time, it can be inlined into the decoding loop instead of being called
+ * through a function pointer for every partition.  Parameters are as for
+ * decode_residue_common().
+ */
+#define DEFINE_DECODE_RESIDUE(name, type, divides_in_residue, do_partition) \
+static NOINLINE void decode_residue_##name(                             \
+    stb_vorbis *handle, const Residue *res, int n, int ch,              \
+    float *residue_buffers[])                                           \
+{                                                                       \
+    decode_residue_common(handle, res, type, n, ch, residue_buffers,    \
+                          divides_in_residue, do_partition);            \
 }
+DEFINE_DECODE_RESIDUE(0,         0, false, decode_residue_partition_0)
+DEFINE_DECODE_RESIDUE(0_divides, 0, true,  decode_residue_partition_0)
+DEFINE_DECODE_RESIDUE(1,         1, false, decode_residue_partition_1)
+DEFINE_DECODE_RESIDUE(1_divides, 1, true,  decode_residue_partition_1)
+DEFINE_DECODE_RESIDUE(2,         2, false, decode_residue_partition_2)
+DEFINE_DECODE_RESIDUE(2_divides, 2, true,  decode_residue_partition_2)
+DEFINE_DECODE_RESIDUE(2_2ch,     2, false, decode_residue_partition_2_2ch)
+DEFINE_DECODE_RESIDUE(2_3ch,     2, false, decode_residue_partition_2_3ch)
+DEFINE_DECODE_RESIDUE(2_4ch,     2, false, decode_residue_partition_2_4ch)
+DEFINE_DECODE_RESIDUE(2_5ch,     2, false, decode_residue_partition_2_5ch)
+DEFINE_DECODE_RESIDUE(2_6ch,     2, false, decode_residue_partition_2_6ch)
+DEFINE_DECODE_RESIDUE(2_7ch,     2, false, decode_residue_partition_2_7ch)
+DEFINE_DECODE_RESIDUE(2_8ch,     2, false, decode_residue_partition_2_8ch)
+#undef DEFINE_DECODE_RESIDUE
 
 /*-----------------------------------------------------------------------*/
 
@@ -1443,23 +1714,49 @@ static void decode_residue(stb_vorbis *handle, int residue_index, int n,
     }
 
     /* For residue type 2, if there are multiple channels, we need to
-     * deinterleave the data after decoding it. */
+     * deinterleave the data after decoding it.  We have optimized
+     * handling for up to 8 channels when all channels are active (the
+     * optimized routines require lookup type 2 codebooks, so they are
+     * not used with VORBIS_OPTION_DIVIDES_IN_CODEBOOK). */
     if (type == 2 && ch > 1) {
-        if (ch == 2 && !handle->divides_in_residue
-         && residue_buffers[0] && residue_buffers[1]) {
-            /* We have slightly optimized handling for this case. */
-            decode_residue_common(
-                handle, res, type, n, ch, residue_buffers,
-                decode_residue_partition_2_2ch);
+        static void (* const residue_2_nch[9])(
+            stb_vorbis *handle, const Residue *res, int n, int ch,
+            float *residue_buffers[]) = {
+            [2] = decode_residue_2_2ch,
+            [3] = decode_residue_2_3ch,
+            [4] = decode_residue_2_4ch,
+            [5] = decode_residue_2_5ch,
+            [6] = decode_residue_2_6ch,
+            [7] = decode_residue_2_7ch,
+            [8] = decode_residue_2_8ch,
+        };
+        bool use_nch = (ch <= 8 && !handle->divides_in_residue
+                        && !handle->divides_in_codebook);
+        for (int i = 0; i < ch && use_nch; i++) {
+            if (!residue_buffers[i]) {
+                use_nch = false;
+            }
+        }
+        if (use_nch) {
+            (*residue_2_nch[ch])(handle, res, n, ch, residue_buffers);
+        } else if (handle->divides_in_residue) {
+            decode_residue_2_divides(handle, res, n, ch, residue_buffers);
+        } else {
+            decode_residue_2(handle, res, n, ch, residue_buffers);
+        }
+    } else if (type == 0) {
+        if (handle->divides_in_residue) {
+            decode_residue_0_divides(handle, res, n, ch, residue_buffers);
         } else {
-            decode_residue_common(
-                handle, res, type, n, ch, residue_buffers,
-                decode_residue_partition_2);
+            decode_residue_0(handle, res, n, ch, residue_buffers);
         }
     } else {
-        decode_residue_common(
-            handle, res, type, n, ch, residue_buffers,
-            type==0 ? decode_residue_partition_0 : decode_residue_partition_1);
+        /* Residue type 2 with a single channel is equivalent to type 1. */
+        if (handle->divides_in_residue) {
+            decode_residue_1_divides(handle, res, n, ch, residue_buffers);
+        } else {
+            decode_residue_1(handle, res, n, ch, residue_buffers);
+        }
     }
 }
 
@@ -2063,15 +2360,17 @@ static inline void iter_54(float *z)
  * [Parameters]
  *     n: Window size.
  *     A: Twiddle factor A.
- *     e: Input/output buffer (length n/2, modified in place).
+ *     e: Input/output buffer (modified in place).
+ *     size: Number of elements of e[] to process (a multiple of 16;
+ *         n/2 to process the entire buffer).
  */
 static void imdct_step3_inner_s_loop_ld654(
-    const unsigned int n, const float *A, float *e)
+    const unsigned int n, const float *A, float *e, int size)
 {
     const int a_off = n/8;
     const float A2 = A[a_off];
 
-    for (float *z = e + n/2; z > e; z -= 16) {
+    for (float *z = e + size; z > e; z -= 16) {
 
 #if defined(ENABLE_ASM_X86_SSE2) || defined(ENABLE_ASM_X86_AVX2)
 # if defined(ENABLE_ASM_X86_AVX2)
@@ -2153,6 +2452,72 @@ static void imdct_step3_inner_s_loop_ld654(
 
 /*-----------------------------------------------------------------------*/
 
+/**
+ * imdct_step3_blocked:  Step 3 of the IMDCT, reordered to improve cache
+ * locality for large block sizes.
+ *
+ * Each pass of step 3 splits every block of the previous pass into two
+ * independent halves, so once the blocks are small enough to fit in the
+ * L1 cache, all remaining passes can be completed on one block before
+ * moving on to the next.  This performs exactly the same operations as
+ * the pass-by-pass order used in inverse_mdct(), so the output is
+ * bit-identical; only the order of (independent) butterflies changes.
+ *
+ * [Parameters]
+ *     n: Window size.
+ *     log2_n: Base-2 logarithm of the window size.
+ *     A: Twiddle factor A.
+ *     e: Input/output buffer (length n/2, modified in place).
+ */
+static void imdct_step3_blocked(
+    const unsigned int n, const int log2_n, const float *A, float *e)
+{
+    /* Passes whose blocks are larger than IMDCT_BLOCK_SIZE elements are
+     * performed over the entire buffer as usual.  These are always in
+     * the range which uses the r loop form. */
+    int l = 0;
+    int k0 = n >> 2;
+    for (; k0 > IMDCT_BLOCK_SIZE; l++, k0 >>= 1) {
+        ASSERT(l < (log2_n-3)/2);
+        const int lim = 1 << (l+1);
+        for (int i = 0; i < lim; i++) {
+            imdct_step3_inner_r_loop(n >> (l+4), A, e, (n/2) - k0*i,
+                                     k0, 1 << (l+3));
+        }
+    }
+
+    /* Complete each block in turn. */
+    const int block_l = l;
+    const int block_size = k0;
+    for (int top = n/2; top > 0; top -= block_size) {
+        l = block_l;
+        k0 = block_size;
+        for (; l < (log2_n-3)/2; l++, k0 >>= 1) {
+            const int lim = block_size / k0;
+            for (int i = 0; i < lim; i++) {
+                imdct_step3_inner_r_loop(n >> (l+4), A, e, top - k0*i,
+                                         k0, 1 << (l+3));
+            }
+        }
+        for (; l < log2_n-6; l++, k0 >>= 1) {
+            const int k1 = 1 << (l+3);
+            const int rlim = n >> (l+6);
+            const int lim = block_size / k0;
+            const float *A0 = A;
+            int i_off = top;
+            for (int r = rlim; r > 0; r--) {
+                imdct_step3_inner_s_loop(lim, A0, e, i_off, k0, k1);
+                A0 += k1*4;
+                i_off -= 8;
+            }
+        }
+        imdct_step3_inner_s_loop_ld654(n, A, e + (top - block_size),
+                                       block_size);
+    }
+}
+
+/*-----------------------------------------------------------------------*/
+
 /**
  * imdct_step456:  Steps 4, 5, and 6 of the IMDCT.
  *
@@ -2563,44 +2928,52 @@ static void inverse_mdct(stb_vorbis *handle, float *buffer, int blocktype)
      * stb_vorbis note: "the original step3 loop can be nested r inside s
      * or s inside r; it's written originally as s inside r, but this is
      * dumb when r iterates many times, and s few. So I have two copies of
-     * it and switch between them halfway." */
+     * it and switch between them halfway."  For large block sizes, we
+     * reorder the passes to improve cache locality. */
+    if (log2_n >= IMDCT_BLOCK_MIN_BITS) {
 
-    imdct_step3_inner_r_loop(n/16, A, buffer, (n/2) - (n/4)*0, n/4, 8);
-    imdct_step3_inner_r_loop(n/16, A, buffer, (n/2) - (n/4)*1, n/4, 8);
+        imdct_step3_blocked(n, log2_n, A, buffer);
 
-    imdct_step3_inner_r_loop(n/32, A, buffer, (n/2) - (n/8)*0, n/8, 16);
-    imdct_step3_inner_r_loop(n/32, A, buffer, (n/2) - (n/8)*1, n/8, 16);
-    imdct_step3_inner_r_loop(n/32, A, buffer, (n/2) - (n/8)*2, n/8, 16);
-    imdct_step3_inner_r_loop(n/32, A, buffer, (n/2) - (n/8)*3, n/8, 16);
+    } else {
 
-    int l = 2;
-    for (; l < (log2_n-3)/2; l++) {
-        const int k0 = n >> (l+2);
-        const int lim = 1 << (l+1);
-        for (int i = 0; i < lim; i++) {
-            imdct_step3_inner_r_loop(n >> (l+4), A, buffer, (n/2) - k0*i,
-                                     k0, 1 << (l+3));
+        imdct_step3_inner_r_loop(n/16, A, buffer, (n/2) - (n/4)*0, n/4, 8);
+        imdct_step3_inner_r_loop(n/16, A, buffer, (n/2) - (n/4)*1, n/4, 8);
+
+        imdct_step3_inner_r_loop(n/32, A, buffer, (n/2) - (n/8)*0, n/8, 16);
+        imdct_step3_inner_r_loop(n/32, A, buffer, (n/2) - (n/8)*1, n/8, 16);
+        imdct_step3_inner_r_loop(n/32, A, buffer, (n/2) - (n/8)*2, n/8, 16);
+        imdct_step3_inner_r_loop(n/32, A, buffer, (n/2) - (n/8)*3, n/8, 16);
+
+        int l = 2;
+        for (; l < (log2_n-3)/2; l++) {
+            const int k0 = n >> (l+2);
+            const int lim = 1 << (l+1);
+            for (int i = 0; i < lim; i++) {
+                imdct_step3_inner_r_loop(n >> (l+4), A, buffer,
+                                         (n/2) - k0*i, k0, 1 << (l+3));
+            }
         }
-    }
 
-    for (; l < log2_n-6; l++) {
-        const int k0 = n >> (l+2), k1 = 1 << (l+3);
-        const int rlim = n >> (l+6);
-        const int lim = 1 << (l+1);
-        const float *A0 = A;
-        int i_off = n/2;
-        for (int r = rlim; r > 0; r--) {
-            imdct_step3_inner_s_loop(lim, A0, buffer, i_off, k0, k1);
-            A0 += k1*4;
-            i_off -= 8;
+        for (; l < log2_n-6; l++) {
+            const int k0 = n >> (l+2), k1 = 1 << (l+3);
+            const int rlim = n >> (l+6);
+            const int lim = 1 << (l+1);
+            const float *A0 = A;
+            int i_off = n/2;
+            for (int r = rlim; r > 0; r--) {
+                imdct_step3_inner_s_loop(lim, A0, buffer, i_off, k0, k1);
+                A0 += k1*4;
+                i_off -= 8;
+            }
         }
-    }
 
-    /* stb_vorbis note: "log2_n-6,-5,-4 all interleaved together - the big
-     * win comes from getting rid of needless flops due to the constants on
-     * pass 5 & 4 being all 1 and 0; combining them to be simultaneous to
-     * improve cache made little difference" */
-    imdct_step3_inner_s_loop_ld654(n, A, buffer);
+        /* stb_vorbis note: "log2_n-6,-5,-4 all interleaved together - the
+         * big win comes from getting rid of needless flops due to the
+         * constants on pass 5 & 4 being all 1 and 0; combining them to be
+         * simultaneous to improve cache made little difference" */
+        imdct_step3_inner_s_loop_ld654(n, A, buffer, n/2);
+
+    }  // if (log2_n >= IMDCT_BLOCK_MIN_BITS)
 
     /* Steps 4, 5, and 6. */
     imdct_step456(n, handle->bit_reverse[blocktype], buffer, buf2);
@@ -2641,6 +3014,46 @@ static bool vorbis_decode_packet_rest(
     float ** const channel_buffers =
         handle->channel_buffers[handle->cur_channel_buffer];
 
+    /**** Selection of channels to reconstruct. ****/
+
+    /* Channels excluded by the caller's channel mask need no floor curve
+     * synthesis or IMDCT.  Their residue data may still be needed for
+     * inverse coupling, since both channels of a coupling pair are needed
+     * if either one is (and coupling steps may chain), so we track that
+     * set separately. */
+    bool skip_channel[256], skip_residue[256];
+    int last_submap = map->submaps - 1;
+    if (UNLIKELY(handle->channel_mask != ~UINT64_C(0))) {
+        for (int ch = 0; ch < handle->channels; ch++) {
+            skip_channel[ch] =
+                (ch < 64 && !(handle->channel_mask & (UINT64_C(1) << ch)));
+            skip_residue[ch] = skip_channel[ch];
+        }
+        bool changed;
+        do {
+            changed = false;
+            for (int i = 0; i < map->coupling_steps; i++) {
+                const int magnitude = map->coupling[i].magnitude;
+                const int angle = map->coupling[i].angle;
+                if (skip_residue[magnitude] != skip_residue[angle]) {
+                    skip_residue[magnitude] = skip_residue[angle] = false;
+                    changed = true;
+                }
+            }
+        } while (changed);
+        /* Residue data is read in submap order, so no submaps after the
+         * last one containing a needed channel have to be read at all. */
+        last_submap = -1;
+        for (int ch = 0; ch < handle->channels; ch++) {
+            if (!skip_residue[ch]) {
+                last_submap = max(last_submap, map->mux[ch]);
+            }
+        }
+    } else {
+        memset(skip_channel, 0, sizeof(*skip_channel) * handle->channels);
+        memset(skip_residue, 0, sizeof(*skip_residue) * handle->channels);
+    }
+
     /**** Floor processing (4.3.2). ****/
 
     int64_t floor0_amplitude[256];
@@ -2677,7 +3090,7 @@ static bool vorbis_decode_packet_rest(
     }
 
     /**** Residue decoding (4.3.4). ****/
-    for (int i = 0; i < map->submaps; i++) {
+    for (int i = 0; i <= last_submap; i++) {
         float *residue_buffers[256];
         int ch = 0;
         for (int j = 0; j < handle->channels; j++) {
@@ -2696,6 +3109,9 @@ static bool vorbis_decode_packet_rest(
 
     /**** Inverse coupling (4.3.5). ****/
     for (int i = map->coupling_steps-1; i >= 0; i--) {
+        if (skip_residue[map->coupling[i].magnitude]) {
+            continue;
+        }
         float *magnitude = channel_buffers[map->coupling[i].magnitude];
         float *angle = channel_buffers[map->coupling[i].angle];
         for (int j = 0; j < n/2; j++) {
@@ -2728,7 +3144,9 @@ static bool vorbis_decode_packet_rest(
      **** uses the term "dot product", but the actual operation is     ****
      **** component-by-component vector multiplication.                ****/
     for (int i = 0; i < handle->channels; i++) {
-        if (really_zero_channel[i]) {
+        if (skip_channel[i]) {
+            /* Nothing to do here; the channel is cleared below. */
+        } else if (really_zero_channel[i]) {
             memset(channel_buffers[i], 0, sizeof(*channel_buffers[i]) * (n/2));
         } else {
             const int floor_index = map->submap_floor[map->mux[i]];
@@ -2744,7 +3162,11 @@ static bool vorbis_decode_packet_rest(
 
     /**** Inverse MDCT (4.3.7). ****/
     for (int i = 0; i < handle->channels; i++) {
-        inverse_mdct(handle, channel_buffers[i], mode->blockflag);
+        if (skip_channel[i]) {
+            memset(channel_buffers[i], 0, sizeof(*channel_buffers[i]) * n);
+        } else {
+            inverse_mdct(handle, channel_buffers[i], mode->blockflag);
+        }
     }
 
     /**** Frame length, sample position, and other miscellany. ****/
@@ -2764,6 +3186,12 @@ static bool vorbis_decode_packet_rest(
         handle->current_loc = -(n/2 - left_start);
         handle->current_loc_valid = true;
         handle->first_decode = false;
+    } else if (handle->restart_decode) {
+        /* Similarly, the left half of the window is omitted for the first
+         * frame after an approximate seek. */
+        handle->current_loc = handle->restart_loc - (n/2 - left_start);
+        handle->current_loc_valid = true;
+        handle->restart_decode = false;
     }
 
     /* If this is the last complete frame in a non-final Ogg page, update
@@ -2849,7 +3277,9 @@ bool vorbis_decode_initial(stb_vorbis *handle, int *left_start_ret,
 {
     /* Start reading the next packet, and verify that it's an audio packet. */
     if (!handle->packet_mode) {
-        if (UNLIKELY(handle->eof)) {
+        /* A pending chained stream link looks like end of stream until
+         * the caller switches to it. */
+        if (UNLIKELY(handle->eof) || UNLIKELY(handle->link_pending)) {
             return false;
         }
         if (UNLIKELY(!start_packet(handle))) {
@@ -2922,7 +3352,7 @@ bool vorbis_decode_initial(stb_vorbis *handle, int *left_start_ret,
 
 bool vorbis_decode_packet(stb_vorbis *handle, int *len_ret)
 {
-    const bool first_decode = handle->first_decode;
+    const bool first_decode = handle->first_decode || handle->restart_decode;
 
     int mode, left_start, left_end, right_start, right_end, len;
     if (!vorbis_decode_initial(handle, &left_start, &left_end,
@@ -2970,9 +3400,10 @@ bool vorbis_decode_packet(stb_vorbis *handle, int *len_ret)
         handle->previous_window[i] = channel_buffers[i] + right_start;
     }
 
-    /* If this is the first frame, push left_start (the beginning of data
-     * to return) to the center of the window, since the left half of the
-     * window contains garbage. */
+    /* If this is the first frame (or the first frame after an approximate
+     * seek), push left_start (the beginning of data to return) to the
+     * center of the window, since the left half of the window contains
+     * garbage. */
     if (first_decode) {
         const int n = handle->blocksize[handle->mode_config[mode].blockflag];
         left_start = n/2;
@@ -13,6 +13,7 @@
 #include "src/decode/inlines.h"
 #include "src/decode/io.h"
 #include "src/decode/packet.h"
+#include "src/decode/skeleton.h"
 
 #include <string.h>
 
@@ -160,14 +161,48 @@ bool start_page(stb_vorbis *handle, bool check_page_number)
         return error(handle, VORBIS_unexpected_eof);
     }
 
-    /* Skip over pages belonging to other bitstreams. */
+    /* Skip over pages belonging to other bitstreams, except that we
+     * process Skeleton header pages in order to pick up any seek index. */
     if (handle->bitstream_id_set) {
         if (bitstream_id != handle->bitstream_id) {
+            /* If the current link of a chained stream has ended, the
+             * first page of a new Vorbis stream (identified by a single
+             * 30-byte identification header packet) starts the next link.
+             * Leave the page set up for start_decoder() and report end of
+             * stream for the current link. */
+            if (handle->chained_streams && handle->link_ended
+             && (handle->page_flag & PAGEFLAG_first_page)
+             && handle->segment_count == 1 && handle->segments[0] == 30) {
+                handle->bitstream_id = bitstream_id;
+                handle->page_number = page_number;
+                handle->end_seg_with_known_loc = -2;
+                handle->next_seg = 0;
+                handle->link_pending = true;
+                return error(handle, VORBIS_reached_eof);
+            }
             unsigned int page_size = 0;
             for (int i = 0; i < handle->segment_count; i++) {
                 page_size += handle->segments[i];
             }
-            skip(handle, page_size);
+            if (handle->skeleton_present && !handle->skeleton_done
+             && bitstream_id == handle->skeleton_id) {
+                if (!skeleton_read_page(handle, handle->page_flag)) {
+                    return error(handle, VORBIS_unexpected_eof);
+                }
+            } else {
+                skip(handle, page_size);
+            }
+            /* If the skipped page immediately preceded the first audio
+             * page, move the first page pointer past it. */
+            if (handle->first_decode && handle->stream_len >= 0) {
+                const int64_t page_end =
+                    (*handle->tell_callback)(handle->io_opaque);
+                const unsigned int page_len =
+                    27 + handle->segment_count + page_size;
+                if (page_end - page_len == handle->p_first.page_start) {
+                    handle->p_first.page_start = page_end;
+                }
+            }
             return start_page(handle, check_page_number);
         }
     } else {
@@ -175,6 +210,10 @@ bool start_page(stb_vorbis *handle, bool check_page_number)
         handle->bitstream_id_set = true;
     }
 
+    if (handle->page_flag & PAGEFLAG_last_page) {
+        handle->link_ended = true;
+    }
+
     /* If this page has a sample position, find the packet it belongs to,
      * which will be the complete packet in this page. */
     handle->end_seg_with_known_loc = -2;  // Assume no packet with sample pos.
@@ -183,7 +222,7 @@ bool start_page(stb_vorbis *handle, bool check_page_number)
             /* An Ogg segment with size < 255 indicates the end of a packet. */
             if (handle->segments[i] < 255) {
                 handle->end_seg_with_known_loc = i;
-                handle->known_loc_for_packet = sample_pos;
+                handle->known_loc_for_packet = sample_pos + handle->link_base;
                 break;
             }
         }
@@ -15,6 +15,7 @@
 #include "src/decode/inlines.h"
 #include "src/decode/io.h"
 #include "src/decode/packet.h"
+#include "src/decode/skeleton.h"
 #include "src/util/memory.h"
 
 #include <math.h>
@@ -38,7 +39,11 @@
 static void set_file_offset(stb_vorbis *handle, int64_t offset)
 {
     handle->eof = false;
-    (*handle->seek_callback)(handle->io_opaque, offset);
+    if (handle->probe_mode) {
+        handle->probe_pos = offset;
+    } else {
+        (*handle->seek_callback)(handle->io_opaque, offset);
+    }
 }
 
 /*-----------------------------------------------------------------------*/
@@ -54,11 +59,138 @@ static void set_file_offset(stb_vorbis *handle, int64_t offset)
  */
 static int64_t get_file_offset(stb_vorbis *handle)
 {
+    if (handle->probe_mode) {
+        return handle->probe_pos;
+    }
     return (*handle->tell_callback)(handle->io_opaque);
 }
 
 /*-----------------------------------------------------------------------*/
 
+/**
+ * begin_probe:  Start reading stream data through the probe buffer, if
+ * one has been enabled.  Until end_probe() is called, only
+ * set_file_offset(), get_file_offset(), probe_get8(), probe_getn(), and
+ * probe_skip() may be used to access the stream.
+ *
+ * [Parameters]
+ *     handle: Stream handle.
+ */
+static void begin_probe(stb_vorbis *handle)
+{
+    if (handle->probe_buf) {
+        handle->probe_pos = get_file_offset(handle);
+        handle->probe_mode = true;
+    }
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * end_probe:  Stop reading stream data through the probe buffer, and set
+ * the stream read position to the logical position reached while probing.
+ *
+ * [Parameters]
+ *     handle: Stream handle.
+ */
+static void end_probe(stb_vorbis *handle)
+{
+    if (handle->probe_mode) {
+        handle->probe_mode = false;
+        (*handle->seek_callback)(handle->io_opaque, handle->probe_pos);
+    }
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * probe_getn:  Read data from the stream as for getn(), using the probe
+ * buffer if in probe mode.  When the requested data is not in the buffer,
+ * the buffer is refilled with a single read starting at the current
+ * position.
+ *
+ * [Parameters]
+ *     handle: Stream handle.
+ *     buffer: Buffer into which to read data.
+ *     count: Number of bytes to read.
+ * [Return value]
+ *     True on success, false on EOF.
+ */
+static bool probe_getn(stb_vorbis *handle, uint8_t *buffer, int count)
+{
+    if (!handle->probe_mode) {
+        return getn(handle, buffer, count);
+    }
+
+    while (count > 0) {
+        const int64_t offset = handle->probe_pos - handle->probe_buf_start;
+        if (offset < 0 || offset >= handle->probe_buf_len) {
+            (*handle->seek_callback)(handle->io_opaque, handle->probe_pos);
+            const int32_t len = (*handle->read_callback)(
+                handle->io_opaque, handle->probe_buf, handle->probe_buf_size);
+            handle->probe_buf_start = handle->probe_pos;
+            handle->probe_buf_len = max(len, 0);
+            if (handle->probe_buf_len == 0) {
+                handle->eof = true;
+                return false;
+            }
+            continue;
+        }
+        const int copy = (int)min(count, handle->probe_buf_len - offset);
+        memcpy(buffer, handle->probe_buf + offset, copy);
+        buffer += copy;
+        count -= copy;
+        handle->probe_pos += copy;
+    }
+    return true;
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * probe_get8:  Read a byte from the stream as for get8(), using the probe
+ * buffer if in probe mode.
+ *
+ * [Parameters]
+ *     handle: Stream handle.
+ * [Return value]
+ *     Byte read, or 0 on EOF.
+ */
+static uint8_t probe_get8(stb_vorbis *handle)
+{
+    uint8_t byte;
+    if (!probe_getn(handle, &byte, 1)) {
+        return 0;
+    }
+    return byte;
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * probe_skip:  Skip over data in the stream as for skip(), without
+ * reading from the stream if in probe mode.
+ *
+ * [Parameters]
+ *     handle: Stream handle.
+ *     count: Number of bytes to skip.
+ */
+static void probe_skip(stb_vorbis *handle, int count)
+{
+    if (!handle->probe_mode) {
+        skip(handle, count);
+        return;
+    }
+
+    if (count > handle->stream_len - handle->probe_pos) {
+        count = (int)(handle->stream_len - handle->probe_pos);
+        handle->eof = true;
+    }
+    handle->probe_pos += count;
+}
+
+/*-----------------------------------------------------------------------*/
+
 /**
  * find_page:  Locate the first page starting at or after the current read
  * position in the stream.  On success, the stream read position is set to
@@ -80,7 +212,7 @@ static bool find_page(stb_vorbis *handle, int64_t *end_ret, bool *last_ret)
     while (!handle->eof) {
 
         /* See if we have the first byte of an Ogg page. */
-        const uint8_t byte = get8(handle);
+        const uint8_t byte = probe_get8(handle);
         if (byte != 'O') {
             continue;
         }
@@ -89,7 +221,7 @@ static bool find_page(stb_vorbis *handle, int64_t *end_ret, bool *last_ret)
         const int64_t page_start = get_file_offset(handle) - 1;
         uint8_t header[27];
         header[0] = byte;
-        if (!getn(handle, &header[1], sizeof(header)-1)) {
+        if (!probe_getn(handle, &header[1], sizeof(header)-1)) {
             break;
         }
 
@@ -109,7 +241,7 @@ static bool find_page(stb_vorbis *handle, int64_t *end_ret, bool *last_ret)
                 crc = crc32_update(crc, header[i]);
             }
             unsigned int len = 0;
-            if (!getn(handle, readbuf, header[26])) {
+            if (!probe_getn(handle, readbuf, header[26])) {
                 break;
             }
             for (int i = 0; i < header[26]; i++) {
@@ -119,7 +251,7 @@ static bool find_page(stb_vorbis *handle, int64_t *end_ret, bool *last_ret)
             }
             while (len > 0) {
                 const unsigned int readcount = min(len, sizeof(readbuf));
-                if (!getn(handle, readbuf, readcount)) {
+                if (!probe_getn(handle, readbuf, readcount)) {
                     ASSERT(handle->eof);
                     break;
                 }
@@ -226,11 +358,11 @@ static int analyze_page(stb_vorbis *handle, ProbedPage *page_ret)
 
     /* Parse the header to determine the page length. */
     uint8_t header[27], lacing[255];
-    if (!getn(handle, header, 27)) {
+    if (!probe_getn(handle, header, 27)) {
         goto bail;
     }
     const int num_segments = header[26];
-    if (!getn(handle, lacing, num_segments)) {
+    if (!probe_getn(handle, lacing, num_segments)) {
         goto bail;
     }
     unsigned int payload_len = 0;
@@ -283,19 +415,19 @@ static int analyze_page(stb_vorbis *handle, ProbedPage *page_ret)
             if (UNLIKELY(lacing[i] == 0)) {
                 continue;
             }
-            const uint8_t packet_header = get8(handle);
+            const uint8_t packet_header = probe_get8(handle);
             const int mode = (packet_header >> 1) & ((1 << mode_bits) - 1);
             if (UNLIKELY(packet_header & 0x01)  // Not an audio packet.
              || UNLIKELY(mode >= handle->mode_count)) {
-                skip(handle, lacing[i] - 1);
+                probe_skip(handle, lacing[i] - 1);
             } else {
                 last_packet_was_audio = true;
                 frame_long[num_frames] = handle->mode_config[mode].blockflag;
-                skip(handle, lacing[i] - 1);
+                probe_skip(handle, lacing[i] - 1);
                 num_frames++;
             }
         } else {
-            skip(handle, lacing[i]);
+            probe_skip(handle, lacing[i]);
         }
         packet_start = (lacing[i] < 255);
     }
@@ -501,11 +633,430 @@ static int seek_frame_from_page(stb_vorbis *handle, int64_t page_start,
     return (int)(target_sample - frame_start);
 }
 
-/*************************************************************************/
-/************************** Interface routines ***************************/
-/*************************************************************************/
+/*-----------------------------------------------------------------------*/
 
-int stb_vorbis_seek(stb_vorbis *handle, uint64_t sample_number)
+/**
+ * scan_packet_window:  Read the header of the next packet in the current
+ * page and return the frame's window parameters, then skip to the end of
+ * the packet.  Helper function for stb_vorbis_build_frame_map().  Unlike
+ * scan_frame(), this function does not skip over non-audio or invalid
+ * packets, so that the caller can keep track of each packet's position.
+ *
+ * [Parameters]
+ *     handle: Stream handle.
+ *     blocksize_ret, left_start_ret, left_end_ret, right_start_ret:
+ *         Pointers to variables to receive the frame's block size and
+ *         window parameters.
+ * [Return value]
+ *     1 if the packet is a valid audio packet, 0 if the packet is not a
+ *     valid audio packet, -1 on end of stream or read error.
+ */
+static int scan_packet_window(stb_vorbis *handle, int *blocksize_ret,
+                              int *left_start_ret, int *left_end_ret,
+                              int *right_start_ret)
+{
+    if (UNLIKELY(!start_packet(handle))) {
+        return -1;
+    }
+
+    int result = 0;
+    if (get_bits(handle, 1) == 0 && handle->valid_bits >= 0) {
+        const uint32_t mode_index = get_bits(handle, handle->mode_bits);
+        if (mode_index < (uint32_t)handle->mode_count) {
+            const Mode *mode = &handle->mode_config[mode_index];
+            bool prev = false, next = false;
+            if (mode->blockflag) {
+                prev = get_bits(handle, 1);
+                next = get_bits(handle, 1);
+            }
+            if (handle->valid_bits >= 0) {
+                const int n = handle->blocksize[mode->blockflag];
+                if (mode->blockflag && !prev) {
+                    *left_start_ret = (n - handle->blocksize[0]) / 4;
+                    *left_end_ret   = (n + handle->blocksize[0]) / 4;
+                } else {
+                    *left_start_ret = 0;
+                    *left_end_ret   = n/2;
+                }
+                if (mode->blockflag && !next) {
+                    *right_start_ret = (n*3 - handle->blocksize[0]) / 4;
+                } else {
+                    *right_start_ret = n/2;
+                }
+                *blocksize_ret = n;
+                result = 1;
+            }
+        }
+    }
+
+    if (UNLIKELY(!flush_packet(handle))) {
+        return -1;
+    }
+    return result;
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * find_map_frame:  Find the frame map entry for the frame which should be
+ * used to seek to the given sample.
+ *
+ * [Parameters]
+ *     handle: Stream handle.
+ *     target_sample: Sample to seek to.
+ * [Return value]
+ *     Index of the frame map entry, or -1 if the frame map cannot be used
+ *     to seek to the given sample.
+ */
+static int find_map_frame(const stb_vorbis *handle, uint64_t target_sample)
+{
+    const FrameMapEntry *map = handle->frame_map;
+    if (map[0].frame_start > target_sample) {
+        return -1;
+    }
+    int low = 0, high = handle->frame_map_size - 1;
+    while (low < high) {
+        const int mid = (low + high + 1) / 2;
+        if (map[mid].frame_start <= target_sample) {
+            low = mid;
+        } else {
+            high = mid - 1;
+        }
+    }
+
+    /* The target must lie within the frame, and if it's in the overlap
+     * region, we need the immediately preceding frame as well. */
+    const FrameMapEntry *frame = &map[low];
+    if (target_sample >= frame->frame_start + frame->length) {
+        return -1;
+    }
+    if (target_sample < frame->frame_start + frame->overlap_len) {
+        if (low == 0
+         || map[low-1].frame_start + map[low-1].length != frame->frame_start) {
+            return -1;
+        }
+    }
+    return low;
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * seek_frame_from_map:  Seek to the given target sample using the frame
+ * map.  Equivalent to seek_frame_from_page(), except that no scanning is
+ * required to find the proper frame.
+ *
+ * [Parameters]
+ *     handle: Stream handle.
+ *     index: Index of frame map entry containing the target sample, as
+ *         returned from find_map_frame().
+ *     target_sample: Sample to seek to.
+ * [Return value]
+ *     Number of samples that must be discarded from the beginning of the
+ *     frame to reach the target sample.
+ */
+static int seek_frame_from_map(stb_vorbis *handle, int index,
+                               uint64_t target_sample)
+{
+    const FrameMapEntry *frame = &handle->frame_map[index];
+    const bool decode_one_frame =
+        (target_sample < frame->frame_start + frame->overlap_len);
+    const FrameMapEntry *start = decode_one_frame ? frame-1 : frame;
+
+    /* Position the stream at the beginning of the starting packet. */
+    set_file_offset(handle, start->page_start);
+    if (UNLIKELY(!start_page(handle, false))
+     || UNLIKELY(start->segment >= handle->segment_count)) {
+        return error(handle, VORBIS_seek_failed);
+    }
+    unsigned int skip_len = 0;
+    for (int i = 0; i < start->segment; i++) {
+        skip_len += handle->segments[i];
+    }
+    skip(handle, skip_len);
+    handle->next_seg = start->segment;
+
+    handle->previous_length = 0;
+    handle->first_decode = (start == &handle->frame_map[0]);
+    if (decode_one_frame) {
+        if (UNLIKELY(!vorbis_decode_packet(handle, NULL))) {
+            return error(handle, VORBIS_seek_failed);
+        }
+    }
+    handle->current_loc = frame->frame_start;
+    handle->current_loc_valid = true;
+    handle->error = VORBIS__no_error;
+    return (int)(target_sample - frame->frame_start);
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * probe_page:  Find and analyze the first page starting at or after the
+ * given offset which has a known sample position, reading through the
+ * probe buffer if one has been enabled.  On return, the stream read
+ * position is set to the start of the page.
+ *
+ * [Parameters]
+ *     handle: Stream handle.
+ *     offset: File offset at which to start searching.
+ *     page_ret: Pointer to variable to receive the page data on success.
+ * [Return value]
+ *     True on success, false on error.
+ */
+static bool probe_page(stb_vorbis *handle, int64_t offset,
+                       ProbedPage *page_ret)
+{
+    bool success = false;
+    begin_probe(handle);
+    set_file_offset(handle, offset);
+    do {
+        if (!find_page(handle, NULL, NULL)
+         || !analyze_page(handle, page_ret)) {
+            goto out;
+        }
+        if (page_ret->first_decoded_sample == (uint64_t)-1) {
+            set_file_offset(handle, page_ret->page_end);
+        }
+    } while (page_ret->first_decoded_sample == (uint64_t)-1);
+    success = true;
+  out:
+    end_probe(handle);
+    return success;
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * cache_probed_page:  Record a page found during a seek search in the
+ * probe cache.  If the cache is full, the entry farthest from the new
+ * page is discarded, on the assumption that subsequent seeks are likely
+ * to be near recent ones.
+ *
+ * [Parameters]
+ *     handle: Stream handle.
+ *     page: Page to record.  Must have a known sample position.
+ */
+static void cache_probed_page(stb_vorbis *handle, const ProbedPage *page)
+{
+    ProbedPage *cache = handle->probe_cache;
+    int len = handle->probe_cache_len;
+
+    int pos = 0;
+    while (pos < len && cache[pos].page_start < page->page_start) {
+        pos++;
+    }
+    if (pos < len && cache[pos].page_start == page->page_start) {
+        /* Keep whichever after_previous_page_start is closer to the page,
+         * since that gives a tighter search bound. */
+        if (page->after_previous_page_start
+            > cache[pos].after_previous_page_start) {
+            cache[pos].after_previous_page_start =
+                page->after_previous_page_start;
+        }
+        return;
+    }
+
+    if (len == PROBE_CACHE_SIZE) {
+        /* The farthest entry is always at one end of the array. */
+        const int64_t first_distance =
+            page->page_start - cache[0].page_start;
+        const int64_t last_distance =
+            cache[len-1].page_start - page->page_start;
+        if (first_distance >= last_distance) {
+            memmove(&cache[0], &cache[1], sizeof(*cache) * (len-1));
+            if (pos > 0) {
+                pos--;
+            }
+        }
+        len--;
+    }
+    memmove(&cache[pos+1], &cache[pos], sizeof(*cache) * (len-pos));
+    cache[pos] = *page;
+    handle->probe_cache_len = len+1;
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * find_keypoint_page:  Use the stream's Ogg Skeleton index to find a page
+ * which can serve as a seek anchor for the given target sample.  Since
+ * keypoint sample offsets are converted from timestamps and may not be
+ * exact, the keypoint page is checked, and if it starts after the target
+ * sample, the preceding keypoints are tried in turn.
+ *
+ * [Parameters]
+ *     handle: Stream handle.
+ *     target_sample: Sample to seek to.
+ *     page_ret: Pointer to variable to receive the page data on success.
+ * [Return value]
+ *     True if a suitable page was found, false if not.
+ */
+static bool find_keypoint_page(stb_vorbis *handle, uint64_t target_sample,
+                               ProbedPage *page_ret)
+{
+    int index = skeleton_find_keypoint(handle, target_sample);
+    for (int tries = 0; index >= 0 && tries < 4; index--, tries++) {
+        const int64_t page_start = handle->skeleton_index[index].page_start;
+        if (page_start <= handle->p_first.page_start) {
+            *page_ret = handle->p_first;
+            return true;
+        }
+        begin_probe(handle);
+        set_file_offset(handle, page_start);
+        if (!find_page(handle, NULL, NULL)) {
+            end_probe(handle);
+            continue;
+        }
+        const bool ok = analyze_page(handle, page_ret);
+        end_probe(handle);
+        if (UNLIKELY(!ok)) {
+            return false;
+        }
+        if (page_ret->first_decoded_sample != (uint64_t)-1
+         && page_ret->first_decoded_sample <= target_sample) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * seek_index_valid:  Check whether the given seek index is consistent
+ * with the stream.
+ *
+ * [Parameters]
+ *     handle: Stream handle.
+ *     points: Array of seek points.
+ *     count: Number of seek points.
+ * [Return value]
+ *     True if the index is usable, false if not.
+ */
+static bool seek_index_valid(const stb_vorbis *handle,
+                             const stb_vorbis_seek_point *points, int count)
+{
+    if (count <= 0
+     || points[0].page_start != handle->p_first.page_start
+     || points[0].first_sample != 0) {
+        return false;
+    }
+    for (int i = 0; i < count; i++) {
+        if (points[i].page_end <= points[i].page_start
+         || points[i].page_end > handle->stream_len
+         || points[i].last_sample < points[i].first_sample
+         || points[i].last_sample == (uint64_t)-1) {
+            return false;
+        }
+        if (i > 0 && (points[i].page_start < points[i-1].page_end
+                      || points[i].first_sample < points[i-1].first_sample)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * use_seek_index:  Install the given seek index in the stream handle,
+ * replacing any existing index, and set the stream length and last page
+ * data from the index.  The index must have been validated with
+ * seek_index_valid().
+ *
+ * [Parameters]
+ *     handle: Stream handle.
+ *     points: Array of seek points, allocated with mem_alloc().  The
+ *         handle takes ownership of the array.
+ *     count: Number of seek points.
+ */
+static void use_seek_index(stb_vorbis *handle, stb_vorbis_seek_point *points,
+                           int count)
+{
+    mem_free(handle->mem_opaque, handle->seek_index);
+    handle->seek_index = points;
+    handle->seek_index_size = count;
+
+    const stb_vorbis_seek_point *last = &points[count-1];
+    handle->total_samples = last->last_sample;
+    handle->p_last.page_start = last->page_start;
+    handle->p_last.page_end = last->page_end;
+    handle->p_last.after_previous_page_start =
+        (count > 1 ? points[count-2].page_start + 1 : last->page_start);
+    handle->p_last.first_decoded_sample = handle->total_samples;
+    handle->p_last.last_decoded_sample = handle->total_samples;
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * seek_page:  Seek to the given sample, using the given page as an anchor.
+ * Helper function for seek_to_sample().
+ *
+ * If approximate is true, the sample itself is not located; instead,
+ * decoding restarts at the first complete frame on the page, using the
+ * right half of that frame's window as for the first frame in the stream,
+ * so no frames need to be scanned or decoded in advance.
+ *
+ * [Parameters]
+ *     handle: Stream handle.
+ *     page_start: File offset of the beginning of the page.
+ *     first_sample: Sample offset of the middle of the first complete
+ *         frame on the page.
+ *     target_sample: Sample to seek to.  Must be no less than first_sample.
+ *     approximate: True to seek to the page rather than the sample.
+ * [Return value]
+ *     Number of samples that must be discarded from the beginning of the
+ *     frame to reach the target sample (always 0 if approximate is true).
+ */
+static int seek_page(stb_vorbis *handle, int64_t page_start,
+                     uint64_t first_sample, uint64_t target_sample,
+                     bool approximate)
+{
+    /* The first page has to be handled normally, since the first frame
+     * of the stream is already decoded without its left half. */
+    if (!approximate || first_sample == 0) {
+        return seek_frame_from_page(handle, page_start, first_sample,
+                                    target_sample);
+    }
+
+    set_file_offset(handle, page_start);
+    if (UNLIKELY(!start_page(handle, false))) {
+        return error(handle, VORBIS_seek_failed);
+    }
+    if (handle->page_flag & PAGEFLAG_continued_packet) {
+        ASSERT(start_packet(handle));
+        if (UNLIKELY(!flush_packet(handle))) {
+            return error(handle, VORBIS_seek_failed);
+        }
+    }
+    handle->previous_length = 0;
+    handle->restart_decode = true;
+    handle->restart_loc = first_sample;
+    handle->current_loc = first_sample;
+    handle->current_loc_valid = true;
+    handle->error = VORBIS__no_error;
+    return 0;
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * seek_to_sample:  Seek to the given sample in the stream.  Implements
+ * stb_vorbis_seek() and stb_vorbis_seek_approximate().
+ *
+ * [Parameters]
+ *     handle: Stream handle.
+ *     sample_number: Sample to seek to.
+ *     approximate: True to stop at the beginning of the page containing
+ *         the sample rather than at the sample itself.
+ * [Return value]
+ *     Offset of the requested sample in the next frame returned by
+ *     stb_vorbis_get_frame_float(), or 0 on error.
+ */
+static int seek_to_sample(stb_vorbis *handle, uint64_t sample_number,
+                          bool approximate)
 {
     /* Fail early for unseekable streams. */
     if (handle->stream_len < 0) {
@@ -528,6 +1079,8 @@ int stb_vorbis_seek(stb_vorbis *handle, uint64_t sample_number)
         }
     }
 
+    handle->restart_decode = false;
+
     /* If we're seeking to/past the end of the stream, just do that. */
     if (sample_number >= handle->total_samples) {
         set_file_offset(handle, handle->stream_len);
@@ -537,11 +1090,48 @@ int stb_vorbis_seek(stb_vorbis *handle, uint64_t sample_number)
         return 0;
     }
 
+    /* If we have a frame map, we can go directly to the proper frame. */
+    if (handle->frame_map) {
+        const int index = find_map_frame(handle, sample_number);
+        if (index >= 0) {
+            return seek_frame_from_map(handle, index, sample_number);
+        }
+    }
+
     /* If the sample is known to be on the first page, we don't need to
      * search for the correct page. */
     if (sample_number < handle->p_first.last_decoded_sample) {
-        return seek_frame_from_page(handle, handle->p_first.page_start,
-                                    0, sample_number);
+        return seek_page(handle, handle->p_first.page_start, 0,
+                         sample_number, approximate);
+    }
+
+    /* If we have a seek index, we can look up the page directly.  The
+     * first entry's first_sample is always zero, so the search always
+     * finds an anchor page. */
+    if (handle->seek_index) {
+        const stb_vorbis_seek_point *index = handle->seek_index;
+        int low = 0, high = handle->seek_index_size - 1;
+        while (low < high) {
+            const int mid = (low + high + 1) / 2;
+            if (index[mid].first_sample <= sample_number) {
+                low = mid;
+            } else {
+                high = mid - 1;
+            }
+        }
+        return seek_page(handle, index[low].page_start,
+                         index[low].first_sample, sample_number, approximate);
+    }
+
+    /* If the stream has an Ogg Skeleton index, we can usually find a
+     * suitable page with a single probe. */
+    if (handle->skeleton_index) {
+        ProbedPage page;
+        if (find_keypoint_page(handle, sample_number, &page)) {
+            return seek_page(handle, page.page_start,
+                             page.first_decoded_sample, sample_number,
+                             approximate);
+        }
     }
 
     /* Otherwise, perform an interpolated binary search (biased toward
@@ -549,6 +1139,24 @@ int stb_vorbis_seek(stb_vorbis *handle, uint64_t sample_number)
      * the target sample. */
     ProbedPage low = handle->p_first;
     ProbedPage high = handle->p_last;
+    /* Start by narrowing the search range using pages found in previous
+     * searches.  If one of those pages contains the target, we can skip
+     * the search entirely. */
+    for (int i = 0; i < handle->probe_cache_len; i++) {
+        const ProbedPage *page = &handle->probe_cache[i];
+        if (sample_number >= page->first_decoded_sample) {
+            if (sample_number < page->last_decoded_sample) {
+                return seek_page(handle, page->page_start,
+                                 page->first_decoded_sample, sample_number,
+                                 approximate);
+            } else if (page->page_start > low.page_start) {
+                low = *page;
+            }
+        } else if (page->page_start < high.page_start) {
+            high = *page;
+            break;  // All subsequent pages are farther away.
+        }
+    }
     /* Conceptually, we iterate until low.page_end and high.page_start
      * are equal, indicating that they represent two consecutive pages.
      * However, if there's junk data between the two pages, the two
@@ -586,29 +1194,21 @@ int stb_vorbis_seek(stb_vorbis *handle, uint64_t sample_number)
         /* Look for the next page starting after the probe point.  If it's
          * a page without a known sample position, continue scanning forward
          * and use the sample position from the next page that has one. */
-        set_file_offset(handle, probe);
         ProbedPage page;
-        /* These calls can only fail on a read error. */
-        if (UNLIKELY(!find_page(handle, NULL, NULL))
-         || UNLIKELY(!analyze_page(handle, &page))) {
+        /* This can only fail on a read error. */
+        if (UNLIKELY(!probe_page(handle, probe, &page))) {
             return error(handle, VORBIS_seek_failed);
         }
-        while (page.first_decoded_sample == (uint64_t)-1) {
-            set_file_offset(handle, page.page_end);
-            if (UNLIKELY(!find_page(handle, NULL, NULL))
-             || UNLIKELY(!analyze_page(handle, &page))) {
-                return error(handle, VORBIS_seek_failed);
-            }
-        }
         page.after_previous_page_start = probe;
+        cache_probed_page(handle, &page);
 
         /* Choose one or the other side of the range and iterate (unless
          * we happened to find the right page, in which case we just stop). */
         if (sample_number >= page.first_decoded_sample) {
             if (sample_number < page.last_decoded_sample) {
-                return seek_frame_from_page(handle, page.page_start,
-                                            page.first_decoded_sample,
-                                            sample_number);
+                return seek_page(handle, page.page_start,
+                                 page.first_decoded_sample, sample_number,
+                                 approximate);
             } else {
                 low = page;
             }
@@ -617,8 +1217,24 @@ int stb_vorbis_seek(stb_vorbis *handle, uint64_t sample_number)
         }
     }
 
-    return seek_frame_from_page(handle, low.page_start,
-                                low.first_decoded_sample, sample_number);
+    return seek_page(handle, low.page_start, low.first_decoded_sample,
+                     sample_number, approximate);
+}
+
+/*************************************************************************/
+/************************** Interface routines ***************************/
+/*************************************************************************/
+
+int stb_vorbis_seek(stb_vorbis *handle, uint64_t sample_number)
+{
+    return seek_to_sample(handle, sample_number, false);
+}
+
+/*-----------------------------------------------------------------------*/
+
+int stb_vorbis_seek_approximate(stb_vorbis *handle, uint64_t sample_number)
+{
+    return seek_to_sample(handle, sample_number, true);
 }
 
 /*-----------------------------------------------------------------------*/
@@ -777,5 +1393,341 @@ uint64_t stb_vorbis_stream_length_in_samples(stb_vorbis *handle)
     }
 }
 
+/*-----------------------------------------------------------------------*/
+
+bool stb_vorbis_build_seek_index(stb_vorbis *handle)
+{
+    if (handle->stream_len < 0) {
+        return error(handle, VORBIS_cant_find_last_page);
+    }
+
+    int capacity = 256;
+    stb_vorbis_seek_point *index =
+        mem_alloc(handle->mem_opaque, sizeof(*index) * capacity, 0);
+    if (!index) {
+        return error(handle, VORBIS_outofmem);
+    }
+    int count = 0;
+
+    const int64_t restore_offset = get_file_offset(handle);
+    int64_t offset = handle->p_first.page_start;
+    bool last = false;
+    bool read_error = false;
+    while (!last) {
+        set_file_offset(handle, offset);
+        ProbedPage page;
+        if (!find_page(handle, NULL, &last)) {
+            break;  // Probably a truncated stream; use what we have.
+        }
+        if (UNLIKELY(!analyze_page(handle, &page))) {
+            read_error = true;
+            break;
+        }
+        offset = page.page_end;
+
+        /* The first page is the seek anchor for the beginning of the
+         * stream, as for p_first.  Other pages are only usable as
+         * anchors if they have a known sample position and do not go
+         * backward (which can only happen in a corrupt stream). */
+        if (count == 0) {
+            page.first_decoded_sample = 0;
+            if (page.last_decoded_sample == (uint64_t)-1) {
+                read_error = true;
+                break;
+            }
+        } else if (page.first_decoded_sample == (uint64_t)-1
+                || page.first_decoded_sample < index[count-1].first_sample
+                || page.last_decoded_sample < page.first_decoded_sample) {
+            continue;
+        }
+
+        if (count >= capacity) {
+            stb_vorbis_seek_point *new_index = mem_alloc(
+                handle->mem_opaque, sizeof(*index) * (capacity * 2), 0);
+            if (!new_index) {
+                mem_free(handle->mem_opaque, index);
+                set_file_offset(handle, restore_offset);
+                return error(handle, VORBIS_outofmem);
+            }
+            memcpy(new_index, index, sizeof(*index) * capacity);
+            mem_free(handle->mem_opaque, index);
+            index = new_index;
+            capacity *= 2;
+        }
+        index[count].page_start = page.page_start;
+        index[count].page_end = page.page_end;
+        index[count].first_sample = page.first_decoded_sample;
+        index[count].last_sample = page.last_decoded_sample;
+        count++;
+    }
+    set_file_offset(handle, restore_offset);
+
+    if (read_error || !seek_index_valid(handle, index, count)) {
+        mem_free(handle->mem_opaque, index);
+        return error(handle, VORBIS_seek_failed);
+    }
+    use_seek_index(handle, index, count);
+    return true;
+}
+
+/*-----------------------------------------------------------------------*/
+
+bool stb_vorbis_build_frame_map(stb_vorbis *handle)
+{
+    if (handle->stream_len < 0) {
+        return error(handle, VORBIS_cant_find_last_page);
+    }
+
+    /* Make sure the first page has been analyzed (see stb_vorbis_seek()). */
+    if (handle->p_first.page_end == 0) {
+        if (UNLIKELY(!start_packet(handle))) {
+            return error(handle, VORBIS_seek_failed);
+        }
+        flush_packet(handle);
+        handle->first_decode = false;
+    }
+
+    int capacity = 1024;
+    FrameMapEntry *map =
+        mem_alloc(handle->mem_opaque, sizeof(*map) * capacity, 0);
+    if (!map) {
+        return error(handle, VORBIS_outofmem);
+    }
+    int count = 0;
+
+    /* Sample offset of the frame following the last one recorded, or -1
+     * if unknown. */
+    uint64_t next_frame_start = (uint64_t)-1;
+
+    int64_t offset = handle->p_first.page_start;
+    bool last = false;
+    bool read_error = false;
+    while (!last && !read_error) {
+        set_file_offset(handle, offset);
+        ProbedPage page;
+        if (!find_page(handle, NULL, &last)) {
+            break;  // Probably a truncated stream; use what we have.
+        }
+        if (UNLIKELY(!analyze_page(handle, &page))) {
+            read_error = true;
+            break;
+        }
+        offset = page.page_end;
+
+        /* As in seek_frame_from_page(), the first complete frame on the
+         * page is anchored to the page's sample position if one is
+         * available.  The last page's sample position does not give us
+         * the start of the page, so we continue from the previous page
+         * in that case. */
+        bool anchored;
+        uint64_t anchor_sample;
+        if (page.page_start == handle->p_first.page_start) {
+            anchored = true;
+            anchor_sample = 0;
+        } else if (!last && page.first_decoded_sample != (uint64_t)-1) {
+            anchored = true;
+            anchor_sample = page.first_decoded_sample;
+        } else if (next_frame_start != (uint64_t)-1) {
+            anchored = false;
+            anchor_sample = 0;  // Not used.
+        } else {
+            continue;
+        }
+
+        if (UNLIKELY(!start_page(handle, false))) {
+            read_error = true;
+            break;
+        }
+        const uint32_t page_number = handle->page_number;
+        if (handle->page_flag & PAGEFLAG_continued_packet) {
+            ASSERT(start_packet(handle));
+            if (UNLIKELY(!flush_packet(handle))) {
+                read_error = true;
+                break;
+            }
+        }
+
+        /* Record each packet which starts on this page. */
+        while (handle->next_seg != -1 && handle->page_number == page_number) {
+            const int segment = handle->next_seg;
+            unsigned int consumed = 27 + handle->segment_count;
+            for (int i = 0; i < segment; i++) {
+                consumed += handle->segments[i];
+            }
+            const int64_t page_start = get_file_offset(handle) - consumed;
+
+            int blocksize, left_start, left_end, right_start;
+            const int result = scan_packet_window(
+                handle, &blocksize, &left_start, &left_end, &right_start);
+            if (result < 0) {
+                last = true;  // End of stream (or truncated data).
+                break;
+            } else if (result == 0) {
+                continue;
+            }
+
+            uint64_t frame_start;
+            if (anchored) {
+                if (anchor_sample == 0) {
+                    left_start = left_end = blocksize / 2;
+                }
+                frame_start = anchor_sample - (blocksize/2 - left_start);
+                anchored = false;
+            } else {
+                frame_start = next_frame_start;
+            }
+            next_frame_start = frame_start + (right_start - left_start);
+
+            /* Skip frames which were already recorded (if we ended up on
+             * a different page than expected) or which would put the map
+             * out of order (only possible in a corrupt stream). */
+            if (count > 0
+             && (page_start < map[count-1].page_start
+                 || (page_start == map[count-1].page_start
+                     && segment <= map[count-1].segment)
+                 || frame_start < (map[count-1].frame_start
+                                   + map[count-1].length))) {
+                continue;
+            }
+
+            if (count >= capacity) {
+                FrameMapEntry *new_map = mem_alloc(
+                    handle->mem_opaque, sizeof(*map) * (capacity * 2), 0);
+                if (!new_map) {
+                    mem_free(handle->mem_opaque, map);
+                    return error(handle, VORBIS_outofmem);
+                }
+                memcpy(new_map, map, sizeof(*map) * capacity);
+                mem_free(handle->mem_opaque, map);
+                map = new_map;
+                capacity *= 2;
+            }
+            map[count].page_start = page_start;
+            map[count].frame_start = frame_start;
+            map[count].segment = (uint8_t)segment;
+            map[count].overlap_len = (uint16_t)(left_end - left_start);
+            map[count].length = (uint16_t)(right_start - left_start);
+            count++;
+        }
+    }
+
+    if (read_error || count == 0) {
+        mem_free(handle->mem_opaque, map);
+        return error(handle, VORBIS_seek_failed);
+    }
+    mem_free(handle->mem_opaque, handle->frame_map);
+    handle->frame_map = map;
+    handle->frame_map_size = count;
+    return true;
+}
+
+/*-----------------------------------------------------------------------*/
+
+void stb_vorbis_skip(stb_vorbis *handle, uint64_t target_sample)
+{
+    ASSERT(!handle->packet_mode);
+
+    /* We need a known position to count from, so the first frame of the
+     * stream (or of a new chained stream link, or after an approximate
+     * seek) must be decoded normally. */
+    if (handle->first_decode || handle->restart_decode
+     || !handle->current_loc_valid) {
+        return;
+    }
+
+    /* Each frame returns at most half a long block, and the first frame
+     * decoded after the skip (whose left half lacks the overlap data from
+     * the frame before it) returns no valid samples, so we stop scanning
+     * once we come within two long half-blocks of the target.  This
+     * leaves the caller to decode and discard at most a few frames. */
+    const uint64_t margin = handle->blocksize[1];
+    uint64_t loc = handle->current_loc;
+    bool skipped = false;
+    while (target_sample > loc && target_sample - loc >= margin) {
+        int left_start, left_end, right_start, mode_index;
+        if (!scan_frame(handle, &left_start, &left_end, &right_start,
+                        &mode_index)) {
+            break;
+        }
+        skipped = true;
+
+        /* Follow the same position tracking logic as in
+         * vorbis_decode_packet_rest(). */
+        const Mode *mode = &handle->mode_config[mode_index];
+        const int n = handle->blocksize[mode->blockflag];
+        if (handle->last_seg_index == handle->end_seg_with_known_loc
+         && !(handle->page_flag & PAGEFLAG_last_page)) {
+            loc = handle->known_loc_for_packet - (n/2 - left_start);
+        }
+        loc += right_start - left_start;
+
+        /* Don't try to skip through the final page, since we can't tell
+         * from the window parameters alone how the stream is truncated.
+         * The final page will normally hold only a few frames anyway. */
+        if (handle->page_flag & PAGEFLAG_last_page) {
+            const uint64_t end_loc = handle->known_loc_for_packet;
+            if (loc - end_loc < UINT64_C(1)<<63) {  // end_loc <= loc
+                loc = end_loc;
+            }
+            break;
+        }
+    }
+
+    handle->current_loc = loc;
+    if (skipped) {
+        /* Decode (and discard) one frame to set up the overlap data for
+         * the next frame.  End of stream is not an error here; the next
+         * decode call will simply return no data. */
+        handle->previous_length = 0;
+        (void) vorbis_decode_packet(handle, NULL);
+    }
+}
+
+/*-----------------------------------------------------------------------*/
+
+int stb_vorbis_get_seek_index(stb_vorbis *handle,
+                              const stb_vorbis_seek_point **points_ret)
+{
+    *points_ret = handle->seek_index;
+    return handle->seek_index_size;
+}
+
+/*-----------------------------------------------------------------------*/
+
+bool stb_vorbis_set_seek_index(stb_vorbis *handle,
+                               const stb_vorbis_seek_point *points,
+                               int count)
+{
+    if (handle->stream_len < 0 || !seek_index_valid(handle, points, count)) {
+        return false;
+    }
+    stb_vorbis_seek_point *index =
+        mem_alloc(handle->mem_opaque, sizeof(*index) * count, 0);
+    if (!index) {
+        return error(handle, VORBIS_outofmem);
+    }
+    memcpy(index, points, sizeof(*index) * count);
+    use_seek_index(handle, index, count);
+    return true;
+}
+
+/*-----------------------------------------------------------------------*/
+
+bool stb_vorbis_set_probe_window(stb_vorbis *handle, int32_t size)
+{
+    uint8_t *buf = NULL;
+    if (size > 0) {
+        buf = mem_alloc(handle->mem_opaque, size, 0);
+        if (!buf) {
+            return error(handle, VORBIS_outofmem);
+        }
+    }
+    mem_free(handle->mem_opaque, handle->probe_buf);
+    handle->probe_buf = buf;
+    handle->probe_buf_size = size;
+    handle->probe_buf_len = 0;
+    return true;
+}
+
 /*************************************************************************/
 /*************************************************************************/
@@ -15,6 +15,7 @@
 #include "src/decode/io.h"
 #include "src/decode/packet.h"
 #include "src/decode/setup.h"
+#include "src/decode/skeleton.h"
 #include "src/decode/tables.h"
 #include "src/util/memory.h"
 
@@ -350,6 +351,58 @@ static bool compute_codewords(Codebook *book, const int8_t *lengths,
 
 /*-----------------------------------------------------------------------*/
 
+/**
+ * choose_fast_huffman_length:  Choose the number of bits to use for the
+ * O(1) Huffman lookup table of a codebook, based on the distribution of
+ * codeword lengths in the codebook.
+ *
+ * The table is made just wide enough that codes not found in the table
+ * account for no more than 1/64 of the probability mass implied by the
+ * codeword lengths (a code of length L has probability 2^-L), but never
+ * wider than the longest code or narrower than needed to stay within
+ * max_entries table entries.
+ *
+ * [Parameters]
+ *     handle: Stream handle.
+ *     lengths: List of codeword lengths, indexed by symbol.
+ *     entries: Number of entries in lengths[].
+ *     max_entries: Maximum number of table entries to use.
+ * [Return value]
+ *     Number of bits to use for the lookup table.
+ */
+static int choose_fast_huffman_length(const stb_vorbis *handle,
+                                      const int8_t *lengths, int32_t entries,
+                                      uint64_t max_entries)
+{
+    int32_t histogram[33];
+    memset(histogram, 0, sizeof(histogram));
+    int max_len = 0;
+    for (int32_t i = 0; i < entries; i++) {
+        if (lengths[i] != NO_CODE) {
+            histogram[lengths[i]]++;
+            max_len = max(max_len, lengths[i]);
+        }
+    }
+
+    /* The configured length is the nominal table size, but allow a few
+     * more bits for codebooks which need them (if the budget permits). */
+    const int limit = (handle->fast_huffman_length == 0 ? 0
+                       : min(handle->fast_huffman_length + 4, 24));
+    const uint64_t target = (UINT64_C(1) << 32) - (UINT64_C(1) << 26);
+    uint64_t covered = 0;
+    int bits = 0;
+    while (bits < min(max_len, limit) && covered < target) {
+        bits++;
+        covered += (uint64_t)histogram[bits] << (32 - bits);
+    }
+    while (bits > 0 && (UINT64_C(1) << bits) > max_entries) {
+        bits--;
+    }
+    return bits;
+}
+
+/*-----------------------------------------------------------------------*/
+
 /**
  * compute_sorted_huffman:  Generate the sorted Huffman table used for
  * binary search of Huffman codes which are too long for the O(1) lookup
@@ -380,7 +433,7 @@ static void compute_sorted_huffman(const stb_vorbis *handle, Codebook *book,
     } else {
         int32_t count = 0;
         for (int32_t i = 0; i < book->entries; i++) {
-            if (lengths[i] > handle->fast_huffman_length
+            if (lengths[i] > book->fast_huffman_length
              && lengths[i] != NO_CODE) {
                 book->sorted_codewords[count++] =
                     bit_reverse(book->codewords[i]);
@@ -401,7 +454,7 @@ static void compute_sorted_huffman(const stb_vorbis *handle, Codebook *book,
     for (int32_t i = 0; i < entries; i++) {
         const int len = book->sparse ? lengths[values[i]] : lengths[i];
         if (book->sparse
-         || (len > handle->fast_huffman_length && len != NO_CODE)) {
+         || (len > book->fast_huffman_length && len != NO_CODE)) {
             const uint32_t code = bit_reverse(book->codewords[i]);
             int32_t low = 0, high = book->sorted_entries;
             /* sorted_codewords[low] <= code < sorted_codewords[high] */
@@ -431,14 +484,12 @@ static void compute_sorted_huffman(const stb_vorbis *handle, Codebook *book,
  * Huffman codes for the given codebook.
  *
  * [Parameters]
- *     handle: Stream handle.
  *     book: Codebook to operate on.
  */
-static void compute_accelerated_huffman(const stb_vorbis *handle,
-                                        Codebook *book)
+static void compute_accelerated_huffman(Codebook *book)
 {
     int16_t *fast_huffman = book->fast_huffman;
-    const unsigned int fast_huffman_mask = handle->fast_huffman_mask;
+    const unsigned int fast_huffman_mask = book->fast_huffman_mask;
     memset(fast_huffman, -1, sizeof(*fast_huffman) * (fast_huffman_mask + 1));
 
     int32_t len = book->sparse ? book->sorted_entries : book->entries;
@@ -446,7 +497,7 @@ static void compute_accelerated_huffman(const stb_vorbis *handle,
         len = 32767;
     }
     for (int i = 0; i < (int)len; i++) {
-        if (book->codeword_lengths[i] <= handle->fast_huffman_length) {
+        if (book->codeword_lengths[i] <= book->fast_huffman_length) {
             uint32_t code = (book->sparse
                              ? bit_reverse(book->sorted_codewords[i])
                              : book->codewords[i]);
@@ -460,6 +511,179 @@ static void compute_accelerated_huffman(const stb_vorbis *handle,
     }
 }
 
+/*-----------------------------------------------------------------------*/
+
+/**
+ * build_long_huffman:  Helper for compute_long_huffman() which builds
+ * the lookup entry for all codes beginning with the given bit prefix,
+ * recursively creating subtables as needed.
+ *
+ * If table is NULL, the function only counts the number of table slots
+ * required; otherwise, it also stores entries into the table.  Subtable
+ * offsets are assigned in the same order in both cases.
+ *
+ * [Parameters]
+ *     book: Codebook to operate on.
+ *     table: Table to store entries into, or NULL to only count slots.
+ *     next_ret: Pointer to the offset of the next free slot in the table.
+ *     prefix: Code prefix, in bit-reversed (MSB-first) order.
+ *     consumed: Number of bits in the prefix.
+ * [Return value]
+ *     Table entry for the prefix, or INT32_MIN if the codebook does not
+ *     contain a code matching the prefix.
+ */
+static int32_t build_long_huffman(const Codebook *book, int32_t *table,
+                                  int32_t *next_ret, uint32_t prefix,
+                                  int consumed)
+{
+    /* Find the last code which is not greater than the prefix.  This is
+     * the same search as in codebook_decode_scalar_raw_slow(). */
+    int32_t low = 0, high = book->sorted_entries;
+    if (book->sorted_codewords[0] > prefix) {
+        return INT32_MIN;
+    }
+    while (low+1 < high) {
+        const int32_t mid = (low + high) / 2;
+        if (book->sorted_codewords[mid] <= prefix) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+    const int32_t result = book->sparse ? low : book->sorted_values[low];
+    const int len = book->codeword_lengths[result];
+    const uint64_t mismatch =
+        (uint64_t)(book->sorted_codewords[low] ^ prefix) << 32;
+    if (len <= consumed) {
+        return (mismatch >> (64 - len)) == 0 ? result : INT32_MIN;
+    } else if (consumed > 0 && (mismatch >> (64 - consumed)) != 0) {
+        return INT32_MIN;
+    }
+
+    /* The prefix is shared by multiple codes, so we need a subtable.
+     * Find the longest of those codes to determine how many bits to
+     * index with, but avoid creating large tables for a sparse tree. */
+    const uint64_t end = (uint64_t)prefix + (UINT64_C(1) << (32 - consumed));
+    int max_len = 0;
+    int32_t count = 0;
+    for (int32_t i = low;
+         i < book->sorted_entries && book->sorted_codewords[i] < end; i++)
+    {
+        const int32_t value = book->sparse ? i : book->sorted_values[i];
+        max_len = max(max_len, book->codeword_lengths[value]);
+        count++;
+    }
+    int bits = min(max_len - consumed, 8);
+    while (bits > 1 && (INT32_C(1) << bits) > 4*count) {
+        bits--;
+    }
+
+    const int32_t offset = *next_ret;
+    if (offset >= (1 << 26) - (1 << bits)) {
+        return INT32_MIN;
+    }
+    *next_ret += 1 << bits;
+    for (int32_t j = 0; j < (INT32_C(1) << bits); j++) {
+        /* Table indices are taken from the bitstream in LSB-first order,
+         * so the bits of the index are reversed relative to the prefix. */
+        uint32_t child = prefix;
+        for (int b = 0; b < bits; b++) {
+            child |= (uint32_t)((j >> b) & 1) << (31 - consumed - b);
+        }
+        const int32_t entry =
+            build_long_huffman(book, table, next_ret, child, consumed + bits);
+        if (entry == INT32_MIN) {
+            return INT32_MIN;
+        }
+        if (table) {
+            table[offset + j] = entry;
+        }
+    }
+    return -((offset << 5) | bits);
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * compute_long_huffman:  Create the multi-level lookup tables for Huffman
+ * codes which are too long for the O(1) lookup table.  Must be called
+ * after compute_sorted_huffman() and compute_accelerated_huffman().
+ *
+ * Vorbis codebooks do not use canonical Huffman codes, so codewords
+ * cannot be decoded by comparing against per-length limits; instead,
+ * each unresolved entry of the O(1) table is linked to a chain of small
+ * subtables indexed by the following bits of the stream.  Each entry in
+ * long_huffman[] is either a nonnegative value with the same meaning as
+ * a fast_huffman[] entry, or -(offset<<5 | bits) indicating that the
+ * next "bits" bits of the stream index a subtable at the given offset.
+ *
+ * If the tables cannot be built (for example, if the O(1) table does not
+ * have room for the necessary links), the codebook is left unchanged and
+ * decoding falls back to binary search.
+ *
+ * [Parameters]
+ *     handle: Stream handle.
+ *     book: Codebook to operate on.
+ * [Return value]
+ *     False on memory allocation failure, true otherwise.
+ */
+static bool compute_long_huffman(const stb_vorbis *handle, Codebook *book)
+{
+    int16_t *fast_huffman = book->fast_huffman;
+    const unsigned int fast_huffman_mask = book->fast_huffman_mask;
+    const int fast_huffman_length = book->fast_huffman_length;
+
+    /* The first pass counts the number of slots needed; the second pass
+     * fills in the table.  The root entries for each unresolved O(1)
+     * table entry are stored at the beginning of the table. */
+    int32_t roots = 0;
+    for (unsigned int i = 0; i <= fast_huffman_mask; i++) {
+        roots += (fast_huffman[i] == -1);
+    }
+    if (roots == 0 || roots > 32766) {
+        return true;
+    }
+    int32_t *table = NULL;
+    int32_t size = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        int32_t next = roots;
+        int32_t root = 0;
+        for (unsigned int i = 0; i <= fast_huffman_mask; i++) {
+            if (fast_huffman[i] == -1) {
+                const int32_t entry = build_long_huffman(
+                    book, table, &next, bit_reverse(i), fast_huffman_length);
+                if (entry == INT32_MIN) {
+                    ASSERT(!table);
+                    return true;
+                }
+                if (table) {
+                    table[root] = entry;
+                }
+                root++;
+            }
+        }
+        if (!table) {
+            size = next;
+            table = mem_alloc(handle->mem_opaque, sizeof(*table) * size, 0);
+            if (!table) {
+                return false;
+            }
+        } else {
+            ASSERT(next == size);
+        }
+    }
+
+    int32_t root = 0;
+    for (unsigned int i = 0; i <= fast_huffman_mask; i++) {
+        if (fast_huffman[i] == -1) {
+            fast_huffman[i] = (int16_t)(-2 - root);
+            root++;
+        }
+    }
+    book->long_huffman = table;
+    return true;
+}
+
 /*************************************************************************/
 /************** Setup data parsing/initialization routines ***************/
 /*************************************************************************/
@@ -691,10 +915,13 @@ static bool parse_codebook_lookup(stb_vorbis *handle, Codebook *book)
  * [Parameters]
  *     handle: Stream handle.
  *     book: Codebook into which to store parsed data.
+ *     max_fast_entries: Maximum number of entries to use for the O(1)
+ *         Huffman lookup table.
  * [Return value]
  *     True on success, false on error.
  */
-static bool parse_codebook(stb_vorbis *handle, Codebook *book)
+static bool parse_codebook(stb_vorbis *handle, Codebook *book,
+                           uint64_t max_fast_entries)
 {
     /* Verify the codebook sync pattern and read basic parameters. */
     if (get_bits(handle, 24) != UINT32_C(0x564342)) {
@@ -778,6 +1005,11 @@ static bool parse_codebook(stb_vorbis *handle, Codebook *book)
         }
     }
 
+    /* Choose the size of the O(1) lookup table for this codebook. */
+    book->fast_huffman_length = (int8_t)choose_fast_huffman_length(
+        handle, lengths, book->entries, max_fast_entries);
+    book->fast_huffman_mask = (UINT32_C(1) << book->fast_huffman_length) - 1;
+
     /* Count the number of entries to be included in the sorted Huffman
      * tables (we omit codes in the accelerated table to save space). */
     if (book->sparse) {
@@ -789,7 +1021,7 @@ static bool parse_codebook(stb_vorbis *handle, Codebook *book)
          * from being created below. */
         if (handle->huffman_binary_search) {
             for (int32_t j = 0; j < book->entries; j++) {
-                if (lengths[j] > handle->fast_huffman_length
+                if (lengths[j] > book->fast_huffman_length
                  && lengths[j] != NO_CODE) {
                     book->sorted_entries++;
                 }
@@ -854,7 +1086,7 @@ static bool parse_codebook(stb_vorbis *handle, Codebook *book)
         compute_sorted_huffman(handle, book, lengths, values);
     }
     book->fast_huffman = mem_alloc(
-        handle->mem_opaque, ((handle->fast_huffman_mask + 1)
+        handle->mem_opaque, ((book->fast_huffman_mask + 1)
                          * sizeof(*book->fast_huffman)), 0);
     if (!book->fast_huffman) {
         if (book->sparse) {
@@ -863,11 +1095,23 @@ static bool parse_codebook(stb_vorbis *handle, Codebook *book)
         }
         return error(handle, VORBIS_outofmem);
     }
-    if (handle->fast_huffman_length > 0) {
-        compute_accelerated_huffman(handle, book);
+    if (book->fast_huffman_length > 0) {
+        compute_accelerated_huffman(book);
     } else {
         book->fast_huffman[0] = -1;
     }
+    /* The multi-level tables are only used to extend a nonempty O(1)
+     * table, so skip them if the caller disabled either the O(1) table or
+     * table-driven search (sparse codebooks always have sorted tables). */
+    if (book->sorted_entries > 0 && book->fast_huffman_length > 0
+     && handle->huffman_binary_search
+     && !compute_long_huffman(handle, book)) {
+        if (book->sparse) {
+            mem_free(handle->mem_opaque, values);
+            mem_free(handle->mem_opaque, lengths);
+        }
+        return error(handle, VORBIS_outofmem);
+    }
 
     /* For sparse codebooks, we've now compressed the data into our
      * target arrays so we no longer need the original buffers. */
@@ -914,10 +1158,19 @@ static NOINLINE bool parse_codebooks(stb_vorbis *handle)
     memset(handle->codebooks, 0,
            sizeof(*handle->codebooks) * handle->codebook_count);
 
+    /* The O(1) Huffman lookup tables share a memory budget equivalent to
+     * one table of the configured size per codebook.  Each codebook may
+     * use up to an equal share of the remaining budget, so space not
+     * needed by small codebooks is available to later, larger ones. */
+    uint64_t fast_budget =
+        (uint64_t)handle->codebook_count << handle->fast_huffman_length;
     for (int i = 0; i < handle->codebook_count; i++) {
-        if (!parse_codebook(handle, &handle->codebooks[i])) {
+        Codebook *book = &handle->codebooks[i];
+        const uint64_t share = fast_budget / (handle->codebook_count - i);
+        if (!parse_codebook(handle, book, share)) {
             return false;
         }
+        fast_budget -= book->fast_huffman_mask + 1;
     }
 
     return true;
@@ -991,21 +1244,58 @@ static NOINLINE bool parse_floors(stb_vorbis *handle)
                 }
             }
 
-            floor->map[0] = mem_alloc(
+            /* Precompute 2*cos(omega) for each run of equal map values
+             * so the decoder doesn't have to call cosf() for every run
+             * in every frame.  The map function is cheap enough relative
+             * to the rest of setup that we just evaluate it twice, once
+             * to count the runs and once to fill in the tables. */
+            int padded_count[2];
+            for (int blocktype = 0; blocktype < 2; blocktype++) {
+                const int n = handle->blocksize[blocktype] / 2;
+                int count = 0, last = 0;
+                for (int j = 0; j < n; j++) {
+                    const int value = floor0_map(floor, n, j);
+                    if (j == 0 || value != last) {
+                        count++;
+                        last = value;
+                    }
+                }
+                floor->run_count[blocktype] = count;
+                padded_count[blocktype] = (count + 3) & ~3;
+            }
+            floor->two_cos_omega[0] = mem_alloc(
                 handle->mem_opaque,
-                (handle->blocksize[0] + handle->blocksize[1] + 2)
-                    * sizeof(*floor->map[0]),
+                (padded_count[0] + padded_count[1])
+                    * sizeof(*floor->two_cos_omega[0])
+                + (floor->run_count[0] + floor->run_count[1])
+                    * sizeof(*floor->run_end[0]),
                 0);
-            if (!floor->map[0]) {
+            if (!floor->two_cos_omega[0]) {
                 return error(handle, VORBIS_outofmem);
             }
-            floor->map[1] = floor->map[0] + (handle->blocksize[0] + 1);
+            floor->two_cos_omega[1] =
+                floor->two_cos_omega[0] + padded_count[0];
+            floor->run_end[0] =
+                (int16_t *)(floor->two_cos_omega[1] + padded_count[1]);
+            floor->run_end[1] = floor->run_end[0] + floor->run_count[0];
+            const float omega_base = M_PIf / floor->bark_map_size;
             for (int blocktype = 0; blocktype < 2; blocktype++) {
                 const int n = handle->blocksize[blocktype] / 2;
+                float *two_cos_omega = floor->two_cos_omega[blocktype];
+                int16_t *run_end = floor->run_end[blocktype];
+                int run = -1, last = 0;
                 for (int j = 0; j < n; j++) {
-                    floor->map[blocktype][j] = floor0_map(floor, n, j);
+                    const int value = floor0_map(floor, n, j);
+                    if (j == 0 || value != last) {
+                        run++;
+                        two_cos_omega[run] = 2 * cosf(value * omega_base);
+                        last = value;
+                    }
+                    run_end[run] = j+1;
+                }
+                for (run++; run < padded_count[blocktype]; run++) {
+                    two_cos_omega[run] = two_cos_omega[run-1];
                 }
-                floor->map[blocktype][n] = -1;
             }
 
             /* Make sure the array is allocated so the decoder doesn't
@@ -1494,8 +1784,22 @@ bool start_decoder(
          * requires that this packet is the only packet in the first Ogg
          * page of the stream.  We follow this requirement to ensure that
          * we're looking at a valid Ogg Vorbis stream. */
-        if (!start_page(handle, false)) {
-            return false;
+        if (!handle->link_pending) {
+            if (!start_page(handle, false)) {
+                return false;
+            }
+            /* The stream may begin with an Ogg Skeleton header page,
+             * which will be followed by the Vorbis identification header
+             * page. */
+            if ((handle->segment_count != 1 || handle->segments[0] != 30)
+             && skeleton_start(handle)) {
+                if (!start_page(handle, false)) {
+                    return false;
+                }
+            }
+        } else {
+            /* For the next link of a chained stream, start_page() has
+             * already read the identification header page. */
         }
         if (handle->page_flag != PAGEFLAG_first_page
          || handle->segment_count != 1
@@ -1507,35 +1811,51 @@ bool start_decoder(
     if (validate_header_packet(handle) != VORBIS_packet_ident) {
         return error(handle, VORBIS_invalid_first_page);
     }
+    /* When starting a new link in a chained stream, the previous link's
+     * buffers can be reused if the channel count and block sizes are
+     * unchanged.  (On the initial call, these are all zero.) */
+    const int old_channels = handle->channels;
+    const int old_blocksize_0 = handle->blocksize[0];
+    const int old_blocksize_1 = handle->blocksize[1];
     if (!parse_ident_header(handle)) {
         return false;
     }
 
     /* Set up stream parameters and allocate buffers based on the stream
      * format. */
-    for (int i = 0; i < 2; i++) {
-        if (!init_blocksize(handle, i)) {
-            return false;
+    if (handle->channels != old_channels
+     || handle->blocksize[0] != old_blocksize_0
+     || handle->blocksize[1] != old_blocksize_1) {
+        free_setup_buffers(handle);
+        for (int i = 0; i < 2; i++) {
+            if (!init_blocksize(handle, i)) {
+                return false;
+            }
+        }
+        /* 16-byte alignment to help out vectorized loops. */
+        handle->channel_buffers[0] = alloc_channel_array(
+            handle->mem_opaque, handle->channels*2,
+            sizeof(float) * handle->blocksize[1], BUFFER_ALIGN);
+        if (!handle->channel_buffers[0]) {
+            return error(handle, VORBIS_outofmem);
+        }
+        handle->channel_buffers[1] =
+            handle->channel_buffers[0] + handle->channels;
+        handle->outputs = mem_alloc(
+            handle->mem_opaque, handle->channels * sizeof(float *),
+            BUFFER_ALIGN);
+        handle->previous_window = mem_alloc(
+            handle->mem_opaque, handle->channels * sizeof(float *),
+            BUFFER_ALIGN);
+        handle->imdct_temp_buf = mem_alloc(
+            handle->mem_opaque,
+            (handle->blocksize[1] / 2) * sizeof(*handle->imdct_temp_buf),
+            BUFFER_ALIGN);
+        if (!handle->outputs
+         || !handle->previous_window
+         || !handle->imdct_temp_buf) {
+            return error(handle, VORBIS_outofmem);
         }
-    }
-    /* 16-byte alignment to help out vectorized loops. */
-    handle->channel_buffers[0] = alloc_channel_array(
-        handle->mem_opaque, handle->channels*2,
-        sizeof(float) * handle->blocksize[1], BUFFER_ALIGN);
-    handle->channel_buffers[1] = handle->channel_buffers[0] + handle->channels;
-    handle->outputs = mem_alloc(
-        handle->mem_opaque, handle->channels * sizeof(float *), BUFFER_ALIGN);
-    handle->previous_window = mem_alloc(
-        handle->mem_opaque, handle->channels * sizeof(float *), BUFFER_ALIGN);
-    handle->imdct_temp_buf = mem_alloc(
-        handle->mem_opaque,
-        (handle->blocksize[1] / 2) * sizeof(*handle->imdct_temp_buf),
-        BUFFER_ALIGN);
-    if (!handle->channel_buffers[0]
-     || !handle->outputs
-     || !handle->previous_window
-     || !handle->imdct_temp_buf) {
-        return error(handle, VORBIS_outofmem);
     }
     for (int i = 0; i < handle->channels; i++) {
         memset(handle->channel_buffers[0][i], 0,
@@ -1584,6 +1904,7 @@ bool start_decoder(
     /* Set up remaining state parameters for decoding. */
     handle->previous_length = 0;
     handle->first_decode = true;
+    handle->restart_decode = false;
     if (handle->stream_len >= 0) {
         handle->p_first.page_start =
             (*handle->tell_callback)(handle->io_opaque);
@@ -1592,5 +1913,101 @@ bool start_decoder(
     return true;
 }
 
+/*-----------------------------------------------------------------------*/
+
+void free_setup_data(stb_vorbis *handle)
+{
+    if (handle->codebooks) {
+        for (int i = 0; i < handle->codebook_count; i++) {
+            Codebook *book = &handle->codebooks[i];
+            mem_free(handle->mem_opaque, book->codeword_lengths);
+            mem_free(handle->mem_opaque, book->multiplicands);
+            mem_free(handle->mem_opaque, book->codewords);
+            mem_free(handle->mem_opaque, book->fast_huffman);
+            mem_free(handle->mem_opaque, book->sorted_codewords);
+            mem_free(handle->mem_opaque, book->long_huffman);
+            /* book->sorted_values points one entry past the allocated
+             * address (see parse_codebook()). */
+            if (book->sorted_values) {
+                mem_free(handle->mem_opaque, book->sorted_values-1);
+            }
+        }
+        mem_free(handle->mem_opaque, handle->codebooks);
+        handle->codebooks = NULL;
+    }
+    handle->codebook_count = 0;
+
+    if (handle->floor_config) {
+        for (int i = 0; i < handle->floor_count; i++) {
+            Floor *floor = &handle->floor_config[i];
+            if (handle->floor_types[i] == 0) {
+                mem_free(handle->mem_opaque, floor->floor0.two_cos_omega[0]);
+            }
+        }
+        mem_free(handle->mem_opaque, handle->floor_config);
+        handle->floor_config = NULL;
+    }
+    handle->floor_count = 0;
+
+    if (handle->residue_config) {
+        for (int i = 0; i < handle->residue_count; i++) {
+            Residue *res = &handle->residue_config[i];
+            if (res->classdata) {
+                mem_free(handle->mem_opaque, res->classdata[0]);
+                mem_free(handle->mem_opaque, res->classdata);
+            }
+            mem_free(handle->mem_opaque, res->residue_books);
+        }
+        mem_free(handle->mem_opaque, handle->residue_config);
+        handle->residue_config = NULL;
+    }
+    handle->residue_count = 0;
+
+    if (handle->mapping) {
+        for (int i = 0; i < handle->mapping_count; i++) {
+            mem_free(handle->mem_opaque, handle->mapping[i].coupling);
+        }
+        mem_free(handle->mem_opaque, handle->mapping[0].mux);
+        mem_free(handle->mem_opaque, handle->mapping);
+        handle->mapping = NULL;
+    }
+    handle->mapping_count = 0;
+    handle->mode_count = 0;
+
+    mem_free(handle->mem_opaque, handle->coefficients);
+    handle->coefficients = NULL;
+    mem_free(handle->mem_opaque, handle->final_Y);
+    handle->final_Y = NULL;
+    mem_free(handle->mem_opaque, handle->classifications);
+    handle->classifications = NULL;
+}
+
+/*-----------------------------------------------------------------------*/
+
+void free_setup_buffers(stb_vorbis *handle)
+{
+#ifndef USE_LOOKUP_TABLES
+    for (int i = 0; i < 2; i++) {
+        mem_free(handle->mem_opaque, handle->A[i]);
+        mem_free(handle->mem_opaque, handle->B[i]);
+        mem_free(handle->mem_opaque, handle->C[i]);
+        mem_free(handle->mem_opaque, handle->bit_reverse[i]);
+        mem_free(handle->mem_opaque, handle->window_weights[i]);
+        handle->A[i] = handle->B[i] = handle->C[i] = NULL;
+        handle->bit_reverse[i] = NULL;
+        handle->window_weights[i] = NULL;
+    }
+#endif
+
+    mem_free(handle->mem_opaque, handle->channel_buffers[0]);
+    handle->channel_buffers[0] = handle->channel_buffers[1] = NULL;
+    mem_free(handle->mem_opaque, handle->outputs);
+    handle->outputs = NULL;
+    mem_free(handle->mem_opaque, handle->previous_window);
+    handle->previous_window = NULL;
+    mem_free(handle->mem_opaque, handle->imdct_temp_buf);
+    handle->imdct_temp_buf = NULL;
+}
+
 /*************************************************************************/
 /*************************************************************************/
@@ -34,6 +34,26 @@ extern bool start_decoder(
     stb_vorbis *handle, const void *id_packet, int32_t id_packet_len,
     const void *setup_packet, int32_t setup_packet_len);
 
+/**
+ * free_setup_data:  Free all data parsed from the stream's setup header,
+ * along with the associated temporary decoding buffers.
+ *
+ * [Parameters]
+ *     handle: Stream handle.
+ */
+#define free_setup_data INTERNAL(free_setup_data)
+extern void free_setup_data(stb_vorbis *handle);
+
+/**
+ * free_setup_buffers:  Free all buffers whose sizes depend on the stream's
+ * channel count or block sizes.
+ *
+ * [Parameters]
+ *     handle: Stream handle.
+ */
+#define free_setup_buffers INTERNAL(free_setup_buffers)
+extern void free_setup_buffers(stb_vorbis *handle);
+
 /*************************************************************************/
 /*************************************************************************/
 
@@ -0,0 +1,310 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+/*
+ * Support for reading keypoint indexes from Ogg Skeleton streams.  See
+ * <https://wiki.xiph.org/Ogg_Skeleton_4> for the format specification.
+ * Only Skeleton 4.0 and later streams carry an index; for earlier
+ * versions, the Skeleton stream is simply skipped.
+ */
+
+#include "include/nogg.h"
+#include "src/common.h"
+#include "src/decode/common.h"
+#include "src/decode/inlines.h"
+#include "src/decode/io.h"
+#include "src/decode/packet.h"
+#include "src/decode/skeleton.h"
+#include "src/util/memory.h"
+
+#include <string.h>
+
+/*************************************************************************/
+/**************************** Helper routines ****************************/
+/*************************************************************************/
+
+/* Maximum size of a Skeleton packet we will attempt to process.  This is
+ * enough for an index of several hundred thousand keypoints. */
+#define MAX_PACKET_SIZE  (1<<24)
+
+/* Size of the fixed portion of a Skeleton 4.0 index packet. */
+#define INDEX_HEADER_SIZE  42
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * get_varint:  Read a variable-length integer from a Skeleton index
+ * packet.  Each byte stores 7 bits of the value, least significant bits
+ * first, and the high bit is set on the final byte of the value.
+ *
+ * [Parameters]
+ *     data: Packet data.
+ *     len: Length of packet data, in bytes.
+ *     pos: Pointer to current read position (updated on success).
+ *     value_ret: Pointer to variable to receive the value.
+ * [Return value]
+ *     True on success, false if the data is truncated or the value is
+ *     out of range.
+ */
+static bool get_varint(const uint8_t *data, int32_t len, int32_t *pos,
+                       uint64_t *value_ret)
+{
+    uint64_t value = 0;
+    for (int shift = 0; shift < 63; shift += 7) {
+        if (*pos >= len) {
+            return false;
+        }
+        const uint8_t byte = data[(*pos)++];
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if (byte & 0x80) {
+            *value_ret = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * parse_index:  Parse a Skeleton index packet for the Vorbis stream and
+ * store the keypoints in the stream handle.  If the packet is invalid,
+ * it is ignored.
+ *
+ * [Parameters]
+ *     handle: Stream handle.
+ *     data: Packet data.
+ *     len: Length of packet data, in bytes (at least INDEX_HEADER_SIZE).
+ */
+static void parse_index(stb_vorbis *handle, const uint8_t *data, int32_t len)
+{
+    /* We can only use the index if the stream is seekable and it has not
+     * been modified since the index was created. */
+    if (handle->stream_len < 0
+     || (handle->skeleton_segment_length != 0
+         && handle->skeleton_segment_length
+                != (uint64_t)handle->stream_len)) {
+        return;
+    }
+
+    const uint64_t num_keypoints = extract_64(&data[10]);
+    const int64_t denominator = (int64_t)extract_64(&data[18]);
+    const int64_t first_time = (int64_t)extract_64(&data[26]);
+    /* Each keypoint takes at least two bytes. */
+    if (num_keypoints == 0
+     || num_keypoints > (uint64_t)(len - INDEX_HEADER_SIZE) / 2
+     || denominator <= 0) {
+        return;
+    }
+
+    SkeletonKeypoint *index = mem_alloc(
+        handle->mem_opaque, sizeof(*index) * (int32_t)num_keypoints, 0);
+    if (!index) {
+        return;
+    }
+    int32_t pos = INDEX_HEADER_SIZE;
+    uint64_t offset = 0, time = 0;
+    for (int i = 0; i < (int)num_keypoints; i++) {
+        uint64_t offset_delta, time_delta;
+        if (!get_varint(data, len, &pos, &offset_delta)
+         || !get_varint(data, len, &pos, &time_delta)
+         || offset_delta >= (uint64_t)handle->stream_len - offset
+         || time_delta > INT64_MAX - time) {
+            mem_free(handle->mem_opaque, index);
+            return;
+        }
+        offset += offset_delta;
+        time += time_delta;
+        index[i].page_start = (int64_t)offset;
+        if ((int64_t)time <= first_time) {
+            index[i].sample = 0;
+        } else {
+            index[i].sample = (uint64_t)((double)((int64_t)time - first_time)
+                                         * handle->sample_rate
+                                         / denominator);
+        }
+    }
+
+    mem_free(handle->mem_opaque, handle->skeleton_index);
+    handle->skeleton_index = index;
+    handle->skeleton_index_size = (int)num_keypoints;
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * process_packet:  Process a complete Skeleton packet.
+ *
+ * [Parameters]
+ *     handle: Stream handle.
+ *     data: Packet data.
+ *     len: Length of packet data, in bytes.
+ */
+static void process_packet(stb_vorbis *handle, const uint8_t *data,
+                           int32_t len)
+{
+    if (len >= 64 && memcmp(data, "fishead", 8) == 0) {
+        handle->skeleton_present = true;
+        const int version_major = data[8] | data[9]<<8;
+        if (version_major >= 4 && len >= 80) {
+            handle->skeleton_segment_length = extract_64(&data[64]);
+        }
+    } else if (len >= INDEX_HEADER_SIZE && memcmp(data, "index", 6) == 0) {
+        if (handle->bitstream_id_set
+         && extract_32(&data[6]) == handle->bitstream_id) {
+            parse_index(handle, data, len);
+        }
+    }
+    /* Other packets (such as fisbone packets) are not needed. */
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * append_packet_data:  Append data from the stream to the Skeleton packet
+ * buffer, expanding the buffer if needed.
+ *
+ * [Parameters]
+ *     handle: Stream handle.
+ *     len: Number of bytes to read.
+ * [Return value]
+ *     True on success, false if the end of the stream was reached.
+ */
+static bool append_packet_data(stb_vorbis *handle, int len)
+{
+    const int32_t new_len = handle->skeleton_packet_len + len;
+    if (new_len > handle->skeleton_packet_size) {
+        if (new_len > MAX_PACKET_SIZE) {
+            handle->skeleton_done = true;
+        } else {
+            int32_t new_size = max(handle->skeleton_packet_size * 2, 4096);
+            while (new_size < new_len) {
+                new_size *= 2;
+            }
+            uint8_t *new_packet = mem_alloc(handle->mem_opaque, new_size, 0);
+            if (!new_packet) {
+                handle->skeleton_done = true;
+            } else {
+                if (handle->skeleton_packet_len > 0) {
+                    memcpy(new_packet, handle->skeleton_packet,
+                           handle->skeleton_packet_len);
+                }
+                mem_free(handle->mem_opaque, handle->skeleton_packet);
+                handle->skeleton_packet = new_packet;
+                handle->skeleton_packet_size = new_size;
+            }
+        }
+        if (handle->skeleton_done) {
+            skip(handle, len);
+            return !handle->eof;
+        }
+    }
+
+    if (!getn(handle, handle->skeleton_packet + handle->skeleton_packet_len,
+              len)) {
+        return false;
+    }
+    handle->skeleton_packet_len = new_len;
+    return true;
+}
+
+/*************************************************************************/
+/************************** Interface routines ***************************/
+/*************************************************************************/
+
+bool skeleton_start(stb_vorbis *handle)
+{
+    if (handle->page_flag != PAGEFLAG_first_page
+     || handle->segment_count == 0
+     || handle->segments[0] < 64) {
+        return false;
+    }
+
+    handle->skeleton_id = handle->bitstream_id;
+    if (!skeleton_read_page(handle, handle->page_flag)
+     || !handle->skeleton_present) {
+        handle->skeleton_present = false;
+        return false;
+    }
+
+    /* The next page should be the first page of the Vorbis stream, so
+     * clear the bitstream ID to let start_page() pick it up. */
+    handle->bitstream_id_set = false;
+    reset_page(handle);
+    return true;
+}
+
+/*-----------------------------------------------------------------------*/
+
+bool skeleton_read_page(stb_vorbis *handle, int page_flag)
+{
+    /* If the packet continuation state is inconsistent, we must have
+     * lost data; drop the partial packet (if any) and skip to the start
+     * of the next packet. */
+    bool discard = false;
+    if (page_flag & PAGEFLAG_continued_packet) {
+        discard = (handle->skeleton_packet_len == 0);
+    } else {
+        handle->skeleton_packet_len = 0;
+    }
+
+    for (int i = 0; i < handle->segment_count; i++) {
+        const int seglen = handle->segments[i];
+        if (discard || handle->skeleton_done) {
+            skip(handle, seglen);
+            if (handle->eof) {
+                return false;
+            }
+        } else if (!append_packet_data(handle, seglen)) {
+            return false;
+        }
+        if (seglen < 255) {
+            if (!discard && !handle->skeleton_done) {
+                process_packet(handle, handle->skeleton_packet,
+                               handle->skeleton_packet_len);
+            }
+            handle->skeleton_packet_len = 0;
+            discard = false;
+        }
+    }
+
+    if (page_flag & PAGEFLAG_last_page) {
+        handle->skeleton_done = true;
+    }
+    if (handle->skeleton_done) {
+        mem_free(handle->mem_opaque, handle->skeleton_packet);
+        handle->skeleton_packet = NULL;
+        handle->skeleton_packet_len = 0;
+        handle->skeleton_packet_size = 0;
+    }
+    return true;
+}
+
+/*-----------------------------------------------------------------------*/
+
+int skeleton_find_keypoint(const stb_vorbis *handle, uint64_t sample)
+{
+    const SkeletonKeypoint *index = handle->skeleton_index;
+    if (!index || index[0].sample > sample) {
+        return -1;
+    }
+    int low = 0, high = handle->skeleton_index_size - 1;
+    while (low < high) {
+        const int mid = (low + high + 1) / 2;
+        if (index[mid].sample <= sample) {
+            low = mid;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return low;
+}
+
+/*************************************************************************/
+/*************************************************************************/
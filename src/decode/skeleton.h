@@ -0,0 +1,64 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#ifndef NOGG_SRC_DECODE_SKELETON_H
+#define NOGG_SRC_DECODE_SKELETON_H
+
+/*************************************************************************/
+/*************************************************************************/
+
+/**
+ * skeleton_start:  Check whether the current page (which must be the first
+ * page of the stream, as just read by start_page()) is the beginning of an
+ * Ogg Skeleton stream, and if so, process it and prepare to read the
+ * first page of the Vorbis stream.  If the page is not a Skeleton page,
+ * its contents may have been partially consumed.
+ *
+ * [Parameters]
+ *     handle: Stream handle.
+ * [Return value]
+ *     True if the page was a Skeleton header page, false if not.
+ */
+#define skeleton_start INTERNAL(skeleton_start)
+extern bool skeleton_start(stb_vorbis *handle);
+
+/**
+ * skeleton_read_page:  Read and process the payload of a page from the
+ * Skeleton stream.  The page header must have been read by start_page(),
+ * and the stream read position must be at the beginning of the page
+ * payload.  Errors in the Skeleton data are not reported; any data which
+ * cannot be parsed is simply ignored.
+ *
+ * [Parameters]
+ *     handle: Stream handle.
+ *     page_flag: Flags from the page header (PAGEFLAG_*).
+ * [Return value]
+ *     True on success, false if the end of the stream was reached.
+ */
+#define skeleton_read_page INTERNAL(skeleton_read_page)
+extern bool skeleton_read_page(stb_vorbis *handle, int page_flag);
+
+/**
+ * skeleton_find_keypoint:  Look up the Skeleton index keypoint nearest to
+ * but not after the given sample offset.
+ *
+ * [Parameters]
+ *     handle: Stream handle.
+ *     sample: Target sample offset.
+ * [Return value]
+ *     Index of the keypoint in handle->skeleton_index, or -1 if there is
+ *     no suitable keypoint.
+ */
+#define skeleton_find_keypoint INTERNAL(skeleton_find_keypoint)
+extern int skeleton_find_keypoint(const stb_vorbis *handle, uint64_t sample);
+
+/*************************************************************************/
+/*************************************************************************/
+
+#endif  // NOGG_SRC_DECODE_SKELETON_H
@@ -13,7 +13,8 @@
  * It shares the following limitations with that implementation:
  *    - Lossless sample truncation at the beginning of the stream
  *         (negative initial sample position) is ignored.
- *    - Only a single Ogg bitstream per stream is supported.
+ *    - Only a single Ogg bitstream per stream is supported (except for
+ *         sequentially chained streams, which are decoded in turn).
  */
 
 #include "include/nogg.h"
@@ -32,6 +33,38 @@
 /**************************** Helper routines ****************************/
 /*************************************************************************/
 
+/* Decoder state saved by stb_vorbis_snapshot().  The overlap data from
+ * the previous frame (previous_length samples for each channel) follows
+ * this structure in the snapshot buffer. */
+typedef struct DecoderSnapshot {
+    int64_t file_offset;
+    uint64_t current_loc;
+    uint64_t restart_loc;
+    uint64_t known_loc_for_packet;
+    unsigned long acc;
+    int valid_bits;
+    int channels;
+    int previous_length;
+    int end_seg_with_known_loc;
+    int next_seg;
+    int last_seg_index;
+    uint32_t page_number;
+    int8_t cur_channel_buffer;
+    uint8_t segment_count;
+    uint8_t page_flag;
+    uint8_t segment_size;
+    uint8_t segment_pos;
+    bool current_loc_valid;
+    bool first_decode;
+    bool restart_decode;
+    bool last_seg;
+    bool eof;
+    uint8_t segments[255];
+    uint8_t segment_data[255];
+} DecoderSnapshot;
+
+/*-----------------------------------------------------------------------*/
+
 /**
  * create_handle:  Create a new stb_vorbis handle with the given parameters.
  * Implements stb_vorbis_open_callbacks() and stb_vorbis_open_packet().
@@ -73,8 +106,6 @@ static stb_vorbis *create_handle(
             handle->fast_huffman_length = fast_bits;
         }
     }
-    handle->fast_huffman_mask =
-        (UINT32_C(1) << handle->fast_huffman_length) - 1;
     handle->huffman_binary_search =
         ((options & VORBIS_OPTION_NO_HUFFMAN_BINARY_SEARCH) == 0);
     handle->divides_in_residue =
@@ -83,6 +114,9 @@ static stb_vorbis *create_handle(
         ((options & VORBIS_OPTION_DIVIDES_IN_CODEBOOK) != 0);
     handle->scan_for_next_page =
         ((options & VORBIS_OPTION_SCAN_FOR_NEXT_PAGE) != 0);
+    handle->chained_streams =
+        ((options & VORBIS_OPTION_CHAINED_STREAMS) != 0);
+    handle->channel_mask = ~UINT64_C(0);
 
     if (!start_decoder(handle, id_packet, id_packet_len,
                        setup_packet, setup_packet_len)) {
@@ -125,70 +159,13 @@ stb_vorbis *stb_vorbis_open_packet(
 
 void stb_vorbis_close(stb_vorbis *handle)
 {
-    if (handle->codebooks) {
-        for (int i = 0; i < handle->codebook_count; i++) {
-            Codebook *book = &handle->codebooks[i];
-            mem_free(handle->mem_opaque, book->codeword_lengths);
-            mem_free(handle->mem_opaque, book->multiplicands);
-            mem_free(handle->mem_opaque, book->codewords);
-            mem_free(handle->mem_opaque, book->fast_huffman);
-            mem_free(handle->mem_opaque, book->sorted_codewords);
-            /* book->sorted_values points one entry past the allocated
-             * address (see notes in setup.c). */
-            if (book->sorted_values) {
-                mem_free(handle->mem_opaque, book->sorted_values-1);
-            }
-        }
-        mem_free(handle->mem_opaque, handle->codebooks);
-    }
-
-    if (handle->floor_config) {
-        for (int i = 0; i < handle->floor_count; i++) {
-            Floor *floor = &handle->floor_config[i];
-            if (handle->floor_types[i] == 0) {
-                mem_free(handle->mem_opaque, floor->floor0.map[0]);
-            }
-        }
-        mem_free(handle->mem_opaque, handle->floor_config);
-    }
-
-    if (handle->residue_config) {
-        for (int i = 0; i < handle->residue_count; i++) {
-            Residue *res = &handle->residue_config[i];
-            if (res->classdata) {
-                mem_free(handle->mem_opaque, res->classdata[0]);
-                mem_free(handle->mem_opaque, res->classdata);
-            }
-            mem_free(handle->mem_opaque, res->residue_books);
-        }
-        mem_free(handle->mem_opaque, handle->residue_config);
-    }
-
-    if (handle->mapping) {
-        for (int i = 0; i < handle->mapping_count; i++) {
-            mem_free(handle->mem_opaque, handle->mapping[i].coupling);
-        }
-        mem_free(handle->mem_opaque, handle->mapping[0].mux);
-        mem_free(handle->mem_opaque, handle->mapping);
-    }
-
-#ifndef USE_LOOKUP_TABLES
-    for (int i = 0; i < 2; i++) {
-        mem_free(handle->mem_opaque, handle->A[i]);
-        mem_free(handle->mem_opaque, handle->B[i]);
-        mem_free(handle->mem_opaque, handle->C[i]);
-        mem_free(handle->mem_opaque, handle->bit_reverse[i]);
-        mem_free(handle->mem_opaque, handle->window_weights[i]);
-    }
-#endif
-
-    mem_free(handle->mem_opaque, handle->channel_buffers[0]);
-    mem_free(handle->mem_opaque, handle->outputs);
-    mem_free(handle->mem_opaque, handle->previous_window);
-    mem_free(handle->mem_opaque, handle->coefficients);
-    mem_free(handle->mem_opaque, handle->final_Y);
-    mem_free(handle->mem_opaque, handle->classifications);
-    mem_free(handle->mem_opaque, handle->imdct_temp_buf);
+    free_setup_data(handle);
+    free_setup_buffers(handle);
+    mem_free(handle->mem_opaque, handle->seek_index);
+    mem_free(handle->mem_opaque, handle->frame_map);
+    mem_free(handle->mem_opaque, handle->probe_buf);
+    mem_free(handle->mem_opaque, handle->skeleton_packet);
+    mem_free(handle->mem_opaque, handle->skeleton_index);
 
     mem_free(handle->mem_opaque, handle);
 }
@@ -216,11 +193,19 @@ stb_vorbis_info stb_vorbis_get_info(stb_vorbis *handle)
          * the case of a long block preceded by another long block and
          * followed by a short block. */
         .max_frame_size = handle->blocksize[1]*3/4 - handle->blocksize[0]/4,
+        .bitstream_id = handle->bitstream_id,
     });
 }
 
 /*-----------------------------------------------------------------------*/
 
+void stb_vorbis_set_channel_mask(stb_vorbis *handle, uint64_t mask)
+{
+    handle->channel_mask = mask;
+}
+
+/*-----------------------------------------------------------------------*/
+
 uint64_t stb_vorbis_tell_pcm(stb_vorbis *handle)
 {
     return handle->current_loc_valid ? handle->current_loc : 0;
@@ -251,6 +236,180 @@ void stb_vorbis_reset_eof(stb_vorbis *handle)
 
 /*-----------------------------------------------------------------------*/
 
+void stb_vorbis_reset_packet_state(stb_vorbis *handle)
+{
+    ASSERT(handle->packet_mode);
+
+    handle->previous_length = 0;
+    handle->first_decode = true;
+    handle->current_loc = 0;
+    handle->current_loc_valid = false;
+    handle->error = VORBIS__no_error;
+}
+
+/*-----------------------------------------------------------------------*/
+
+bool stb_vorbis_link_pending(stb_vorbis *handle)
+{
+    return handle->link_pending;
+}
+
+/*-----------------------------------------------------------------------*/
+
+bool stb_vorbis_next_link(stb_vorbis *handle)
+{
+    ASSERT(handle->link_pending);
+
+    const uint64_t position = (handle->current_loc_valid
+                               ? handle->current_loc : handle->link_base);
+
+    /* The setup data is always replaced, but start_decoder() keeps the
+     * decoding buffers if the new link has the same shape. */
+    free_setup_data(handle);
+    const bool success = start_decoder(handle, NULL, 0, NULL, 0);
+    handle->link_pending = false;
+    handle->link_ended = false;
+    if (!success) {
+        return false;
+    }
+
+    /* The first frame of the new link has no preceding frame to overlap
+     * with, so decode it as for an approximate seek. */
+    handle->first_decode = false;
+    stb_vorbis_set_link_start(handle, position);
+    return true;
+}
+
+/*-----------------------------------------------------------------------*/
+
+void stb_vorbis_set_link_start(stb_vorbis *handle, uint64_t position)
+{
+    handle->link_base = position;
+    handle->restart_decode = true;
+    handle->restart_loc = position;
+}
+
+/*-----------------------------------------------------------------------*/
+
+int32_t stb_vorbis_snapshot_size(stb_vorbis *handle)
+{
+    return sizeof(DecoderSnapshot)
+        + sizeof(float) * handle->channels * handle->previous_length;
+}
+
+/*-----------------------------------------------------------------------*/
+
+void stb_vorbis_snapshot(stb_vorbis *handle, void *buf)
+{
+    ASSERT(handle->stream_len >= 0);
+    ASSERT(!handle->probe_mode);
+
+    DecoderSnapshot snapshot;
+    memset(&snapshot, 0, sizeof(snapshot));
+    snapshot.file_offset = (*handle->tell_callback)(handle->io_opaque);
+    snapshot.current_loc = handle->current_loc;
+    snapshot.restart_loc = handle->restart_loc;
+    snapshot.known_loc_for_packet = handle->known_loc_for_packet;
+    snapshot.acc = handle->acc;
+    snapshot.valid_bits = handle->valid_bits;
+    snapshot.channels = handle->channels;
+    snapshot.previous_length = handle->previous_length;
+    snapshot.end_seg_with_known_loc = handle->end_seg_with_known_loc;
+    snapshot.next_seg = handle->next_seg;
+    snapshot.last_seg_index = handle->last_seg_index;
+    snapshot.page_number = handle->page_number;
+    snapshot.cur_channel_buffer = handle->cur_channel_buffer;
+    snapshot.segment_count = handle->segment_count;
+    snapshot.page_flag = handle->page_flag;
+    snapshot.segment_size = handle->segment_size;
+    snapshot.segment_pos = handle->segment_pos;
+    snapshot.current_loc_valid = handle->current_loc_valid;
+    snapshot.first_decode = handle->first_decode;
+    snapshot.restart_decode = handle->restart_decode;
+    snapshot.last_seg = handle->last_seg;
+    snapshot.eof = handle->eof;
+    memcpy(snapshot.segments, handle->segments, sizeof(snapshot.segments));
+    memcpy(snapshot.segment_data, handle->segment_data,
+           sizeof(snapshot.segment_data));
+
+    uint8_t *out = buf;
+    memcpy(out, &snapshot, sizeof(snapshot));
+    out += sizeof(snapshot);
+    const int32_t window_size = sizeof(float) * handle->previous_length;
+    for (int i = 0; i < handle->channels; i++, out += window_size) {
+        memcpy(out, handle->previous_window[i], window_size);
+    }
+}
+
+/*-----------------------------------------------------------------------*/
+
+bool stb_vorbis_restore(stb_vorbis *handle, const void *buf, int32_t size)
+{
+    ASSERT(handle->stream_len >= 0);
+
+    if (size < (int32_t)sizeof(DecoderSnapshot)) {
+        return false;
+    }
+    DecoderSnapshot snapshot;
+    memcpy(&snapshot, buf, sizeof(snapshot));
+    if (snapshot.channels != handle->channels
+     || (snapshot.previous_length != 0
+         && snapshot.previous_length != handle->blocksize[0] / 2
+         && snapshot.previous_length != handle->blocksize[1] / 2)
+     || size != (int32_t)(sizeof(snapshot) + sizeof(float)
+                          * snapshot.channels * snapshot.previous_length)
+     || snapshot.file_offset < 0 || snapshot.file_offset > handle->stream_len
+     || snapshot.cur_channel_buffer < 0
+     || snapshot.cur_channel_buffer >= lenof(handle->channel_buffers)
+     || snapshot.next_seg < -1 || snapshot.next_seg > snapshot.segment_count
+     || snapshot.end_seg_with_known_loc >= snapshot.segment_count
+     || snapshot.last_seg_index < -1 || snapshot.last_seg_index >= 255
+     || snapshot.valid_bits < -1
+     || snapshot.valid_bits > (int)(sizeof(handle->acc) * 8)) {
+        return false;
+    }
+
+    (*handle->seek_callback)(handle->io_opaque, snapshot.file_offset);
+    handle->current_loc = snapshot.current_loc;
+    handle->restart_loc = snapshot.restart_loc;
+    handle->known_loc_for_packet = snapshot.known_loc_for_packet;
+    handle->acc = snapshot.acc;
+    handle->valid_bits = snapshot.valid_bits;
+    handle->end_seg_with_known_loc = snapshot.end_seg_with_known_loc;
+    handle->next_seg = snapshot.next_seg;
+    handle->last_seg_index = snapshot.last_seg_index;
+    handle->page_number = snapshot.page_number;
+    handle->segment_count = snapshot.segment_count;
+    handle->page_flag = snapshot.page_flag;
+    handle->segment_size = snapshot.segment_size;
+    handle->segment_pos = snapshot.segment_pos;
+    handle->current_loc_valid = snapshot.current_loc_valid;
+    handle->first_decode = snapshot.first_decode;
+    handle->restart_decode = snapshot.restart_decode;
+    handle->last_seg = snapshot.last_seg;
+    handle->eof = snapshot.eof;
+    handle->error = VORBIS__no_error;
+    memcpy(handle->segments, snapshot.segments, sizeof(snapshot.segments));
+    memcpy(handle->segment_data, snapshot.segment_data,
+           sizeof(snapshot.segment_data));
+
+    /* The next frame is decoded into the current channel buffer, so the
+     * overlap data goes in the other one. */
+    handle->cur_channel_buffer = snapshot.cur_channel_buffer;
+    float **window_buffers = handle->channel_buffers[
+        (snapshot.cur_channel_buffer + 1) % lenof(handle->channel_buffers)];
+    handle->previous_length = snapshot.previous_length;
+    const uint8_t *in = (const uint8_t *)buf + sizeof(snapshot);
+    const int32_t window_size = sizeof(float) * handle->previous_length;
+    for (int i = 0; i < handle->channels; i++, in += window_size) {
+        handle->previous_window[i] = window_buffers[i];
+        memcpy(handle->previous_window[i], in, window_size);
+    }
+    return true;
+}
+
+/*-----------------------------------------------------------------------*/
+
 bool stb_vorbis_get_frame_float(stb_vorbis *handle, float ***output_ret,
                                 int *len_ret)
 {
@@ -11,6 +11,9 @@
 #include "src/common.h"
 #include "src/util/decode-frame.h"
 #include "src/util/float-to-int16.h"
+#include "src/util/float-to-int32.h"
+#include "src/util/memory.h"
+#include "src/util/resample.h"
 #include "src/x86.h"
 
 #include <string.h>
@@ -23,6 +26,75 @@
 /**************************** Helper routines ****************************/
 /*************************************************************************/
 
+/**
+ * downmix:  Mix source channels down to a (smaller) set of destination
+ * channels.  Each destination channel is the sum of all source channels
+ * weighted by the corresponding row of the mixing matrix.
+ *
+ * [Parameters]
+ *     dest: Destination buffer pointer array (out_channels entries, each
+ *         aligned to a multiple of 64 bytes).
+ *     src: Source buffer pointer array (in_channels entries).
+ *     in_channels: Number of source channels.
+ *     out_channels: Number of destination channels.
+ *     matrix: Mixing matrix (out_channels rows of in_channels values).
+ *     samples: Number of samples per channel.
+ */
+static void downmix(float **dest, float **src, int in_channels,
+                    int out_channels, const float *matrix, int samples)
+{
+    /* The accumulation order is the same in all code paths, so the
+     * output does not depend on which optimizations are enabled. */
+    for (int o = 0; o < out_channels; o++) {
+        const float *row = &matrix[o * in_channels];
+        float *out = dest[o];
+        int i = 0;
+
+#if defined(ENABLE_ASM_ARM_NEON)
+        for (; i + 4 <= samples; i += 4) {
+            float32x4_t sum = vmulq_f32(vld1q_f32(&src[0][i]),
+                                        vdupq_n_f32(row[0]));
+            for (int c = 1; c < in_channels; c++) {
+                sum = vaddq_f32(sum, vmulq_f32(vld1q_f32(&src[c][i]),
+                                               vdupq_n_f32(row[c])));
+            }
+            vst1q_f32(&out[i], sum);
+        }
+#elif defined(ENABLE_ASM_X86_AVX2)
+        for (; i + 8 <= samples; i += 8) {
+            __m256 sum = _mm256_mul_ps(_mm256_loadu_ps(&src[0][i]),
+                                       _mm256_set1_ps(row[0]));
+            for (int c = 1; c < in_channels; c++) {
+                sum = _mm256_add_ps(sum, _mm256_mul_ps(
+                                        _mm256_loadu_ps(&src[c][i]),
+                                        _mm256_set1_ps(row[c])));
+            }
+            _mm256_store_ps(&out[i], sum);
+        }
+#elif defined(ENABLE_ASM_X86_SSE2)
+        for (; i + 4 <= samples; i += 4) {
+            __m128 sum = _mm_mul_ps(_mm_loadu_ps(&src[0][i]),
+                                    _mm_set1_ps(row[0]));
+            for (int c = 1; c < in_channels; c++) {
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(&src[c][i]),
+                                                 _mm_set1_ps(row[c])));
+            }
+            _mm_store_ps(&out[i], sum);
+        }
+#endif  // ENABLE_ASM_*
+
+        for (; i < samples; i++) {
+            float sum = src[0][i] * row[0];
+            for (int c = 1; c < in_channels; c++) {
+                sum += src[c][i] * row[c];
+            }
+            out[i] = sum;
+        }
+    }
+}
+
+/*-----------------------------------------------------------------------*/
+
 /**
  * interleave:  Interleave source channels into a destination buffer.
  *
@@ -90,39 +162,293 @@ static void interleave_2(float *dest, float **src, int samples)
     }
 }
 
-/*************************************************************************/
-/************************** Interface routines ***************************/
-/*************************************************************************/
+/*-----------------------------------------------------------------------*/
 
-vorbis_error_t decode_frame(vorbis_t *handle, const void *packet,
-                            int32_t packet_len)
+/**
+ * grow_buffers:  Reallocate the decode buffer (and the downmix buffer, if
+ * downmixing) to hold frames of the given size.  On failure, the existing
+ * buffers are left unchanged.
+ *
+ * [Parameters]
+ *     handle: Handle to operate on.
+ *     frame_size: New maximum frame size, in samples per channel.
+ * [Return value]
+ *     True on success, false on allocation failure.
+ */
+static bool grow_buffers(vorbis_t *handle, int frame_size)
+{
+    const int sample_size = decode_buf_sample_size(handle);
+    void *decode_buf = mem_alloc(
+        handle, sample_size * handle->stream_channels * frame_size, 64);
+    if (!decode_buf) {
+        return false;
+    }
+    float **downmix_buf = NULL;
+    if (handle->downmix_buf) {
+        downmix_buf = alloc_channel_array(
+            handle, handle->channels, sizeof(float) * frame_size, 64);
+        if (!downmix_buf) {
+            mem_free(handle, decode_buf);
+            return false;
+        }
+    }
+
+    mem_free(handle, handle->decode_buf);
+    handle->decode_buf = decode_buf;
+    if (downmix_buf) {
+        mem_free(handle, handle->downmix_buf);
+        handle->downmix_buf = downmix_buf;
+    }
+    return true;
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * start_next_link:  Start decoding the pending link of a chained stream.
+ * If the new link's audio format differs from that of the previous link,
+ * the link_changed flag is set and decoding stops until change_format()
+ * is called.
+ *
+ * [Parameters]
+ *     handle: Handle to operate on.
+ * [Return value]
+ *     True if decoding can continue with the new link, false if not.
+ */
+static bool start_next_link(vorbis_t *handle)
+{
+    const stb_vorbis_info old_info = stb_vorbis_get_info(handle->decoder);
+    if (!stb_vorbis_next_link(handle->decoder)) {
+        return false;
+    }
+    const stb_vorbis_info info = stb_vorbis_get_info(handle->decoder);
+
+    if (info.channels == old_info.channels
+     && info.sample_rate == old_info.sample_rate) {
+        if (info.max_frame_size <= old_info.max_frame_size) {
+            return true;
+        }
+        /* The resampler's buffers can't be resized without losing its
+         * filter state, so in that case we treat larger frames as a
+         * format change. */
+        if (!handle->resampler
+         && grow_buffers(handle, info.max_frame_size)) {
+            return true;
+        }
+    }
+
+    handle->link_changed = 1;
+    return false;
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * change_format:  Apply the audio format of a new link in a chained
+ * stream after all data from the previous link has been returned.  Any
+ * resampling, downmixing, or channel mask settings are cleared.
+ *
+ * [Parameters]
+ *     handle: Handle to operate on.
+ * [Return value]
+ *     VORBIS_ERROR_STREAM_CHANGED on success, or another VORBIS_ERROR_*
+ *     code on error.
+ */
+static vorbis_error_t change_format(vorbis_t *handle)
+{
+    ASSERT(handle->link_changed);
+
+    const stb_vorbis_info info = stb_vorbis_get_info(handle->decoder);
+    const int sample_size = decode_buf_sample_size(handle);
+    void *decode_buf = mem_alloc(
+        handle, sample_size * info.channels * info.max_frame_size, 64);
+    if (!decode_buf) {
+        return VORBIS_ERROR_INSUFFICIENT_RESOURCES;
+    }
+    mem_free(handle, handle->decode_buf);
+    handle->decode_buf = decode_buf;
+
+    handle->frame_pos += handle->decode_buf_len;
+    handle->decode_buf_pos = 0;
+    handle->decode_buf_len = 0;
+    if (handle->resampler) {
+        /* Our sample positions have been counted at the output rate, so
+         * the new link's positions need to continue from there. */
+        stb_vorbis_set_link_start(handle->decoder, handle->frame_pos);
+        resampler_free(handle, handle->resampler);
+        handle->resampler = NULL;
+    }
+    mem_free(handle, handle->downmix_matrix);
+    handle->downmix_matrix = NULL;
+    mem_free(handle, handle->downmix_buf);
+    handle->downmix_buf = NULL;
+    stb_vorbis_set_channel_mask(handle->decoder, ~UINT64_C(0));
+
+    handle->channels = info.channels;
+    handle->stream_channels = info.channels;
+    handle->rate = info.sample_rate;
+    handle->link_changed = 0;
+    return VORBIS_ERROR_STREAM_CHANGED;
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * get_frame:  Decode the next frame from the stream (or the given packet,
+ * for a packet-mode decoder) and return the decoder's output buffers.
+ * The handle's frame position is advanced past the previous frame, and
+ * decode_buf is marked empty.
+ *
+ * [Parameters]
+ *     handle: Handle to operate on.
+ *     packet: Pointer to packet data (packet-mode decoders only).
+ *     packet_len: Length of packet, in bytes (packet-mode decoders only).
+ *     outputs_ret: Pointer to variable to receive the decoder's output
+ *         buffer array (one buffer per stream channel).
+ *     stb_error_ret: Pointer to variable to receive the decoder's error
+ *         code for the operation.
+ * [Return value]
+ *     Number of samples per channel decoded.
+ */
+static int get_frame(vorbis_t *handle, const void *packet,
+                     int32_t packet_len, float ***outputs_ret,
+                     STBVorbisError *stb_error_ret)
 {
     handle->frame_pos += handle->decode_buf_len;
     handle->decode_buf_pos = 0;
     handle->decode_buf_len = 0;
 
     (void) stb_vorbis_get_error(handle->decoder);  // Clear any pending error.
-    float **outputs;
     int samples = 0;
     if (handle->packet_mode) {
         ASSERT(packet != NULL);
         ASSERT(packet_len > 0);
         (void) stb_vorbis_decode_packet_float(handle->decoder, packet,
-                                              packet_len, &outputs, &samples);
+                                              packet_len, outputs_ret,
+                                              &samples);
     } else {
         do {
+            /* At the end of a link in a chained stream, continue with the
+             * next link unless the audio format changes. */
+            if (stb_vorbis_link_pending(handle->decoder)
+             && !start_next_link(handle)) {
+                break;
+            }
             stb_vorbis_reset_eof(handle->decoder);
             if (!stb_vorbis_get_frame_float(handle->decoder,
-                                            &outputs, &samples)) {
+                                            outputs_ret, &samples)) {
+                if (stb_vorbis_link_pending(handle->decoder)) {
+                    continue;  // samples is still zero, so we loop.
+                }
                 break;
             }
             handle->frame_pos = stb_vorbis_tell_pcm(handle->decoder) - samples;
         } while (samples == 0);
     }
+    *stb_error_ret = stb_vorbis_get_error(handle->decoder);
+    return samples;
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * frame_result:  Return the libnogg error code corresponding to the
+ * result of decoding a frame.
+ *
+ * [Parameters]
+ *     samples: Number of samples obtained from the frame (zero indicates
+ *         end of stream if there was no decoder error).
+ *     stb_error: Decoder error code.
+ * [Return value]
+ *     VORBIS_NO_ERROR or a VORBIS_ERROR_* code.
+ */
+static vorbis_error_t frame_result(int samples, STBVorbisError stb_error)
+{
+    if (samples == 0 && stb_error == VORBIS__no_error) {
+        return VORBIS_ERROR_STREAM_END;
+    } else if (stb_error == VORBIS_invalid_packet
+            || stb_error == VORBIS_continued_packet_flag_invalid
+            || stb_error == VORBIS_wrong_page_number) {
+        return VORBIS_ERROR_DECODE_RECOVERED;
+    } else if (stb_error != VORBIS__no_error) {
+        return VORBIS_ERROR_DECODE_FAILED;
+    } else {
+        return VORBIS_NO_ERROR;
+    }
+}
+
+/*************************************************************************/
+/************************** Interface routines ***************************/
+/*************************************************************************/
+
+int decode_buf_sample_size(const vorbis_t *handle)
+{
+    if (handle->read_int16_only) {
+        return 2;
+    } else if (handle->read_int24_only) {
+        return 3;
+    } else {
+        return 4;  // Either int32 or float.
+    }
+}
+
+/*-----------------------------------------------------------------------*/
+
+vorbis_error_t decode_frame(vorbis_t *handle, const void *packet,
+                            int32_t packet_len)
+{
+    if (handle->link_changed) {
+        return change_format(handle);
+    }
+
+    float **outputs;
+    STBVorbisError stb_error;
+    int samples = get_frame(handle, packet, packet_len, &outputs, &stb_error);
+    const int decoded_samples = samples;
+
+    if (handle->resampler) {
+        handle->frame_pos = resampler_tell(handle->resampler);
+        if (samples > 0) {
+            /* In packet mode, we have no independent knowledge of the
+             * stream position, so the frame is always treated as
+             * continuing from the previous one. */
+            const int64_t in_pos = (handle->packet_mode ? -1 :
+                (int64_t)stb_vorbis_tell_pcm(handle->decoder) - samples);
+            samples = resampler_process(handle->resampler, outputs, samples,
+                                        in_pos, &outputs);
+        } else if (!handle->packet_mode && stb_error == VORBIS__no_error) {
+            samples = resampler_flush(handle->resampler, &outputs);
+        }
+    }
+
+    /* If a chained stream changed format and there's no data left from
+     * the previous link, switch to the new format now. */
+    if (samples == 0 && handle->link_changed) {
+        return change_format(handle);
+    }
 
     if (samples > 0) {
         const int channels = handle->channels;
-        if (handle->read_int16_only) {
+        if (handle->downmix_matrix) {
+            downmix(handle->downmix_buf, outputs, handle->stream_channels,
+                    channels, handle->downmix_matrix, samples);
+            outputs = handle->downmix_buf;
+        }
+        if (handle->read_int16_only && handle->dither_int16) {
+            int16_t *decode_buf = handle->decode_buf;
+            if (channels == 1) {
+                float_to_int16_dither(decode_buf, outputs[0], samples,
+                                      handle->dither_state);
+            } else if (channels == 2) {
+                float_to_int16_dither_interleave_2(
+                    decode_buf, outputs[0], outputs[1], samples,
+                    handle->dither_state);
+            } else {
+                float_to_int16_dither_interleave(
+                    decode_buf, outputs, channels, samples,
+                    handle->dither_state);
+            }
+        } else if (handle->read_int16_only) {
             int16_t *decode_buf = handle->decode_buf;
             if (channels == 1) {
                 float_to_int16(decode_buf, outputs[0], samples);
@@ -133,6 +459,28 @@ vorbis_error_t decode_frame(vorbis_t *handle, const void *packet,
                 float_to_int16_interleave(decode_buf, outputs, channels,
                                           samples);
             }
+        } else if (handle->read_int24_only) {
+            uint8_t *decode_buf = handle->decode_buf;
+            if (channels == 1) {
+                float_to_int24(decode_buf, outputs[0], samples);
+            } else if (channels == 2) {
+                float_to_int24_interleave_2(decode_buf, outputs[0],
+                                            outputs[1], samples);
+            } else {
+                float_to_int24_interleave(decode_buf, outputs, channels,
+                                          samples);
+            }
+        } else if (handle->read_int32_only) {
+            int32_t *decode_buf = handle->decode_buf;
+            if (channels == 1) {
+                float_to_int32(decode_buf, outputs[0], samples);
+            } else if (channels == 2) {
+                float_to_int32_interleave_2(decode_buf, outputs[0],
+                                            outputs[1], samples);
+            } else {
+                float_to_int32_interleave(decode_buf, outputs, channels,
+                                          samples);
+            }
         } else {
             float *decode_buf = handle->decode_buf;
             if (channels == 1) {
@@ -146,18 +494,36 @@ vorbis_error_t decode_frame(vorbis_t *handle, const void *packet,
     }
     handle->decode_buf_len = samples;
 
-    const STBVorbisError stb_error = stb_vorbis_get_error(handle->decoder);
-    if (samples == 0 && stb_error == VORBIS__no_error) {
-        return VORBIS_ERROR_STREAM_END;
-    } else if (stb_error == VORBIS_invalid_packet
-            || stb_error == VORBIS_continued_packet_flag_invalid
-            || stb_error == VORBIS_wrong_page_number) {
-        return VORBIS_ERROR_DECODE_RECOVERED;
-    } else if (stb_error != VORBIS__no_error) {
-        return VORBIS_ERROR_DECODE_FAILED;
-    } else {
-        return VORBIS_NO_ERROR;
+    return frame_result(decoded_samples + samples, stb_error);
+}
+
+/*-----------------------------------------------------------------------*/
+
+vorbis_error_t decode_frame_planar(vorbis_t *handle, float ***outputs_ret,
+                                   int *samples_ret)
+{
+    ASSERT(!handle->packet_mode);
+    ASSERT(!handle->resampler);
+    ASSERT(!handle->downmix_matrix);
+
+    /* A change in the audio format of a chained stream ends planar
+     * decoding; the new format is applied by the next decode_frame(). */
+    if (handle->link_changed) {
+        *samples_ret = 0;
+        return VORBIS_ERROR_STREAM_CHANGED;
+    }
+
+    STBVorbisError stb_error;
+    const int samples = get_frame(handle, NULL, 0, outputs_ret, &stb_error);
+    /* The data is never stored in decode_buf, but we record its length
+     * so that the sample position is tracked as if it had been read. */
+    handle->decode_buf_len = samples;
+    handle->decode_buf_pos = samples;
+    *samples_ret = samples;
+    if (samples == 0 && handle->link_changed) {
+        return VORBIS_ERROR_STREAM_CHANGED;
     }
+    return frame_result(samples, stb_error);
 }
 
 /*************************************************************************/
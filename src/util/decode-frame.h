@@ -13,6 +13,20 @@
 /*************************************************************************/
 /*************************************************************************/
 
+/**
+ * decode_buf_sample_size:  Return the size of a single sample in the
+ * handle's decode buffer, in bytes.  This depends on which (if any) of
+ * the VORBIS_OPTION_READ_*_ONLY options was given when the handle was
+ * opened.
+ *
+ * [Parameters]
+ *     handle: Handle to operate on.
+ * [Return value]
+ *     Size of one sample, in bytes.
+ */
+#define decode_buf_sample_size INTERNAL(decode_buf_sample_size)
+extern int decode_buf_sample_size(const vorbis_t *handle);
+
 /**
  * decode_frame:  Decode the next frame from the stream (or the given
  * packet, for a packet-mode decoder) and store the decoded data in
@@ -34,6 +48,30 @@
 extern vorbis_error_t decode_frame(vorbis_t *handle, const void *packet,
                                    int32_t packet_len);
 
+/**
+ * decode_frame_planar:  Decode the next frame from the stream and return
+ * the decoder's planar output buffers directly, without storing anything
+ * in decode_buf.  The decoded samples are treated as already consumed for
+ * the purposes of tracking the stream position.
+ *
+ * This function may only be called for non-packet-mode decoders with no
+ * resampling or downmixing configured.
+ *
+ * [Parameters]
+ *     handle: Handle to operate on.
+ *     outputs_ret: Pointer to variable to receive the output buffer array
+ *         (one buffer per channel).  The data remains valid until the next
+ *         decode operation.
+ *     samples_ret: Pointer to variable to receive the number of samples
+ *         per channel decoded.
+ * [Return value]
+ *     Result of the operation (VORBIS_NO_ERROR or a VORBIS_ERROR_* code).
+ */
+#define decode_frame_planar INTERNAL(decode_frame_planar)
+extern vorbis_error_t decode_frame_planar(vorbis_t *handle,
+                                          float ***outputs_ret,
+                                          int *samples_ret);
+
 /*************************************************************************/
 /*************************************************************************/
 
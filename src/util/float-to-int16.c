@@ -18,6 +18,153 @@
 # include <arm_neon.h>
 #endif
 
+/*************************************************************************/
+/**************************** Helper routines ****************************/
+/*************************************************************************/
+
+/**
+ * dither_next:  Advance a single lane of the dither pseudorandom generator
+ * and return the new value.  The generator is a simple 32-bit xorshift,
+ * which is more than random enough for dither noise and is trivially
+ * vectorizable.
+ *
+ * [Parameters]
+ *     state: Pointer to generator state for the lane.
+ * [Return value]
+ *     Next pseudorandom value.
+ */
+static inline uint32_t dither_next(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * dither_noise:  Convert a pseudorandom value to a TPDF noise value in
+ * the range (-1,+1).  The two 16-bit halves of the value are treated as
+ * independent uniform variables, and their difference has a triangular
+ * distribution.
+ *
+ * [Parameters]
+ *     random: Pseudorandom value.
+ * [Return value]
+ *     Noise value, in LSBs of 16-bit output.
+ */
+static inline float dither_noise(uint32_t random)
+{
+    return (float)((int32_t)(random & 0xFFFF) - (int32_t)(random >> 16))
+        * (1.0f / 65536.0f);
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * dither_convert:  Convert a single sample to 16-bit integer format with
+ * the given dither noise.
+ *
+ * [Parameters]
+ *     sample: Sample to convert.
+ *     noise: Dither noise, in LSBs of 16-bit output.
+ * [Return value]
+ *     Converted sample.
+ */
+static inline int16_t dither_convert(float sample, float noise)
+{
+    if (UNLIKELY(sample < -1.0f)) {
+        return -32767;
+    } else if (LIKELY(sample <= 1.0f)) {
+        const float value = roundf(sample * 32767.0f + noise);
+        return (int16_t)(value < -32767.0f ? -32767.0f :
+                         value > 32767.0f ? 32767.0f : value);
+    } else {
+        return 32767;
+    }
+}
+
+/*-----------------------------------------------------------------------*/
+
+#if defined(ENABLE_ASM_ARM_NEON)
+
+/**
+ * dither_noise_neon:  Advance four lanes of the dither pseudorandom
+ * generator and return the corresponding noise values.
+ *
+ * [Parameters]
+ *     state: Pointer to generator state vector.
+ * [Return value]
+ *     Noise values, in LSBs of 16-bit output.
+ */
+static inline float32x4_t dither_noise_neon(uint32x4_t *state)
+{
+    const uint32x4_t kFFFF = {0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF};
+    const float32x4_t k1_65536 = {1.0f/65536.0f, 1.0f/65536.0f,
+                                  1.0f/65536.0f, 1.0f/65536.0f};
+    uint32x4_t x = *state;
+    x = veorq_u32(x, vshlq_n_u32(x, 13));
+    x = veorq_u32(x, vshrq_n_u32(x, 17));
+    x = veorq_u32(x, vshlq_n_u32(x, 5));
+    *state = x;
+    const int32x4_t diff = vsubq_s32((int32x4_t)vandq_u32(x, kFFFF),
+                                     (int32x4_t)vshrq_n_u32(x, 16));
+    return vmulq_f32(vcvtq_f32_s32(diff), k1_65536);
+}
+
+#elif defined(ENABLE_ASM_X86_AVX2)
+
+/**
+ * dither_noise_avx2:  Advance eight lanes of the dither pseudorandom
+ * generator and return the corresponding noise values.
+ *
+ * [Parameters]
+ *     state: Pointer to generator state vector.
+ * [Return value]
+ *     Noise values, in LSBs of 16-bit output.
+ */
+static inline __m256 dither_noise_avx2(__m256i *state)
+{
+    __m256i x = *state;
+    x = _mm256_xor_si256(x, _mm256_slli_epi32(x, 13));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 17));
+    x = _mm256_xor_si256(x, _mm256_slli_epi32(x, 5));
+    *state = x;
+    const __m256i diff = _mm256_sub_epi32(
+        _mm256_and_si256(x, _mm256_set1_epi32(0xFFFF)),
+        _mm256_srli_epi32(x, 16));
+    return _mm256_mul_ps(_mm256_cvtepi32_ps(diff),
+                         _mm256_set1_ps(1.0f / 65536.0f));
+}
+
+#elif defined(ENABLE_ASM_X86_SSE2)
+
+/**
+ * dither_noise_sse2:  Advance four lanes of the dither pseudorandom
+ * generator and return the corresponding noise values.
+ *
+ * [Parameters]
+ *     state: Pointer to generator state vector.
+ * [Return value]
+ *     Noise values, in LSBs of 16-bit output.
+ */
+static inline __m128 dither_noise_sse2(__m128i *state)
+{
+    __m128i x = *state;
+    x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+    x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+    *state = x;
+    const __m128i diff = _mm_sub_epi32(
+        _mm_and_si128(x, _mm_set1_epi32(0xFFFF)), _mm_srli_epi32(x, 16));
+    return _mm_mul_ps(_mm_cvtepi32_ps(diff), _mm_set1_ps(1.0f / 65536.0f));
+}
+
+#endif  // ENABLE_ASM_*
+
 /*************************************************************************/
 /************************** Interface routines ***************************/
 /*************************************************************************/
@@ -369,5 +516,300 @@ void float_to_int16_interleave_2(
     }
 }
 
+/*-----------------------------------------------------------------------*/
+
+void dither_init(uint32_t *state)
+{
+    /* Any nonzero seeds will do; we just need the lanes to differ. */
+    for (int i = 0; i < DITHER_STATE_SIZE; i++) {
+        state[i] = 0x9E3779B9u * (uint32_t)(i + 1);
+    }
+}
+
+/*-----------------------------------------------------------------------*/
+
+void float_to_int16_dither(
+    int16_t *__restrict dest, const float *__restrict src, int count,
+    uint32_t *state)
+{
+#if defined(ENABLE_ASM_ARM_NEON)
+
+    const float32x4_t k32767 = {32767, 32767, 32767, 32767};
+    const float32x4_t k0_5 = {0.5, 0.5, 0.5, 0.5};
+    const uint32x4_t k7FFFFFFF = {0x7FFFFFFF, 0x7FFFFFFF,
+                                  0x7FFFFFFF, 0x7FFFFFFF};
+    uint32x4_t state0 = vld1q_u32(state);
+    uint32x4_t state1 = vld1q_u32(state + 4);
+    for (; count >= 8; src += 8, dest += 8, count -= 8) {
+        const float32x4_t in0 = vld1q_f32(src);
+        const float32x4_t in1 = vld1q_f32(src + 4);
+        const float32x4_t in0_scaled = vmlaq_f32(dither_noise_neon(&state0),
+                                                 in0, k32767);
+        const float32x4_t in1_scaled = vmlaq_f32(dither_noise_neon(&state1),
+                                                 in1, k32767);
+        const uint32x4_t in0_abs = vandq_u32((uint32x4_t)in0_scaled,
+                                             k7FFFFFFF);
+        const uint32x4_t in1_abs = vandq_u32((uint32x4_t)in1_scaled,
+                                             k7FFFFFFF);
+        const uint32x4_t in0_sign = vbicq_u32((uint32x4_t)in0_scaled,
+                                              k7FFFFFFF);
+        const uint32x4_t in1_sign = vbicq_u32((uint32x4_t)in1_scaled,
+                                              k7FFFFFFF);
+        const uint32x4_t in0_sat = vminq_u32(in0_abs, (uint32x4_t)k32767);
+        const uint32x4_t in1_sat = vminq_u32(in1_abs, (uint32x4_t)k32767);
+        const float32x4_t in0_adj = vaddq_f32((float32x4_t)in0_sat, k0_5);
+        const float32x4_t in1_adj = vaddq_f32((float32x4_t)in1_sat, k0_5);
+        const float32x4_t out0 = (float32x4_t)vorrq_u32((uint32x4_t)in0_adj,
+                                                        in0_sign);
+        const float32x4_t out1 = (float32x4_t)vorrq_u32((uint32x4_t)in1_adj,
+                                                        in1_sign);
+        const int16x4_t out0_16 = vqmovn_s32(vcvtq_s32_f32(out0));
+        const int16x4_t out1_16 = vqmovn_s32(vcvtq_s32_f32(out1));
+        vst1q_s16(dest, vcombine_s16(out0_16, out1_16));
+    }
+    vst1q_u32(state, state0);
+    vst1q_u32(state + 4, state1);
+
+#elif defined(ENABLE_ASM_X86_AVX2)
+
+    const uint32_t saved_mxcsr = _mm_getcsr();
+    uint32_t mxcsr = saved_mxcsr;
+    mxcsr &= ~(3<<13);  // RC (00 = round to nearest)
+    mxcsr |= 1<<7;      // EM_INVALID
+    _mm_setcsr(mxcsr);
+
+    const __m256 k32767 = _mm256_set1_ps(32767.0f);
+    const __m256 k7FFFFFFF = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    const __m256 k80000000 = _mm256_castsi256_ps(_mm256_set1_epi32(0x80000000));
+    __m256i random = _mm256_loadu_si256((const void *)state);
+
+    for (; count >= 16; src += 16, dest += 16, count -= 16) {
+        const __m256 in0 = _mm256_loadu_ps(src);
+        const __m256 in1 = _mm256_loadu_ps(src+8);
+        const __m256 in0_scaled =
+            _mm256_fmadd_ps(in0, k32767, dither_noise_avx2(&random));
+        const __m256 in1_scaled =
+            _mm256_fmadd_ps(in1, k32767, dither_noise_avx2(&random));
+        const __m256 in0_abs = _mm256_and_ps(in0_scaled, k7FFFFFFF);
+        const __m256 in1_abs = _mm256_and_ps(in1_scaled, k7FFFFFFF);
+        const __m256 in0_sign = _mm256_and_ps(in0_scaled, k80000000);
+        const __m256 in1_sign = _mm256_and_ps(in1_scaled, k80000000);
+        const __m256 in0_sat = _mm256_min_ps(in0_abs, k32767);
+        const __m256 in1_sat = _mm256_min_ps(in1_abs, k32767);
+        const __m256 out0 = _mm256_or_ps(in0_sat, in0_sign);
+        const __m256 out1 = _mm256_or_ps(in1_sat, in1_sign);
+        const __m256i out0_32 = _mm256_cvtps_epi32(out0);
+        const __m256i out1_32 = _mm256_cvtps_epi32(out1);
+        const __m256i out_16_0213 = _mm256_packs_epi32(out0_32, out1_32);
+        const __m256i out_16 =
+            _mm256_permute4x64_epi64(out_16_0213, _MM_SHUFFLE(3,1,2,0));
+        _mm256_storeu_si256((void *)dest, out_16);
+    }
+
+    _mm256_storeu_si256((void *)state, random);
+    _mm_setcsr(saved_mxcsr);
+
+#elif defined(ENABLE_ASM_X86_SSE2)
+
+    const uint32_t saved_mxcsr = _mm_getcsr();
+    uint32_t mxcsr = saved_mxcsr;
+    mxcsr &= ~(3<<13);  // RC (00 = round to nearest)
+    mxcsr |= 1<<7;      // EM_INVALID
+    _mm_setcsr(mxcsr);
+
+    const __m128 k32767 = _mm_set1_ps(32767.0f);
+    const __m128 k7FFFFFFF = CAST_M128(_mm_set1_epi32(0x7FFFFFFF));
+    const __m128 k80000000 = CAST_M128(_mm_set1_epi32(0x80000000));
+    __m128i random0 = _mm_loadu_si128((const void *)state);
+    __m128i random1 = _mm_loadu_si128((const void *)(state + 4));
+
+    for (; count >= 8; src += 8, dest += 8, count -= 8) {
+        const __m128 in0 = _mm_loadu_ps(src);
+        const __m128 in1 = _mm_loadu_ps(src+4);
+        const __m128 in0_scaled = _mm_add_ps(_mm_mul_ps(in0, k32767),
+                                             dither_noise_sse2(&random0));
+        const __m128 in1_scaled = _mm_add_ps(_mm_mul_ps(in1, k32767),
+                                             dither_noise_sse2(&random1));
+        const __m128 in0_abs = _mm_and_ps(in0_scaled, k7FFFFFFF);
+        const __m128 in1_abs = _mm_and_ps(in1_scaled, k7FFFFFFF);
+        const __m128 in0_sign = _mm_and_ps(in0_scaled, k80000000);
+        const __m128 in1_sign = _mm_and_ps(in1_scaled, k80000000);
+        const __m128 in0_sat = _mm_min_ps(in0_abs, k32767);
+        const __m128 in1_sat = _mm_min_ps(in1_abs, k32767);
+        const __m128 out0 = _mm_or_ps(in0_sat, in0_sign);
+        const __m128 out1 = _mm_or_ps(in1_sat, in1_sign);
+        const __m128i out0_32 = _mm_cvtps_epi32(out0);
+        const __m128i out1_32 = _mm_cvtps_epi32(out1);
+        const __m128i out_16 = _mm_packs_epi32(out0_32, out1_32);
+        _mm_storeu_si128((void *)dest, out_16);
+    }
+
+    _mm_storeu_si128((void *)state, random0);
+    _mm_storeu_si128((void *)(state + 4), random1);
+    _mm_setcsr(saved_mxcsr);
+
+#endif  // ENABLE_ASM_*
+
+    for (int i = 0; i < count; i++) {
+        dest[i] = dither_convert(src[i], dither_noise(dither_next(&state[0])));
+    }
+}
+
+/*-----------------------------------------------------------------------*/
+
+void float_to_int16_dither_interleave(
+    int16_t *dest, float **src, int channels, int count, uint32_t *state)
+{
+    uint32_t random = state[0];
+    for (int i = 0; i < count; i++) {
+        for (int c = 0; c < channels; c++, dest++) {
+            *dest = dither_convert(src[c][i],
+                                   dither_noise(dither_next(&random)));
+        }
+    }
+    state[0] = random;
+}
+
+/*-----------------------------------------------------------------------*/
+
+void float_to_int16_dither_interleave_2(
+    int16_t *__restrict dest, const float *__restrict src0,
+    const float *__restrict src1, int count, uint32_t *state)
+{
+#if defined(ENABLE_ASM_ARM_NEON)
+
+    const float32x4_t k32767 = {32767, 32767, 32767, 32767};
+    const float32x4_t k0_5 = {0.5, 0.5, 0.5, 0.5};
+    const uint32x4_t k7FFFFFFF = {0x7FFFFFFF, 0x7FFFFFFF,
+                                  0x7FFFFFFF, 0x7FFFFFFF};
+    uint32x4_t state0 = vld1q_u32(state);
+    uint32x4_t state1 = vld1q_u32(state + 4);
+    for (; count >= 4; src0 += 4, src1 += 4, dest += 8, count -= 4) {
+        const float32x4_t in0 = vld1q_f32(src0);
+        const float32x4_t in1 = vld1q_f32(src1);
+        const float32x4_t in0_scaled = vmlaq_f32(dither_noise_neon(&state0),
+                                                 in0, k32767);
+        const float32x4_t in1_scaled = vmlaq_f32(dither_noise_neon(&state1),
+                                                 in1, k32767);
+        const uint32x4_t in0_abs = vandq_u32((uint32x4_t)in0_scaled,
+                                             k7FFFFFFF);
+        const uint32x4_t in1_abs = vandq_u32((uint32x4_t)in1_scaled,
+                                             k7FFFFFFF);
+        const uint32x4_t in0_sign = vbicq_u32((uint32x4_t)in0_scaled,
+                                              k7FFFFFFF);
+        const uint32x4_t in1_sign = vbicq_u32((uint32x4_t)in1_scaled,
+                                              k7FFFFFFF);
+        const uint32x4_t in0_sat = vminq_u32(in0_abs, (uint32x4_t)k32767);
+        const uint32x4_t in1_sat = vminq_u32(in1_abs, (uint32x4_t)k32767);
+        const float32x4_t in0_adj = vaddq_f32((float32x4_t)in0_sat, k0_5);
+        const float32x4_t in1_adj = vaddq_f32((float32x4_t)in1_sat, k0_5);
+        const float32x4_t out0 = (float32x4_t)vorrq_u32((uint32x4_t)in0_adj,
+                                                        in0_sign);
+        const float32x4_t out1 = (float32x4_t)vorrq_u32((uint32x4_t)in1_adj,
+                                                        in1_sign);
+        const int32x4_t out0_32 = vcvtq_s32_f32(out0);
+        const int32x4_t out1_32 = vcvtq_s32_f32(out1);
+        int32x4x2_t out_32 = vzipq_s32(out0_32, out1_32);
+        const int16x4_t out0_16 = vqmovn_s32(out_32.val[0]);
+        const int16x4_t out1_16 = vqmovn_s32(out_32.val[1]);
+        vst1q_s16(dest, vcombine_s16(out0_16, out1_16));
+    }
+    vst1q_u32(state, state0);
+    vst1q_u32(state + 4, state1);
+
+#elif defined(ENABLE_ASM_X86_AVX2)
+
+    ASSERT((((uintptr_t)src0 | (uintptr_t)src1 | (uintptr_t)dest) & 31) == 0);
+
+    const uint32_t saved_mxcsr = _mm_getcsr();
+    uint32_t mxcsr = saved_mxcsr;
+    mxcsr &= ~(3<<13);  // RC (00 = round to nearest)
+    mxcsr |= 1<<7;      // EM_INVALID
+    _mm_setcsr(mxcsr);
+
+    const __m256 k32767 = _mm256_set1_ps(32767.0f);
+    const __m256 k7FFFFFFF = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    const __m256 k80000000 = _mm256_castsi256_ps(_mm256_set1_epi32(0x80000000));
+    __m256i random = _mm256_loadu_si256((const void *)state);
+
+    for (; count >= 8; src0 += 8, src1 += 8, dest += 16, count -= 8) {
+        const __m256 in0 = _mm256_load_ps(src0);
+        const __m256 in1 = _mm256_load_ps(src1);
+        const __m256 in0_scaled =
+            _mm256_fmadd_ps(in0, k32767, dither_noise_avx2(&random));
+        const __m256 in1_scaled =
+            _mm256_fmadd_ps(in1, k32767, dither_noise_avx2(&random));
+        const __m256 in0_abs = _mm256_and_ps(in0_scaled, k7FFFFFFF);
+        const __m256 in1_abs = _mm256_and_ps(in1_scaled, k7FFFFFFF);
+        const __m256 in0_sign = _mm256_and_ps(in0_scaled, k80000000);
+        const __m256 in1_sign = _mm256_and_ps(in1_scaled, k80000000);
+        const __m256 in0_sat = _mm256_min_ps(in0_abs, k32767);
+        const __m256 in1_sat = _mm256_min_ps(in1_abs, k32767);
+        const __m256 out0 = _mm256_or_ps(in0_sat, in0_sign);
+        const __m256 out1 = _mm256_or_ps(in1_sat, in1_sign);
+        const __m256i out0_32 = _mm256_cvtps_epi32(out0);
+        const __m256i out1_32 = _mm256_cvtps_epi32(out1);
+        const __m256i out_32_lo = _mm256_unpacklo_epi32(out0_32, out1_32);
+        const __m256i out_32_hi = _mm256_unpackhi_epi32(out0_32, out1_32);
+        const __m256i out_16 = _mm256_packs_epi32(out_32_lo, out_32_hi);
+        _mm256_store_si256((void *)dest, out_16);
+    }
+
+    _mm256_storeu_si256((void *)state, random);
+    _mm_setcsr(saved_mxcsr);
+
+#elif defined(ENABLE_ASM_X86_SSE2)
+
+    ASSERT((((uintptr_t)src0 | (uintptr_t)src1 | (uintptr_t)dest) & 15) == 0);
+
+    const uint32_t saved_mxcsr = _mm_getcsr();
+    uint32_t mxcsr = saved_mxcsr;
+    mxcsr &= ~(3<<13);  // RC (00 = round to nearest)
+    mxcsr |= 1<<7;      // EM_INVALID
+    _mm_setcsr(mxcsr);
+
+    const __m128 k32767 = _mm_set1_ps(32767.0f);
+    const __m128 k7FFFFFFF = CAST_M128(_mm_set1_epi32(0x7FFFFFFF));
+    const __m128 k80000000 = CAST_M128(_mm_set1_epi32(0x80000000));
+    __m128i random0 = _mm_loadu_si128((const void *)state);
+    __m128i random1 = _mm_loadu_si128((const void *)(state + 4));
+
+    for (; count >= 4; src0 += 4, src1 += 4, dest += 8, count -= 4) {
+        const __m128 in0 = _mm_load_ps(src0);
+        const __m128 in1 = _mm_load_ps(src1);
+        const __m128 in0_scaled = _mm_add_ps(_mm_mul_ps(in0, k32767),
+                                             dither_noise_sse2(&random0));
+        const __m128 in1_scaled = _mm_add_ps(_mm_mul_ps(in1, k32767),
+                                             dither_noise_sse2(&random1));
+        const __m128 in0_abs = _mm_and_ps(in0_scaled, k7FFFFFFF);
+        const __m128 in1_abs = _mm_and_ps(in1_scaled, k7FFFFFFF);
+        const __m128 in0_sign = _mm_and_ps(in0_scaled, k80000000);
+        const __m128 in1_sign = _mm_and_ps(in1_scaled, k80000000);
+        const __m128 in0_sat = _mm_min_ps(in0_abs, k32767);
+        const __m128 in1_sat = _mm_min_ps(in1_abs, k32767);
+        const __m128 out0 = _mm_or_ps(in0_sat, in0_sign);
+        const __m128 out1 = _mm_or_ps(in1_sat, in1_sign);
+        const __m128i out0_32 = _mm_cvtps_epi32(out0);
+        const __m128i out1_32 = _mm_cvtps_epi32(out1);
+        const __m128i out_32_lo = _mm_unpacklo_epi32(out0_32, out1_32);
+        const __m128i out_32_hi = _mm_unpackhi_epi32(out0_32, out1_32);
+        const __m128i out_16 = _mm_packs_epi32(out_32_lo, out_32_hi);
+        _mm_store_si128((void *)dest, out_16);
+    }
+
+    _mm_storeu_si128((void *)state, random0);
+    _mm_storeu_si128((void *)(state + 4), random1);
+    _mm_setcsr(saved_mxcsr);
+
+#endif  // ENABLE_ASM_*
+
+    for (int i = 0; i < count; i++) {
+        dest[i*2+0] = dither_convert(src0[i],
+                                     dither_noise(dither_next(&state[0])));
+        dest[i*2+1] = dither_convert(src1[i],
+                                     dither_noise(dither_next(&state[0])));
+    }
+}
+
 /*************************************************************************/
 /*************************************************************************/
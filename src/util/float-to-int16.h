@@ -59,6 +59,72 @@ extern void float_to_int16_interleave_2(
     int16_t *__restrict dest, const float *__restrict src0,
     const float *__restrict src1, int count);
 
+/**
+ * dither_init:  Initialize pseudorandom generator state for the
+ * float_to_int16_dither*() functions.  The size of the state array is
+ * given by DITHER_STATE_SIZE, defined in src/common.h.
+ *
+ * [Parameters]
+ *     state: Generator state array (DITHER_STATE_SIZE elements).
+ */
+#define dither_init INTERNAL(dither_init)
+extern void dither_init(uint32_t *state);
+
+/**
+ * float_to_int16_dither:  Convert floating-point data in 'src' to 16-bit
+ * integer data in 'dest', adding triangular (TPDF) dither noise with an
+ * amplitude of +/-1 LSB before rounding.
+ *
+ * [Parameters]
+ *     dest: Destination (int16) buffer pointer.
+ *     src: Source (float) buffer pointer.
+ *     count: Number of values to convert.
+ *     state: Generator state array (DITHER_STATE_SIZE elements).
+ */
+#define float_to_int16_dither INTERNAL(float_to_int16_dither)
+extern void float_to_int16_dither(
+    int16_t *__restrict dest, const float *__restrict src, int count,
+    uint32_t *state);
+
+/**
+ * float_to_int16_dither_interleave:  Convert multiple channels of
+ * floating-point data in 'src' to interleaved 16-bit integer data in
+ * 'dest', adding TPDF dither noise as for float_to_int16_dither().
+ *
+ * [Parameters]
+ *     dest: Destination (int16) buffer pointer.
+ *     src: Source (float) buffer array.
+ *     channels: Number of source channels.
+ *     count: Number of values to convert per channel.
+ *     state: Generator state array (DITHER_STATE_SIZE elements).
+ */
+#define float_to_int16_dither_interleave \
+    INTERNAL(float_to_int16_dither_interleave)
+extern void float_to_int16_dither_interleave(
+    int16_t *dest, float **src, int channels, int count, uint32_t *state);
+
+/**
+ * float_to_int16_dither_interleave_2:  Convert two channels of
+ * floating-point data in 'src' to interleaved 16-bit integer data in
+ * 'dest', adding TPDF dither noise as for float_to_int16_dither().
+ * Specialization of float_to_int16_dither_interleave() for channels==2.
+ *
+ * The caller guarantees that dest, src0, and src1 are aligned
+ * appropriately for CPU-specific optimized copies.
+ *
+ * [Parameters]
+ *     dest: Destination (int16) buffer pointer.
+ *     src0: Source (float) buffer array for first channel.
+ *     src1: Source (float) buffer array for second channel.
+ *     count: Number of values to convert.
+ *     state: Generator state array (DITHER_STATE_SIZE elements).
+ */
+#define float_to_int16_dither_interleave_2 \
+    INTERNAL(float_to_int16_dither_interleave_2)
+extern void float_to_int16_dither_interleave_2(
+    int16_t *__restrict dest, const float *__restrict src0,
+    const float *__restrict src1, int count, uint32_t *state);
+
 /*************************************************************************/
 /*************************************************************************/
 
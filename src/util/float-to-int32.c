@@ -0,0 +1,535 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "src/common.h"
+#include "src/util/float-to-int32.h"
+#include "src/x86.h"
+
+#include <math.h>
+#include <string.h>
+
+#ifdef ENABLE_ASM_ARM_NEON
+# include <arm_neon.h>
+#endif
+
+/*************************************************************************/
+/**************************** Helper routines ****************************/
+/*************************************************************************/
+
+/**
+ * store_int24:  Store a single 24-bit value in little-endian byte order.
+ *
+ * [Parameters]
+ *     dest: Destination buffer pointer.
+ *     value: Value to store.
+ */
+static inline void store_int24(uint8_t *dest, int32_t value)
+{
+    dest[0] = (uint8_t)value;
+    dest[1] = (uint8_t)(value >> 8);
+    dest[2] = (uint8_t)(value >> 16);
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * convert_int24, convert_int32:  Convert a single floating-point sample
+ * to a 24-bit or 32-bit integer value.
+ *
+ * Both conversions round halfway cases to even to match the SIMD
+ * conversion instructions.  The int32 conversion is performed in double
+ * precision, since 2^31-1 is not representable as a float.
+ *
+ * [Parameters]
+ *     sample: Sample to convert.
+ * [Return value]
+ *     Converted value.
+ */
+static inline int32_t convert_int24(float sample)
+{
+    if (UNLIKELY(sample < -1.0f)) {
+        return -8388607;
+    } else if (LIKELY(sample <= 1.0f)) {
+        return (int32_t)rintf(sample * 8388607.0f);
+    } else {
+        return 8388607;
+    }
+}
+
+static inline int32_t convert_int32(float sample)
+{
+    if (UNLIKELY(sample <= -1.0f)) {
+        return -2147483647;
+    } else if (LIKELY(sample < 1.0f)) {
+        return (int32_t)rint(sample * 2147483647.0);
+    } else {
+        return 2147483647;
+    }
+}
+
+/*-----------------------------------------------------------------------*/
+
+#if defined(ENABLE_ASM_ARM_NEON)
+
+/**
+ * pack_int24_neon:  Store four 32-bit values (which must be in the range
+ * of a 24-bit signed integer) as 12 bytes of packed little-endian 24-bit
+ * data.
+ *
+ * [Parameters]
+ *     dest: Destination buffer pointer.
+ *     value: Values to store.
+ */
+static inline void pack_int24_neon(uint8_t *dest, int32x4_t value)
+{
+    const uint64x2_t kLowWord = {0xFFFFFF, 0xFFFFFF};
+    const uint64x2_t kHighWord = {UINT64_C(0xFFFFFF) << 32,
+                                  UINT64_C(0xFFFFFF) << 32};
+    /* Merge each pair of values into the low 6 bytes of a 64-bit lane,
+     * then merge the two lanes into the low 12 bytes of the vector. */
+    const uint64x2_t value_64 = (uint64x2_t)value;
+    const uint64x2_t pair = vorrq_u64(
+        vandq_u64(value_64, kLowWord),
+        vshrq_n_u64(vandq_u64(value_64, kHighWord), 8));
+    const uint8x16_t pair_8 = (uint8x16_t)pair;
+    const uint8x16_t low = vandq_u8(
+        pair_8, vcombine_u8(vcreate_u8(UINT64_C(0xFFFFFFFFFFFF)),
+                            vcreate_u8(0)));
+    const uint8x16_t high = vcombine_u8(vcreate_u8(0), vget_high_u8(pair_8));
+    const uint8x16_t packed = vorrq_u8(low, vextq_u8(high, vdupq_n_u8(0), 2));
+    vst1_u8(dest, vget_low_u8(packed));
+    vst1q_lane_u32((uint32_t *)(void *)(dest + 8), (uint32x4_t)packed, 2);
+}
+
+/**
+ * int24_neon:  Convert four floating-point samples to 24-bit integer
+ * values (stored in 32-bit lanes).
+ *
+ * [Parameters]
+ *     in: Samples to convert.
+ * [Return value]
+ *     Converted values.
+ */
+static inline int32x4_t int24_neon(float32x4_t in)
+{
+    const float32x4_t k8388607 = {8388607, 8388607, 8388607, 8388607};
+    const float32x4_t k8388608 = {8388608, 8388608, 8388608, 8388608};
+    const uint32x4_t k7FFFFFFF = {0x7FFFFFFF, 0x7FFFFFFF,
+                                  0x7FFFFFFF, 0x7FFFFFFF};
+    const float32x4_t scaled = vmulq_f32(in, k8388607);
+    const uint32x4_t abs = vandq_u32((uint32x4_t)scaled, k7FFFFFFF);
+    const uint32x4_t sign = vbicq_u32((uint32x4_t)scaled, k7FFFFFFF);
+    const uint32x4_t sat = vminq_u32(abs, (uint32x4_t)k8388607);
+    /* vcvt rounds toward zero, so round the absolute values to integers
+     * first by pushing them into [2^23,2^24), where the float spacing is
+     * exactly 1; this rounds halfway cases to even like the other paths. */
+    const float32x4_t rounded = vsubq_f32(
+        vaddq_f32((float32x4_t)sat, k8388608), k8388608);
+    return vcvtq_s32_f32((float32x4_t)vorrq_u32((uint32x4_t)rounded, sign));
+}
+
+# if defined(__aarch64__)
+
+/**
+ * int32_neon:  Convert four floating-point samples to 32-bit integer
+ * values.  Only available on AArch64, which has double-precision vector
+ * arithmetic.
+ *
+ * [Parameters]
+ *     in: Samples to convert.
+ * [Return value]
+ *     Converted values.
+ */
+static inline int32x4_t int32_neon(float32x4_t in)
+{
+    const float64x2_t kMax = vdupq_n_f64(2147483647.0);
+    const float64x2_t kMin = vdupq_n_f64(-2147483647.0);
+    /* vminnm/vmaxnm return the non-NaN operand, so NaNs saturate to the
+     * maximum as in the scalar code. */
+    const float64x2_t lo = vmaxnmq_f64(vminnmq_f64(
+        vmulq_f64(vcvt_f64_f32(vget_low_f32(in)), kMax), kMax), kMin);
+    const float64x2_t hi = vmaxnmq_f64(vminnmq_f64(
+        vmulq_f64(vcvt_high_f64_f32(in), kMax), kMax), kMin);
+    return vcombine_s32(vmovn_s64(vcvtnq_s64_f64(lo)),
+                        vmovn_s64(vcvtnq_s64_f64(hi)));
+}
+
+# endif  // __aarch64__
+
+#elif defined(ENABLE_ASM_X86_SSE2)  // Also used by the AVX2 code.
+
+/**
+ * set_round_nearest:  Set the SSE rounding mode to round-to-nearest and
+ * mask invalid-operation exceptions, returning the previous MXCSR value
+ * so it can be restored with _mm_setcsr() when conversion is complete.
+ *
+ * [Return value]
+ *     Previous value of MXCSR.
+ */
+static inline uint32_t set_round_nearest(void)
+{
+    const uint32_t saved_mxcsr = _mm_getcsr();
+    uint32_t mxcsr = saved_mxcsr;
+    mxcsr &= ~(3<<13);  // RC (00 = round to nearest)
+    mxcsr |= 1<<7;      // EM_INVALID
+    _mm_setcsr(mxcsr);
+    return saved_mxcsr;
+}
+
+# if defined(ENABLE_ASM_X86_AVX2)
+
+/**
+ * pack_int24_avx2:  Store eight 32-bit values (which must be in the range
+ * of a 24-bit signed integer) as 24 bytes of packed little-endian 24-bit
+ * data.
+ *
+ * [Parameters]
+ *     dest: Destination buffer pointer.
+ *     value: Values to store.
+ */
+static inline void pack_int24_avx2(uint8_t *dest, __m256i value)
+{
+    /* Squeeze out the high byte of each value within each 128-bit lane,
+     * then move the 12 bytes from each lane together. */
+    const __m256i shuffle = _mm256_setr_epi8(
+        0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+        0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    const __m256i packed_lanes = _mm256_shuffle_epi8(value, shuffle);
+    const __m256i packed = _mm256_permutevar8x32_epi32(
+        packed_lanes, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+    _mm256_maskstore_epi32((void *)dest,
+                           _mm256_setr_epi32(-1, -1, -1, -1, -1, -1, 0, 0),
+                           packed);
+}
+
+/**
+ * int24_avx2:  Convert eight floating-point samples to 24-bit integer
+ * values (stored in 32-bit lanes).  The rounding mode must have been set
+ * with set_round_nearest().
+ *
+ * [Parameters]
+ *     in: Samples to convert.
+ * [Return value]
+ *     Converted values.
+ */
+static inline __m256i int24_avx2(__m256 in)
+{
+    const __m256 k8388607 = _mm256_set1_ps(8388607.0f);
+    const __m256 k7FFFFFFF = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    const __m256 k80000000 = _mm256_castsi256_ps(_mm256_set1_epi32(0x80000000));
+    const __m256 scaled = _mm256_mul_ps(in, k8388607);
+    const __m256 abs = _mm256_and_ps(scaled, k7FFFFFFF);
+    const __m256 sign = _mm256_and_ps(scaled, k80000000);
+    const __m256 sat = _mm256_min_ps(abs, k8388607);
+    return _mm256_cvtps_epi32(_mm256_or_ps(sat, sign));
+}
+
+/**
+ * int32_avx2:  Convert eight floating-point samples to 32-bit integer
+ * values.  The rounding mode must have been set with set_round_nearest().
+ *
+ * [Parameters]
+ *     in: Samples to convert.
+ * [Return value]
+ *     Converted values.
+ */
+static inline __m256i int32_avx2(__m256 in)
+{
+    const __m256d kMax = _mm256_set1_pd(2147483647.0);
+    const __m256d kMin = _mm256_set1_pd(-2147483647.0);
+    /* _mm256_min_pd() returns its second operand if either operand is
+     * NaN, so NaNs saturate to the maximum as in the scalar code. */
+    const __m256d lo = _mm256_max_pd(_mm256_min_pd(_mm256_mul_pd(
+        _mm256_cvtps_pd(_mm256_castps256_ps128(in)), kMax), kMax), kMin);
+    const __m256d hi = _mm256_max_pd(_mm256_min_pd(_mm256_mul_pd(
+        _mm256_cvtps_pd(_mm256_extractf128_ps(in, 1)), kMax), kMax), kMin);
+    return _mm256_inserti128_si256(
+        _mm256_castsi128_si256(_mm256_cvtpd_epi32(lo)),
+        _mm256_cvtpd_epi32(hi), 1);
+}
+
+# endif  // ENABLE_ASM_X86_AVX2
+
+/**
+ * pack_int24_sse2:  Store four 32-bit values (which must be in the range
+ * of a 24-bit signed integer) as 12 bytes of packed little-endian 24-bit
+ * data.
+ *
+ * [Parameters]
+ *     dest: Destination buffer pointer.
+ *     value: Values to store.
+ */
+static inline void pack_int24_sse2(uint8_t *dest, __m128i value)
+{
+    /* SSE2 has no byte shuffle, so merge each pair of values into the
+     * low 6 bytes of a 64-bit lane, then merge the two lanes into the
+     * low 12 bytes of the vector. */
+    const __m128i kLowWord = _mm_set_epi32(0, 0xFFFFFF, 0, 0xFFFFFF);
+    const __m128i kHighWord = _mm_set_epi32(0xFFFFFF, 0, 0xFFFFFF, 0);
+    const __m128i pair = _mm_or_si128(
+        _mm_and_si128(value, kLowWord),
+        _mm_srli_epi64(_mm_and_si128(value, kHighWord), 8));
+    const __m128i packed = _mm_or_si128(
+        _mm_and_si128(pair, _mm_set_epi32(0, 0, 0xFFFF, -1)),
+        _mm_srli_si128(_mm_andnot_si128(_mm_set_epi32(0, 0, -1, -1), pair),
+                       2));
+    _mm_storel_epi64((void *)dest, packed);
+    const int32_t last = _mm_cvtsi128_si32(_mm_srli_si128(packed, 8));
+    memcpy(dest + 8, &last, 4);
+}
+
+/**
+ * int24_sse2:  Convert four floating-point samples to 24-bit integer
+ * values (stored in 32-bit lanes).  The rounding mode must have been set
+ * with set_round_nearest().
+ *
+ * [Parameters]
+ *     in: Samples to convert.
+ * [Return value]
+ *     Converted values.
+ */
+static inline __m128i int24_sse2(__m128 in)
+{
+    const __m128 k8388607 = _mm_set1_ps(8388607.0f);
+    const __m128 k7FFFFFFF = CAST_M128(_mm_set1_epi32(0x7FFFFFFF));
+    const __m128 k80000000 = CAST_M128(_mm_set1_epi32(0x80000000));
+    const __m128 scaled = _mm_mul_ps(in, k8388607);
+    const __m128 abs = _mm_and_ps(scaled, k7FFFFFFF);
+    const __m128 sign = _mm_and_ps(scaled, k80000000);
+    const __m128 sat = _mm_min_ps(abs, k8388607);
+    return _mm_cvtps_epi32(_mm_or_ps(sat, sign));
+}
+
+/**
+ * int32_sse2:  Convert four floating-point samples to 32-bit integer
+ * values.  The rounding mode must have been set with set_round_nearest().
+ *
+ * [Parameters]
+ *     in: Samples to convert.
+ * [Return value]
+ *     Converted values.
+ */
+static inline __m128i int32_sse2(__m128 in)
+{
+    const __m128d kMax = _mm_set1_pd(2147483647.0);
+    const __m128d kMin = _mm_set1_pd(-2147483647.0);
+    /* _mm_min_pd() returns its second operand if either operand is NaN,
+     * so NaNs saturate to the maximum as in the scalar code. */
+    const __m128d lo = _mm_max_pd(_mm_min_pd(_mm_mul_pd(
+        _mm_cvtps_pd(in), kMax), kMax), kMin);
+    const __m128d hi = _mm_max_pd(_mm_min_pd(_mm_mul_pd(
+        _mm_cvtps_pd(_mm_movehl_ps(in, in)), kMax), kMax), kMin);
+    return _mm_unpacklo_epi64(_mm_cvtpd_epi32(lo), _mm_cvtpd_epi32(hi));
+}
+
+#endif  // ENABLE_ASM_*
+
+/*************************************************************************/
+/************************** Interface routines ***************************/
+/*************************************************************************/
+
+void float_to_int32(int32_t *__restrict dest, const float *__restrict src,
+                    int count)
+{
+#if defined(ENABLE_ASM_ARM_NEON) && defined(__aarch64__)
+
+    for (; count >= 4; src += 4, dest += 4, count -= 4) {
+        vst1q_s32(dest, int32_neon(vld1q_f32(src)));
+    }
+
+#elif defined(ENABLE_ASM_X86_AVX2)
+
+    const uint32_t saved_mxcsr = set_round_nearest();
+    for (; count >= 8; src += 8, dest += 8, count -= 8) {
+        _mm256_storeu_si256((void *)dest, int32_avx2(_mm256_loadu_ps(src)));
+    }
+    _mm_setcsr(saved_mxcsr);
+
+#elif defined(ENABLE_ASM_X86_SSE2)
+
+    const uint32_t saved_mxcsr = set_round_nearest();
+    for (; count >= 4; src += 4, dest += 4, count -= 4) {
+        _mm_storeu_si128((void *)dest, int32_sse2(_mm_loadu_ps(src)));
+    }
+    _mm_setcsr(saved_mxcsr);
+
+#endif  // ENABLE_ASM_*
+
+    for (int i = 0; i < count; i++) {
+        dest[i] = convert_int32(src[i]);
+    }
+}
+
+/*-----------------------------------------------------------------------*/
+
+void float_to_int32_interleave(int32_t *dest, float **src, int channels,
+                               int count)
+{
+    for (int i = 0; i < count; i++) {
+        for (int c = 0; c < channels; c++, dest++) {
+            *dest = convert_int32(src[c][i]);
+        }
+    }
+}
+
+/*-----------------------------------------------------------------------*/
+
+void float_to_int32_interleave_2(
+    int32_t *__restrict dest, const float *__restrict src0,
+    const float *__restrict src1, int count)
+{
+#if defined(ENABLE_ASM_ARM_NEON) && defined(__aarch64__)
+
+    for (; count >= 4; src0 += 4, src1 += 4, dest += 8, count -= 4) {
+        int32x4x2_t out;
+        out.val[0] = int32_neon(vld1q_f32(src0));
+        out.val[1] = int32_neon(vld1q_f32(src1));
+        vst2q_s32(dest, out);
+    }
+
+#elif defined(ENABLE_ASM_X86_AVX2)
+
+    ASSERT((((uintptr_t)src0 | (uintptr_t)src1 | (uintptr_t)dest) & 31) == 0);
+
+    const uint32_t saved_mxcsr = set_round_nearest();
+    for (; count >= 8; src0 += 8, src1 += 8, dest += 16, count -= 8) {
+        const __m256i out0 = int32_avx2(_mm256_load_ps(src0));
+        const __m256i out1 = int32_avx2(_mm256_load_ps(src1));
+        const __m256i out_0145 = _mm256_unpacklo_epi32(out0, out1);
+        const __m256i out_2367 = _mm256_unpackhi_epi32(out0, out1);
+        _mm256_store_si256((void *)(dest+0), _mm256_permute2x128_si256(
+                               out_0145, out_2367, 0x20));
+        _mm256_store_si256((void *)(dest+8), _mm256_permute2x128_si256(
+                               out_0145, out_2367, 0x31));
+    }
+    _mm_setcsr(saved_mxcsr);
+
+#elif defined(ENABLE_ASM_X86_SSE2)
+
+    ASSERT((((uintptr_t)src0 | (uintptr_t)src1 | (uintptr_t)dest) & 15) == 0);
+
+    const uint32_t saved_mxcsr = set_round_nearest();
+    for (; count >= 4; src0 += 4, src1 += 4, dest += 8, count -= 4) {
+        const __m128i out0 = int32_sse2(_mm_load_ps(src0));
+        const __m128i out1 = int32_sse2(_mm_load_ps(src1));
+        _mm_store_si128((void *)(dest+0), _mm_unpacklo_epi32(out0, out1));
+        _mm_store_si128((void *)(dest+4), _mm_unpackhi_epi32(out0, out1));
+    }
+    _mm_setcsr(saved_mxcsr);
+
+#endif  // ENABLE_ASM_*
+
+    for (int i = 0; i < count; i++) {
+        dest[i*2+0] = convert_int32(src0[i]);
+        dest[i*2+1] = convert_int32(src1[i]);
+    }
+}
+
+/*-----------------------------------------------------------------------*/
+
+void float_to_int24(uint8_t *__restrict dest, const float *__restrict src,
+                    int count)
+{
+#if defined(ENABLE_ASM_ARM_NEON)
+
+    for (; count >= 4; src += 4, dest += 12, count -= 4) {
+        pack_int24_neon(dest, int24_neon(vld1q_f32(src)));
+    }
+
+#elif defined(ENABLE_ASM_X86_AVX2)
+
+    const uint32_t saved_mxcsr = set_round_nearest();
+    for (; count >= 8; src += 8, dest += 24, count -= 8) {
+        pack_int24_avx2(dest, int24_avx2(_mm256_loadu_ps(src)));
+    }
+    _mm_setcsr(saved_mxcsr);
+
+#elif defined(ENABLE_ASM_X86_SSE2)
+
+    const uint32_t saved_mxcsr = set_round_nearest();
+    for (; count >= 4; src += 4, dest += 12, count -= 4) {
+        pack_int24_sse2(dest, int24_sse2(_mm_loadu_ps(src)));
+    }
+    _mm_setcsr(saved_mxcsr);
+
+#endif  // ENABLE_ASM_*
+
+    for (int i = 0; i < count; i++, dest += 3) {
+        store_int24(dest, convert_int24(src[i]));
+    }
+}
+
+/*-----------------------------------------------------------------------*/
+
+void float_to_int24_interleave(uint8_t *dest, float **src, int channels,
+                               int count)
+{
+    for (int i = 0; i < count; i++) {
+        for (int c = 0; c < channels; c++, dest += 3) {
+            store_int24(dest, convert_int24(src[c][i]));
+        }
+    }
+}
+
+/*-----------------------------------------------------------------------*/
+
+void float_to_int24_interleave_2(
+    uint8_t *__restrict dest, const float *__restrict src0,
+    const float *__restrict src1, int count)
+{
+#if defined(ENABLE_ASM_ARM_NEON)
+
+    for (; count >= 4; src0 += 4, src1 += 4, dest += 24, count -= 4) {
+        const int32x4x2_t out = vzipq_s32(int24_neon(vld1q_f32(src0)),
+                                          int24_neon(vld1q_f32(src1)));
+        pack_int24_neon(dest, out.val[0]);
+        pack_int24_neon(dest + 12, out.val[1]);
+    }
+
+#elif defined(ENABLE_ASM_X86_AVX2)
+
+    ASSERT((((uintptr_t)src0 | (uintptr_t)src1) & 31) == 0);
+
+    const uint32_t saved_mxcsr = set_round_nearest();
+    for (; count >= 8; src0 += 8, src1 += 8, dest += 48, count -= 8) {
+        const __m256i out0 = int24_avx2(_mm256_load_ps(src0));
+        const __m256i out1 = int24_avx2(_mm256_load_ps(src1));
+        const __m256i out_0145 = _mm256_unpacklo_epi32(out0, out1);
+        const __m256i out_2367 = _mm256_unpackhi_epi32(out0, out1);
+        pack_int24_avx2(dest, _mm256_permute2x128_si256(
+                            out_0145, out_2367, 0x20));
+        pack_int24_avx2(dest + 24, _mm256_permute2x128_si256(
+                            out_0145, out_2367, 0x31));
+    }
+    _mm_setcsr(saved_mxcsr);
+
+#elif defined(ENABLE_ASM_X86_SSE2)
+
+    ASSERT((((uintptr_t)src0 | (uintptr_t)src1) & 15) == 0);
+
+    const uint32_t saved_mxcsr = set_round_nearest();
+    for (; count >= 4; src0 += 4, src1 += 4, dest += 24, count -= 4) {
+        const __m128i out0 = int24_sse2(_mm_load_ps(src0));
+        const __m128i out1 = int24_sse2(_mm_load_ps(src1));
+        pack_int24_sse2(dest, _mm_unpacklo_epi32(out0, out1));
+        pack_int24_sse2(dest + 12, _mm_unpackhi_epi32(out0, out1));
+    }
+    _mm_setcsr(saved_mxcsr);
+
+#endif  // ENABLE_ASM_*
+
+    for (int i = 0; i < count; i++, dest += 6) {
+        store_int24(dest, convert_int24(src0[i]));
+        store_int24(dest + 3, convert_int24(src1[i]));
+    }
+}
+
+/*************************************************************************/
+/*************************************************************************/
@@ -0,0 +1,114 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#ifndef NOGG_SRC_UTIL_FLOAT_TO_INT32_H
+#define NOGG_SRC_UTIL_FLOAT_TO_INT32_H
+
+/*************************************************************************/
+/*************************************************************************/
+
+/**
+ * float_to_int32:  Convert floating-point data in 'src' to 32-bit integer
+ * data in 'dest'.  Input values in the range [-1.0,+1.0] are scaled by
+ * 2^31-1 (as int16 and int24 conversion scale by 2^15-1 and 2^23-1), so
+ * output values are in the range [-2147483647,+2147483647].
+ *
+ * [Parameters]
+ *     dest: Destination (int32) buffer pointer.
+ *     src: Source (float) buffer pointer.
+ *     count: Number of values to convert.
+ */
+#define float_to_int32 INTERNAL(float_to_int32)
+extern void float_to_int32(int32_t *__restrict dest, const float *__restrict src,
+                           int count);
+
+/**
+ * float_to_int32_interleave:  Convert multiple channels of floating-point
+ * data in 'src' to interleaved 32-bit integer data in 'dest'.
+ *
+ * [Parameters]
+ *     dest: Destination (int32) buffer pointer.
+ *     src: Source (float) buffer array.
+ *     channels: Number of source channels.
+ *     count: Number of values to convert per channel.
+ */
+#define float_to_int32_interleave INTERNAL(float_to_int32_interleave)
+extern void float_to_int32_interleave(int32_t *dest, float **src, int channels,
+                                      int count);
+
+/**
+ * float_to_int32_interleave_2:  Convert two channels of floating-point
+ * data in 'src' to interleaved 32-bit integer data in 'dest'.
+ * Specialization of float_to_int32_interleave() for channels==2.
+ *
+ * The caller guarantees that dest, src0, and src1 are aligned
+ * appropriately for CPU-specific optimized copies.
+ *
+ * [Parameters]
+ *     dest: Destination (int32) buffer pointer.
+ *     src0: Source (float) buffer array for first channel.
+ *     src1: Source (float) buffer array for second channel.
+ *     count: Number of values to convert.
+ */
+#define float_to_int32_interleave_2 INTERNAL(float_to_int32_interleave_2)
+extern void float_to_int32_interleave_2(
+    int32_t *__restrict dest, const float *__restrict src0,
+    const float *__restrict src1, int count);
+
+/**
+ * float_to_int24:  Convert floating-point data in 'src' to packed 24-bit
+ * little-endian integer data in 'dest'.  Each output value occupies 3
+ * bytes, and values are in the range [-8388607,+8388607].
+ *
+ * [Parameters]
+ *     dest: Destination buffer pointer.
+ *     src: Source (float) buffer pointer.
+ *     count: Number of values to convert.
+ */
+#define float_to_int24 INTERNAL(float_to_int24)
+extern void float_to_int24(uint8_t *__restrict dest, const float *__restrict src,
+                           int count);
+
+/**
+ * float_to_int24_interleave:  Convert multiple channels of floating-point
+ * data in 'src' to interleaved, packed 24-bit integer data in 'dest'.
+ *
+ * [Parameters]
+ *     dest: Destination buffer pointer.
+ *     src: Source (float) buffer array.
+ *     channels: Number of source channels.
+ *     count: Number of values to convert per channel.
+ */
+#define float_to_int24_interleave INTERNAL(float_to_int24_interleave)
+extern void float_to_int24_interleave(uint8_t *dest, float **src, int channels,
+                                      int count);
+
+/**
+ * float_to_int24_interleave_2:  Convert two channels of floating-point
+ * data in 'src' to interleaved, packed 24-bit integer data in 'dest'.
+ * Specialization of float_to_int24_interleave() for channels==2.
+ *
+ * The caller guarantees that src0 and src1 are aligned appropriately for
+ * CPU-specific optimized copies.  dest need not be aligned.
+ *
+ * [Parameters]
+ *     dest: Destination buffer pointer.
+ *     src0: Source (float) buffer array for first channel.
+ *     src1: Source (float) buffer array for second channel.
+ *     count: Number of values to convert.
+ */
+#define float_to_int24_interleave_2 INTERNAL(float_to_int24_interleave_2)
+extern void float_to_int24_interleave_2(
+    uint8_t *__restrict dest, const float *__restrict src0,
+    const float *__restrict src1, int count);
+
+/*************************************************************************/
+/*************************************************************************/
+
+#endif  // NOGG_SRC_UTIL_FLOAT_TO_INT32_H
@@ -10,7 +10,9 @@
 #include "include/nogg.h"
 #include "src/common.h"
 #include "src/util/open.h"
+#include "src/util/decode-frame.h"
 #include "src/util/memory.h"
+#include "src/util/float-to-int16.h"
 
 #include <stdlib.h>
 
@@ -87,6 +89,14 @@ vorbis_t *open_common(const open_params_t *params, vorbis_error_t *error_ret)
             goto exit;
         }
     }
+    const unsigned int read_only_options =
+        params->options & (VORBIS_OPTION_READ_INT16_ONLY
+                           | VORBIS_OPTION_READ_INT24_ONLY
+                           | VORBIS_OPTION_READ_INT32_ONLY);
+    if (read_only_options & (read_only_options - 1)) {
+        error = VORBIS_ERROR_INVALID_ARGUMENT;  // More than one is set.
+        goto exit;
+    }
 
     /* Perform CPU runtime checks. */
 #ifdef ENABLE_ASM_X86_AVX2
@@ -117,6 +127,12 @@ vorbis_t *open_common(const open_params_t *params, vorbis_error_t *error_ret)
     handle->packet_mode = params->packet_mode;
     handle->read_int16_only =
         ((params->options & VORBIS_OPTION_READ_INT16_ONLY) != 0);
+    handle->read_int24_only =
+        ((params->options & VORBIS_OPTION_READ_INT24_ONLY) != 0);
+    handle->read_int32_only =
+        ((params->options & VORBIS_OPTION_READ_INT32_ONLY) != 0);
+    handle->dither_int16 =
+        ((params->options & VORBIS_OPTION_DITHER_INT16) != 0);
     handle->callbacks = *params->callbacks;
     if (handle->packet_mode) {
         handle->callbacks.length = NULL;
@@ -131,7 +147,11 @@ vorbis_t *open_common(const open_params_t *params, vorbis_error_t *error_ret)
     } else {
         handle->callback_data = params->callback_data;
     }
-    if (handle->callbacks.length) {
+    /* Chained streams are treated as unseekable, since sample positions
+     * in later links are only known once the preceding links have been
+     * decoded. */
+    if (handle->callbacks.length
+     && !(params->options & VORBIS_OPTION_CHAINED_STREAMS)) {
         handle->data_length =
             (*handle->callbacks.length)(handle->callback_data);
     } else {
@@ -142,6 +162,12 @@ vorbis_t *open_common(const open_params_t *params, vorbis_error_t *error_ret)
     handle->frame_pos = 0;
     handle->decode_buf_len = 0;
     handle->decode_buf_pos = 0;
+    handle->packet_preroll = 0;
+    handle->link_changed = 0;
+    handle->resampler = NULL;
+    handle->downmix_matrix = NULL;
+    handle->downmix_buf = NULL;
+    dither_init(handle->dither_state);
 
     /* Create an stb_vorbis handle for the stream. */
     int stb_error;
@@ -175,12 +201,13 @@ vorbis_t *open_common(const open_params_t *params, vorbis_error_t *error_ret)
     /* Save the audio parameters. */
     stb_vorbis_info info = stb_vorbis_get_info(handle->decoder);
     handle->channels = info.channels;
+    handle->stream_channels = info.channels;
     handle->rate = info.sample_rate;
 
     /* Allocate a decoding buffer based on the maximum decoded frame size.
      * We align this to a 64-byte boundary to help optimizations which
      * require aligned data. */
-    const int sample_size = (handle->read_int16_only ? 2 : 4);
+    const int sample_size = decode_buf_sample_size(handle);
     const int32_t decode_buf_size =
         sample_size * handle->channels * info.max_frame_size;
     handle->decode_buf = mem_alloc(handle, decode_buf_size, 64);
@@ -0,0 +1,546 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "src/common.h"
+#include "src/util/memory.h"
+#include "src/util/resample.h"
+#include "src/x86.h"
+
+#include <math.h>
+#include <string.h>
+
+#ifdef ENABLE_ASM_ARM_NEON
+# include <arm_neon.h>
+#endif
+
+/*
+ * The resampler is a conventional polyphase windowed-sinc FIR filter.
+ * With the resampling ratio reduced to lowest terms as in_rate:out_rate =
+ * down:up, output sample k is located at input time t = k*down/up, and
+ * is computed as the dot product of the "taps" input samples surrounding
+ * t with the filter phase corresponding to the fractional part of t.
+ * When "up" is small enough, every possible phase has its own table
+ * entry, so the output is exact; otherwise, the phase is rounded down to
+ * the nearest of MAX_PHASES evenly spaced table entries.
+ *
+ * Input data is accumulated in per-channel history buffers so that the
+ * filter can span frame boundaries.  Sample positions are tracked as
+ * absolute stream positions so that discontinuities (such as from a seek
+ * or decoding error) can be detected and the history reset.
+ */
+
+/*************************************************************************/
+/****************************** Local data *******************************/
+/*************************************************************************/
+
+/* Maximum number of filter phases stored in the coefficient table. */
+#define MAX_PHASES  1024
+
+/* Output sample positions are clamped to this value to avoid overflow in
+ * position calculations (2^43 samples is over 3 months of audio at the
+ * maximum sampling rate). */
+#define MAX_POSITION  (UINT64_C(1) << 43)
+
+/* Filter parameters for each quality tier. */
+static const struct {
+    int taps;        // Filter length (must be a multiple of 8).
+    double rolloff;  // Cutoff frequency relative to the Nyquist frequency.
+} quality_params[] = {
+    [VORBIS_RESAMPLE_QUALITY_LOW]    = { 8, 0.80},
+    [VORBIS_RESAMPLE_QUALITY_MEDIUM] = {16, 0.90},
+    [VORBIS_RESAMPLE_QUALITY_HIGH]   = {32, 0.95},
+};
+
+/* Resampler state structure. */
+struct resampler_t {
+    /* Number of audio channels. */
+    int channels;
+    /* Filter length in input samples. */
+    int taps;
+    /* Number of filter phases in the coefficient table. */
+    int num_phases;
+    /* Resampling ratio (in_rate:out_rate) reduced to lowest terms. */
+    uint32_t up, down;
+    /* Integer and fractional parts of down/up (the input step per output
+     * sample), with the fractional part in units of 1/up. */
+    uint32_t step_int, step_frac;
+    /* Filter coefficients (num_phases * taps). */
+    float *filter;
+
+    /* Input history buffers, one per channel, each buf_size samples long. */
+    float **buf;
+    int buf_size;
+    /* Number of valid samples in each history buffer. */
+    int buf_len;
+    /* Input position of the first sample in the history buffers. */
+    int64_t buf_start;
+
+    /* Output buffers, one per channel, each max_output samples long. */
+    float **out;
+    int max_output;
+
+    /* Output position of the next sample to generate. */
+    uint64_t next_out;
+    /* Integer and fractional (in units of 1/up) parts of the input
+     * position corresponding to next_out. */
+    int64_t next_in;
+    uint32_t next_phase;
+
+    /* Flag: has resampler_seek() been called since the last frame? */
+    bool seek_pending;
+    /* Flag: should the history be discarded on the next frame? */
+    bool reset_pending;
+    /* Flag: has resampler_flush() been called? */
+    bool flushed;
+};
+
+/*************************************************************************/
+/**************************** Helper routines ****************************/
+/*************************************************************************/
+
+/**
+ * gcd:  Return the greatest common divisor of two positive integers.
+ */
+static uint32_t gcd(uint32_t a, uint32_t b)
+{
+    while (b != 0) {
+        const uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * init_filter:  Compute the filter coefficient table for a resampler.
+ *
+ * [Parameters]
+ *     resampler: Resampler.
+ *     rolloff: Cutoff frequency relative to the lower of the input and
+ *         output Nyquist frequencies.
+ */
+static void init_filter(resampler_t *resampler, double rolloff)
+{
+    const int taps = resampler->taps;
+    const int half = taps / 2;
+    const double pi = 3.14159265358979323846;
+    double cutoff = rolloff;
+    if (resampler->up < resampler->down) {
+        cutoff *= (double)resampler->up / (double)resampler->down;
+    }
+
+    for (int phase = 0; phase < resampler->num_phases; phase++) {
+        const double frac = (double)phase / (double)resampler->num_phases;
+        float *coefs = &resampler->filter[phase * taps];
+        double sum = 0;
+        for (int j = 0; j < taps; j++) {
+            /* Offset of this tap from the output sample time. */
+            const double d = (double)(j - half + 1) - frac;
+            const double x = pi * cutoff * d;
+            const double sinc = (x == 0 ? 1.0 : sin(x) / x);
+            const double window = 0.42 + 0.5 * cos(pi * d / half)
+                                       + 0.08 * cos(2 * pi * d / half);
+            const double value = cutoff * sinc * window;
+            coefs[j] = (float)value;
+            sum += value;
+        }
+        /* Normalize each phase to unity gain at DC. */
+        for (int j = 0; j < taps; j++) {
+            coefs[j] = (float)(coefs[j] / sum);
+        }
+    }
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * set_position:  Set the output position of the next sample to generate.
+ *
+ * [Parameters]
+ *     resampler: Resampler.
+ *     out_pos: Output sample position.
+ */
+static void set_position(resampler_t *resampler, uint64_t out_pos)
+{
+    if (out_pos > MAX_POSITION) {
+        out_pos = MAX_POSITION;
+    }
+    const uint64_t product = out_pos * resampler->down;
+    resampler->next_out = out_pos;
+    resampler->next_in = (int64_t)(product / resampler->up);
+    resampler->next_phase = (uint32_t)(product % resampler->up);
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * reset_history:  Discard the filter history, and set the history buffer
+ * to contain silence preceding the given input position.
+ *
+ * [Parameters]
+ *     resampler: Resampler.
+ *     in_pos: Input position of the next sample to be added.
+ */
+static void reset_history(resampler_t *resampler, int64_t in_pos)
+{
+    for (int c = 0; c < resampler->channels; c++) {
+        memset(resampler->buf[c], 0,
+               sizeof(*resampler->buf[c]) * resampler->taps);
+    }
+    resampler->buf_len = resampler->taps;
+    resampler->buf_start = in_pos - resampler->taps;
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * discard_history:  Remove samples which are no longer needed to generate
+ * output from the history buffers.
+ *
+ * [Parameters]
+ *     resampler: Resampler.
+ */
+static void discard_history(resampler_t *resampler)
+{
+    const int64_t first_needed = resampler->next_in - resampler->taps/2 + 1;
+    int64_t discard = first_needed - resampler->buf_start;
+    if (discard > resampler->buf_len) {
+        discard = resampler->buf_len;
+    }
+    if (discard > 0) {
+        const int keep = resampler->buf_len - (int)discard;
+        for (int c = 0; c < resampler->channels; c++) {
+            memmove(resampler->buf[c], resampler->buf[c] + discard,
+                    sizeof(*resampler->buf[c]) * keep);
+        }
+        resampler->buf_len = keep;
+        resampler->buf_start += discard;
+    }
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * dot_product:  Return the dot product of an input data vector and a
+ * filter phase.
+ *
+ * [Parameters]
+ *     data: Input data pointer (need not be aligned).
+ *     coefs: Filter coefficient pointer (aligned to 32 bytes).
+ *     taps: Filter length (must be a multiple of 8).
+ * [Return value]
+ *     Dot product.
+ */
+static inline float dot_product(const float *data, const float *coefs,
+                                int taps)
+{
+#if defined(ENABLE_ASM_ARM_NEON)
+    float32x4_t acc0 = vdupq_n_f32(0);
+    float32x4_t acc1 = vdupq_n_f32(0);
+    for (int i = 0; i < taps; i += 8) {
+        acc0 = vmlaq_f32(acc0, vld1q_f32(data + i), vld1q_f32(coefs + i));
+        acc1 = vmlaq_f32(acc1, vld1q_f32(data + i + 4),
+                         vld1q_f32(coefs + i + 4));
+    }
+    const float32x4_t acc = vaddq_f32(acc0, acc1);
+    const float32x2_t sum2 = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+    return vget_lane_f32(vpadd_f32(sum2, sum2), 0);
+#elif defined(ENABLE_ASM_X86_AVX2)
+    __m256 acc = _mm256_setzero_ps();
+    for (int i = 0; i < taps; i += 8) {
+        acc = _mm256_fmadd_ps(_mm256_loadu_ps(data + i),
+                              _mm256_load_ps(coefs + i), acc);
+    }
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc),
+                            _mm256_extractf128_ps(acc, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1,1,1,1)));
+    return _mm_cvtss_f32(sum);
+#elif defined(ENABLE_ASM_X86_SSE2)
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    for (int i = 0; i < taps; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(data + i),
+                                           _mm_load_ps(coefs + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(data + i + 4),
+                                           _mm_load_ps(coefs + i + 4)));
+    }
+    __m128 sum = _mm_add_ps(acc0, acc1);
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1,1,1,1)));
+    return _mm_cvtss_f32(sum);
+#else
+    float sum = 0;
+    for (int i = 0; i < taps; i++) {
+        sum += data[i] * coefs[i];
+    }
+    return sum;
+#endif  // ENABLE_ASM_*
+}
+
+/*-----------------------------------------------------------------------*/
+
+/**
+ * generate:  Generate as many output samples as possible from the data
+ * in the history buffers.
+ *
+ * [Parameters]
+ *     resampler: Resampler.
+ *     in_limit: Input position at which to stop generating samples (the
+ *         end of the stream when flushing).
+ * [Return value]
+ *     Number of output samples generated per channel.
+ */
+static int generate(resampler_t *resampler, int64_t in_limit)
+{
+    const int channels = resampler->channels;
+    const int taps = resampler->taps;
+    const int half = taps / 2;
+    const int64_t buf_end = resampler->buf_start + resampler->buf_len;
+    const bool exact_phases = ((uint32_t)resampler->num_phases
+                               == resampler->up);
+
+    int count = 0;
+    while (resampler->next_in + half < buf_end
+           && resampler->next_in < in_limit) {
+        ASSERT(count < resampler->max_output);
+        const int offset =
+            (int)(resampler->next_in - half + 1 - resampler->buf_start);
+        ASSERT(offset >= 0);
+        const uint32_t phase = (exact_phases ? resampler->next_phase :
+                                (uint32_t)((uint64_t)resampler->next_phase
+                                           * resampler->num_phases
+                                           / resampler->up));
+        const float *coefs = &resampler->filter[phase * taps];
+        for (int c = 0; c < channels; c++) {
+            resampler->out[c][count] =
+                dot_product(resampler->buf[c] + offset, coefs, taps);
+        }
+        count++;
+
+        resampler->next_in += resampler->step_int;
+        resampler->next_phase += resampler->step_frac;
+        if (resampler->next_phase >= resampler->up) {
+            resampler->next_phase -= resampler->up;
+            resampler->next_in++;
+        }
+    }
+
+    resampler->next_out += count;
+    return count;
+}
+
+/*************************************************************************/
+/************************** Interface routines ***************************/
+/*************************************************************************/
+
+resampler_t *resampler_create(
+    vorbis_t *handle, uint32_t in_rate, uint32_t out_rate, int quality,
+    int channels, int max_frame_size)
+{
+    ASSERT(in_rate > 0 && in_rate <= RESAMPLE_MAX_RATE);
+    ASSERT(out_rate > 0 && out_rate <= RESAMPLE_MAX_RATE);
+    ASSERT(quality >= 0 && quality < (int)lenof(quality_params));
+    ASSERT(channels > 0);
+    ASSERT(max_frame_size > 0);
+
+    resampler_t *resampler = mem_alloc(handle, sizeof(*resampler), 0);
+    if (!resampler) {
+        goto error_return;
+    }
+
+    const uint32_t divisor = gcd(in_rate, out_rate);
+    resampler->channels = channels;
+    resampler->taps = quality_params[quality].taps;
+    resampler->up = out_rate / divisor;
+    resampler->down = in_rate / divisor;
+    resampler->step_int = resampler->down / resampler->up;
+    resampler->step_frac = resampler->down % resampler->up;
+    resampler->num_phases = (int)min(resampler->up, MAX_PHASES);
+
+    /* The history buffer needs to hold one frame plus one filter's worth
+     * of history, plus half a filter's worth of padding for flushing. */
+    resampler->buf_size =
+        max_frame_size + resampler->taps + resampler->taps/2;
+    resampler->max_output = (int)(((int64_t)resampler->buf_size
+                                   * resampler->up + resampler->down - 1)
+                                  / resampler->down) + 1;
+
+    resampler->filter = mem_alloc(
+        handle, sizeof(*resampler->filter)
+                * resampler->num_phases * resampler->taps, 64);
+    if (!resampler->filter) {
+        goto error_free_resampler;
+    }
+    resampler->buf = alloc_channel_array(
+        handle, channels, sizeof(**resampler->buf) * resampler->buf_size, 64);
+    if (!resampler->buf) {
+        goto error_free_filter;
+    }
+    resampler->out = alloc_channel_array(
+        handle, channels, sizeof(**resampler->out) * resampler->max_output,
+        64);
+    if (!resampler->out) {
+        goto error_free_buf;
+    }
+
+    init_filter(resampler, quality_params[quality].rolloff);
+    set_position(resampler, 0);
+    reset_history(resampler, 0);
+    resampler->seek_pending = false;
+    resampler->reset_pending = false;
+    resampler->flushed = false;
+    return resampler;
+
+  error_free_buf:
+    mem_free(handle, resampler->buf);
+  error_free_filter:
+    mem_free(handle, resampler->filter);
+  error_free_resampler:
+    mem_free(handle, resampler);
+  error_return:
+    return NULL;
+}
+
+/*-----------------------------------------------------------------------*/
+
+void resampler_free(vorbis_t *handle, resampler_t *resampler)
+{
+    if (resampler) {
+        mem_free(handle, resampler->out);
+        mem_free(handle, resampler->buf);
+        mem_free(handle, resampler->filter);
+        mem_free(handle, resampler);
+    }
+}
+
+/*-----------------------------------------------------------------------*/
+
+int resampler_max_output(const resampler_t *resampler)
+{
+    return resampler->max_output;
+}
+
+/*-----------------------------------------------------------------------*/
+
+uint64_t resampler_length(const resampler_t *resampler, uint64_t in_length)
+{
+    const uint64_t whole = in_length / resampler->down;
+    const uint64_t part = in_length % resampler->down;
+    return whole * resampler->up
+        + (part * resampler->up + resampler->down - 1) / resampler->down;
+}
+
+/*-----------------------------------------------------------------------*/
+
+uint64_t resampler_tell(const resampler_t *resampler)
+{
+    return resampler->next_out;
+}
+
+/*-----------------------------------------------------------------------*/
+
+uint64_t resampler_seek(resampler_t *resampler, uint64_t out_pos)
+{
+    set_position(resampler, out_pos);
+    resampler->seek_pending = true;
+    resampler->reset_pending = true;
+    resampler->flushed = false;
+    /* Start a full filter length early so the filter is fully primed
+     * with real data by the time we reach the target sample. */
+    const int64_t in_pos = resampler->next_in - resampler->taps;
+    return in_pos > 0 ? (uint64_t)in_pos : 0;
+}
+
+/*-----------------------------------------------------------------------*/
+
+void resampler_reset(resampler_t *resampler, uint64_t out_pos)
+{
+    set_position(resampler, out_pos);
+    reset_history(resampler, resampler->next_in);
+    resampler->seek_pending = false;
+    resampler->reset_pending = false;
+    resampler->flushed = false;
+}
+
+/*-----------------------------------------------------------------------*/
+
+int resampler_process(resampler_t *resampler, float **in, int samples,
+                      int64_t in_pos, float ***out_ret)
+{
+    ASSERT(samples >= 0);
+    ASSERT(samples <= resampler->buf_size - resampler->taps - resampler->taps/2);
+
+    const int64_t buf_end = resampler->buf_start + resampler->buf_len;
+    if (in_pos < 0) {
+        in_pos = buf_end;
+    }
+    if (resampler->reset_pending || in_pos != buf_end) {
+        reset_history(resampler, in_pos);
+        if (!resampler->seek_pending) {
+            /* Resume output at the first output sample whose input
+             * position is at or after the start of the new data. */
+            set_position(resampler,
+                         ((uint64_t)in_pos * resampler->up
+                          + resampler->down - 1) / resampler->down);
+        }
+        resampler->reset_pending = false;
+        resampler->seek_pending = false;
+    }
+
+    discard_history(resampler);
+
+    /* If the next output sample is beyond the start of this frame (as
+     * after a seek), skip input data which will not be needed. */
+    const int64_t first_needed = resampler->next_in - resampler->taps/2 + 1;
+    int skip = 0;
+    if (first_needed > resampler->buf_start + resampler->buf_len) {
+        ASSERT(resampler->buf_len == 0);
+        skip = (int)min(first_needed - resampler->buf_start, samples);
+        resampler->buf_start += skip;
+    }
+    for (int c = 0; c < resampler->channels; c++) {
+        memcpy(resampler->buf[c] + resampler->buf_len, in[c] + skip,
+               sizeof(*in[c]) * (samples - skip));
+    }
+    resampler->buf_len += samples - skip;
+
+    *out_ret = resampler->out;
+    return generate(resampler, resampler->buf_start + resampler->buf_len);
+}
+
+/*-----------------------------------------------------------------------*/
+
+int resampler_flush(resampler_t *resampler, float ***out_ret)
+{
+    *out_ret = resampler->out;
+    if (resampler->flushed) {
+        return 0;
+    }
+    resampler->flushed = true;
+
+    /* Pad the input with silence so the filter can reach the final
+     * input sample. */
+    discard_history(resampler);
+    const int64_t in_end = resampler->buf_start + resampler->buf_len;
+    const int pad = resampler->taps / 2;
+    for (int c = 0; c < resampler->channels; c++) {
+        memset(resampler->buf[c] + resampler->buf_len, 0,
+               sizeof(*resampler->buf[c]) * pad);
+    }
+    resampler->buf_len += pad;
+
+    return generate(resampler, in_end);
+}
+
+/*************************************************************************/
+/*************************************************************************/
@@ -0,0 +1,164 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#ifndef NOGG_SRC_UTIL_RESAMPLE_H
+#define NOGG_SRC_UTIL_RESAMPLE_H
+
+/*************************************************************************/
+/*************************************************************************/
+
+/**
+ * RESAMPLE_MAX_RATE:  Maximum input or output sampling rate supported by
+ * the resampler.  This limit ensures that sample position calculations
+ * cannot overflow 64 bits.
+ */
+#define RESAMPLE_MAX_RATE  1048576
+
+/* Opaque resampler state type. */
+typedef struct resampler_t resampler_t;
+
+/**
+ * resampler_create:  Create a polyphase FIR resampler.
+ *
+ * [Parameters]
+ *     handle: Stream handle (used for memory allocation).
+ *     in_rate: Input sampling rate, in Hz (1 through RESAMPLE_MAX_RATE).
+ *     out_rate: Output sampling rate, in Hz (1 through RESAMPLE_MAX_RATE).
+ *     quality: Quality tier (VORBIS_RESAMPLE_QUALITY_*).
+ *     channels: Number of audio channels.
+ *     max_frame_size: Maximum number of samples per channel which will be
+ *         passed to a single resampler_process() call.
+ * [Return value]
+ *     New resampler, or NULL on allocation failure.
+ */
+#define resampler_create INTERNAL(resampler_create)
+extern resampler_t *resampler_create(
+    vorbis_t *handle, uint32_t in_rate, uint32_t out_rate, int quality,
+    int channels, int max_frame_size);
+
+/**
+ * resampler_free:  Destroy a resampler.
+ *
+ * [Parameters]
+ *     handle: Stream handle.
+ *     resampler: Resampler to destroy (may be NULL).
+ */
+#define resampler_free INTERNAL(resampler_free)
+extern void resampler_free(vorbis_t *handle, resampler_t *resampler);
+
+/**
+ * resampler_max_output:  Return the maximum number of samples per channel
+ * which can be returned from a single resampler_process() or
+ * resampler_flush() call.
+ *
+ * [Parameters]
+ *     resampler: Resampler.
+ * [Return value]
+ *     Maximum output sample count.
+ */
+#define resampler_max_output INTERNAL(resampler_max_output)
+extern int resampler_max_output(const resampler_t *resampler);
+
+/**
+ * resampler_length:  Return the number of output samples generated from
+ * a stream of the given number of input samples.
+ *
+ * [Parameters]
+ *     resampler: Resampler.
+ *     in_length: Input stream length, in samples.
+ * [Return value]
+ *     Output stream length, in samples.
+ */
+#define resampler_length INTERNAL(resampler_length)
+extern uint64_t resampler_length(const resampler_t *resampler,
+                                 uint64_t in_length);
+
+/**
+ * resampler_tell:  Return the output sample position of the next sample
+ * to be returned from the resampler.
+ *
+ * [Parameters]
+ *     resampler: Resampler.
+ * [Return value]
+ *     Output sample position.
+ */
+#define resampler_tell INTERNAL(resampler_tell)
+extern uint64_t resampler_tell(const resampler_t *resampler);
+
+/**
+ * resampler_seek:  Set the output sample position of the next sample to
+ * be returned from the resampler, and return the input sample position
+ * from which data should be fed to the resampler in order to generate
+ * that sample.  The resampler's filter history is discarded.
+ *
+ * [Parameters]
+ *     resampler: Resampler.
+ *     out_pos: Output sample position.
+ * [Return value]
+ *     Input sample position at which to resume decoding.
+ */
+#define resampler_seek INTERNAL(resampler_seek)
+extern uint64_t resampler_seek(resampler_t *resampler, uint64_t out_pos);
+
+/**
+ * resampler_reset:  Set the output sample position of the next sample to
+ * be returned from the resampler, and discard the filter history.  The
+ * next frame passed to resampler_process() is taken to begin at the input
+ * position corresponding to that output position.  This is used when
+ * decoding resumes at a known position but the preceding input data is
+ * not available.
+ *
+ * [Parameters]
+ *     resampler: Resampler.
+ *     out_pos: Output sample position.
+ */
+#define resampler_reset INTERNAL(resampler_reset)
+extern void resampler_reset(resampler_t *resampler, uint64_t out_pos);
+
+/**
+ * resampler_process:  Pass a frame of planar audio data through the
+ * resampler.  If in_pos does not immediately follow the end of the
+ * previous frame, the filter history is reset.
+ *
+ * [Parameters]
+ *     resampler: Resampler.
+ *     in: Input data, one array per channel.
+ *     samples: Number of input samples per channel.
+ *     in_pos: Input sample position of the first sample in the frame,
+ *         or a negative value to treat the frame as continuing from the
+ *         previous one.
+ *     out_ret: Pointer to variable to receive the output data array (one
+ *         array per channel, each aligned to 64 bytes).  The data remains
+ *         valid until the next call to a resampler function.
+ * [Return value]
+ *     Number of output samples per channel (may be zero).
+ */
+#define resampler_process INTERNAL(resampler_process)
+extern int resampler_process(resampler_t *resampler, float **in, int samples,
+                             int64_t in_pos, float ***out_ret);
+
+/**
+ * resampler_flush:  Return the samples remaining in the resampler's
+ * filter delay line at the end of the stream.  Only the first call after
+ * reaching the end of the stream returns any data.
+ *
+ * [Parameters]
+ *     resampler: Resampler.
+ *     out_ret: Pointer to variable to receive the output data array, as
+ *         for resampler_process().
+ * [Return value]
+ *     Number of output samples per channel (may be zero).
+ */
+#define resampler_flush INTERNAL(resampler_flush)
+extern int resampler_flush(resampler_t *resampler, float ***out_ret);
+
+/*************************************************************************/
+/*************************************************************************/
+
+#endif  // NOGG_SRC_UTIL_RESAMPLE_H
@@ -0,0 +1,46 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "tests/common.h"
+
+
+int main(void)
+{
+    vorbis_t *vorbis;
+    EXPECT(vorbis = TEST___open_file("tests/data/square.ogg", 0, NULL));
+
+    vorbis_stats_t stats[1];
+    vorbis_error_t error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_analyze(vorbis, stats, NULL, -1, stats, 1, &error), 0);
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_analyze(vorbis, stats, NULL, 10, NULL, 1, &error), 0);
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_analyze(vorbis, stats, NULL, 10, stats, -1, &error), 0);
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+
+    /* Analysis is not supported with resampling enabled. */
+    EXPECT(vorbis_set_output_rate(vorbis, 8000,
+                                  VORBIS_RESAMPLE_QUALITY_LOW, NULL));
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_analyze(vorbis, stats, NULL, 0, NULL, 0, &error), 0);
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_OPERATION);
+    EXPECT(vorbis_set_output_rate(vorbis, 0,
+                                  VORBIS_RESAMPLE_QUALITY_LOW, NULL));
+
+    /* A NULL block array is allowed if max_blocks is zero. */
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_analyze(vorbis, stats, NULL, 10, NULL, 0, &error), 40);
+    EXPECT_EQ(error, VORBIS_NO_ERROR);
+
+    vorbis_close(vorbis);
+    return EXIT_SUCCESS;
+}
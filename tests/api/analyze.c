@@ -0,0 +1,157 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "tests/common.h"
+
+#include <math.h>
+
+
+/* Compare analysis results against statistics computed from PCM data.
+ * Returns true if all values match within a small tolerance. */
+static int check_stats(const vorbis_stats_t *stats, const float *pcm,
+                       int channels, int samples)
+{
+    for (int c = 0; c < channels; c++) {
+        float peak = 0;
+        double sum_sq = 0;
+        for (int i = 0; i < samples; i++) {
+            const float sample = pcm[i*channels+c];
+            peak = fmaxf(peak, fabsf(sample));
+            sum_sq += (double)sample * sample;
+        }
+        const float rms = (float)sqrt(sum_sq / samples);
+        if (stats[c].peak != peak) {
+            LOG("Channel %d peak was %.8g but should have been %.8g",
+                c, stats[c].peak, peak);
+            return 0;
+        }
+        if (fabsf(stats[c].rms - rms) > rms * 1.0e-5f) {
+            LOG("Channel %d RMS was %.8g but should have been %.8g",
+                c, stats[c].rms, rms);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*-----------------------------------------------------------------------*/
+
+int main(void)
+{
+    vorbis_t *vorbis;
+    static float pcm[3072*6];
+    EXPECT(vorbis = TEST___open_file("tests/data/6ch-moving-sine.ogg",
+                                     0, NULL));
+    EXPECT_EQ(vorbis_read_float(vorbis, pcm, 3072, NULL), 3072);
+    vorbis_close(vorbis);
+
+    /* Analysis of the whole stream, with per-block statistics.  The
+     * final block is partial, and there is room for one extra block
+     * which should not be touched. */
+    EXPECT(vorbis = TEST___open_file("tests/data/6ch-moving-sine.ogg",
+                                     0, NULL));
+    vorbis_stats_t stats[6], block_stats[5*6];
+    for (int i = 0; i < 5*6; i++) {
+        block_stats[i].peak = block_stats[i].rms = -1;
+    }
+    float loudness = 0;
+    vorbis_error_t error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_analyze(vorbis, stats, &loudness, 1000, block_stats, 5,
+                             &error), 3072);
+    EXPECT_EQ(error, VORBIS_NO_ERROR);
+    EXPECT(check_stats(stats, pcm, 6, 3072));
+    for (int b = 0; b < 4; b++) {
+        EXPECT(check_stats(&block_stats[b*6], &pcm[b*1000*6], 6,
+                           b==3 ? 72 : 1000));
+    }
+    for (int c = 0; c < 6; c++) {
+        EXPECT_EQ(block_stats[4*6+c].peak, -1);
+    }
+    double total_ms = 0;
+    for (int c = 0; c < 6; c++) {
+        total_ms += (double)stats[c].rms * stats[c].rms;
+    }
+    const float expected_loudness = (float)(-0.691 + 10*log10(total_ms));
+    if (fabsf(loudness - expected_loudness) > 0.001f) {
+        FAIL("Loudness was %.8g but should have been %.8g",
+             loudness, expected_loudness);
+    }
+    EXPECT_EQ(vorbis_tell(vorbis), 3072);
+    float dummy[6];
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_read_float(vorbis, dummy, 1, &error), 0);
+    EXPECT_EQ(error, VORBIS_ERROR_STREAM_END);
+    vorbis_close(vorbis);
+
+    /* Analysis after a partial read should include the unread part of
+     * the current frame. */
+    EXPECT(vorbis = TEST___open_file("tests/data/6ch-moving-sine.ogg",
+                                     0, NULL));
+    EXPECT_EQ(vorbis_read_float(vorbis, dummy, 1, NULL), 1);
+    EXPECT_EQ(vorbis_analyze(vorbis, stats, NULL, 0, NULL, 0, NULL), 3071);
+    EXPECT(check_stats(stats, &pcm[1*6], 6, 3071));
+    vorbis_close(vorbis);
+
+    /* Also check the pending-data path for int16 decode buffers, and that
+     * a silent stream gives the expected loudness. */
+    EXPECT(vorbis = TEST___open_file("tests/data/6ch-moving-sine.ogg",
+                                     VORBIS_OPTION_READ_INT16_ONLY, NULL));
+    int16_t dummy16[6];
+    EXPECT_EQ(vorbis_read_int16(vorbis, dummy16, 1, NULL), 1);
+    EXPECT_EQ(vorbis_analyze(vorbis, stats, NULL, 0, NULL, 0, NULL), 3071);
+    for (int c = 0; c < 6; c++) {
+        EXPECT(stats[c].peak > 0);
+    }
+    vorbis_close(vorbis);
+
+    /* Pending integer samples should be scaled back exactly as they were
+     * converted, so the statistics don't depend on whether the data was
+     * still in the decode buffer. */
+    EXPECT(vorbis = TEST___open_file("tests/data/square-stereo.ogg",
+                                     VORBIS_OPTION_READ_INT16_ONLY, NULL));
+    EXPECT_EQ(vorbis_read_int16(vorbis, dummy16, 1, NULL), 1);
+    EXPECT_EQ(vorbis_analyze(vorbis, NULL, NULL, 1, block_stats, 1, NULL),
+              19);
+    EXPECT_FLTEQ(block_stats[0].peak, 8210 / 32767.0f);
+    EXPECT_FLTEQ(block_stats[1].peak, 4108 / 32767.0f);
+    vorbis_close(vorbis);
+
+    EXPECT(vorbis = TEST___open_file("tests/data/square-stereo.ogg",
+                                     VORBIS_OPTION_READ_INT24_ONLY, NULL));
+    uint8_t dummy24[2*3];
+    EXPECT_EQ(vorbis_read_int24(vorbis, dummy24, 1, NULL), 1);
+    EXPECT_EQ(vorbis_analyze(vorbis, NULL, NULL, 1, block_stats, 1, NULL),
+              19);
+    EXPECT_FLTEQ(block_stats[0].peak, 2101834 / 8388607.0f);
+    EXPECT_FLTEQ(block_stats[1].peak, 1051798 / 8388607.0f);
+    vorbis_close(vorbis);
+
+    EXPECT(vorbis = TEST___open_file("tests/data/square-stereo.ogg",
+                                     VORBIS_OPTION_READ_INT32_ONLY, NULL));
+    int32_t dummy32[2];
+    EXPECT_EQ(vorbis_read_int32(vorbis, dummy32, 1, NULL), 1);
+    EXPECT_EQ(vorbis_analyze(vorbis, NULL, NULL, 1, block_stats, 1, NULL),
+              19);
+    EXPECT_FLTEQ(block_stats[0].peak, (float)(538069632 / 2147483647.0));
+    EXPECT_FLTEQ(block_stats[1].peak, (float)(269260288 / 2147483647.0));
+    vorbis_close(vorbis);
+
+    EXPECT(vorbis = TEST___open_file("tests/data/zero-length.ogg", 0, NULL));
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_analyze(vorbis, stats, &loudness, 0, NULL, 0, &error),
+              0);
+    EXPECT_EQ(error, VORBIS_NO_ERROR);
+    EXPECT_EQ(stats[0].peak, 0);
+    EXPECT_EQ(stats[0].rms, 0);
+    EXPECT(isinf(loudness) && loudness < 0);
+    vorbis_close(vorbis);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,120 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "tests/common.h"
+
+#include <stdlib.h>
+
+
+/* Check that seeking to each of the given offsets in the given file
+ * returns the same data with and without a frame map.  The offsets are
+ * given as a start, end, and step. */
+static int check_file(const char *path, int64_t start, int64_t end,
+                      int64_t step)
+{
+    vorbis_t *reference, *vorbis;
+    if (!(reference = TEST___open_file(path, 0, NULL))) {
+        LOG("Failed to open %s", path);
+        return 0;
+    }
+    if (!(vorbis = TEST___open_file(path, 0, NULL))) {
+        LOG("Failed to open %s", path);
+        vorbis_close(reference);
+        return 0;
+    }
+    const int channels = vorbis_channels(vorbis);
+
+    vorbis_error_t error = (vorbis_error_t)-1;
+    if (!vorbis_build_frame_map(vorbis, &error)) {
+        LOG("%s: vorbis_build_frame_map() failed: %d", path, error);
+        goto fail;
+    }
+    if (error != VORBIS_NO_ERROR) {
+        LOG("%s: error was %d but should have been %d", path, error,
+            VORBIS_NO_ERROR);
+        goto fail;
+    }
+    if (vorbis_tell(vorbis) != 0) {
+        LOG("%s: position after building map was %lld", path,
+            (long long)vorbis_tell(vorbis));
+        goto fail;
+    }
+
+    for (int64_t offset = start; offset < end; offset += step) {
+        static float pcm[300*6], pcm2[300*6];
+        if (!vorbis_seek(reference, offset)) {
+            LOG("%s: reference seek to %lld failed", path, (long long)offset);
+            goto fail;
+        }
+        if (!vorbis_seek(vorbis, offset)) {
+            LOG("%s: seek to %lld failed", path, (long long)offset);
+            goto fail;
+        }
+        if (vorbis_tell(vorbis) != offset) {
+            LOG("%s: position after seek to %lld was %lld", path,
+                (long long)offset, (long long)vorbis_tell(vorbis));
+            goto fail;
+        }
+        const int count = vorbis_read_float(reference, pcm, 300, NULL);
+        if (vorbis_read_float(vorbis, pcm2, 300, NULL) != count) {
+            LOG("%s: read count after seek to %lld differed", path,
+                (long long)offset);
+            goto fail;
+        }
+        for (int i = 0; i < count * channels; i++) {
+            if (pcm2[i] != pcm[i]) {
+                LOG("%s: after seek to %lld, sample %d was %.8g but should"
+                    " have been %.8g", path, (long long)offset, i, pcm2[i],
+                    pcm[i]);
+                goto fail;
+            }
+        }
+    }
+
+    vorbis_close(vorbis);
+    vorbis_close(reference);
+    return 1;
+
+  fail:
+    vorbis_close(vorbis);
+    vorbis_close(reference);
+    return 0;
+}
+
+
+int main(void)
+{
+    EXPECT(check_file("tests/data/square.ogg", 0, 40, 1));
+    EXPECT(check_file("tests/data/long-short.ogg", 0, 1492, 1));
+    EXPECT(check_file("tests/data/6ch-all-page-types.ogg", 0, 8500, 7));
+    EXPECT(check_file("tests/data/thingy.ogg", 0, 6602752, 65537));
+    EXPECT(check_file("tests/data/thingy.ogg", 3000000, 3010000, 113));
+
+    /* Building the map should not change the decode position. */
+    vorbis_t *reference, *vorbis;
+    EXPECT(reference = TEST___open_file("tests/data/thingy.ogg", 0, NULL));
+    EXPECT(vorbis = TEST___open_file("tests/data/thingy.ogg", 0, NULL));
+    static float pcm[10000], pcm2[5000];
+    EXPECT_EQ(vorbis_read_float(reference, pcm, 10000, NULL), 10000);
+    EXPECT_EQ(vorbis_read_float(vorbis, pcm2, 5000, NULL), 5000);
+    EXPECT(vorbis_build_frame_map(vorbis, NULL));
+    EXPECT_EQ(vorbis_tell(vorbis), 5000);
+    EXPECT_EQ(vorbis_read_float(vorbis, pcm2, 5000, NULL), 5000);
+    for (int i = 0; i < 5000; i++) {
+        if (pcm2[i] != pcm[5000+i]) {
+            FAIL("After building map, sample %d was %.8g but should have"
+                 " been %.8g", 5000+i, pcm2[i], pcm[5000+i]);
+        }
+    }
+    vorbis_close(vorbis);
+    vorbis_close(reference);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,95 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "tests/common.h"
+
+#include "tests/data/square_float.h"  // Defines expected_pcm[].
+
+/* Stream data and read state for the memory callbacks. */
+static const char *stream_data;
+static long stream_size;
+static long read_pos;
+
+static int32_t memory_read(void *opaque, void *buffer, int32_t length)
+{
+    (void) opaque;
+    if (length > stream_size - read_pos) {
+        length = (int32_t)(stream_size - read_pos);
+    }
+    memcpy(buffer, stream_data + read_pos, length);
+    read_pos += length;
+    return length;
+}
+
+static const vorbis_callbacks_t memory_callbacks = {.read = memory_read};
+
+
+int main(void)
+{
+    vorbis_error_t error;
+
+    /* A read callback is required. */
+    error = (vorbis_error_t)-1;
+    EXPECT_FALSE(vorbis_mux_open_callbacks(
+                     ((vorbis_callbacks_t){.read = NULL}), NULL, 0, &error));
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+
+    /* Non-Ogg data should be rejected. */
+    static const char garbage[] = "This is not an Ogg file.";
+    stream_data = garbage;
+    stream_size = sizeof(garbage);
+    read_pos = 0;
+    error = (vorbis_error_t)-1;
+    EXPECT_FALSE(vorbis_mux_open_callbacks(memory_callbacks, NULL, 0,
+                                           &error));
+    EXPECT_EQ(error, VORBIS_ERROR_STREAM_INVALID);
+
+    /* A file with a single stream should work as usual. */
+    FILE *f;
+    EXPECT(f = fopen("tests/data/square.ogg", "rb"));
+    EXPECT_EQ(fseek(f, 0, SEEK_END), 0);
+    EXPECT_GT(stream_size = ftell(f), 0);
+    EXPECT_EQ(fseek(f, 0, SEEK_SET), 0);
+    char *data;
+    EXPECT(data = malloc(stream_size));
+    EXPECT_EQ(fread(data, 1, stream_size, f), (size_t)stream_size);
+    fclose(f);
+    stream_data = data;
+    read_pos = 0;
+    vorbis_mux_t *mux;
+    EXPECT(mux = vorbis_mux_open_callbacks(memory_callbacks, NULL, 0, NULL));
+    EXPECT_EQ(vorbis_mux_streams(mux), 1);
+    vorbis_t *vorbis;
+    EXPECT(vorbis = vorbis_mux_stream(mux, 0));
+    float pcm[41];
+    int len = 0;
+    int index;
+    while ((index = vorbis_mux_next(mux, NULL)) >= 0) {
+        EXPECT_EQ(index, 0);
+        len += vorbis_read_float(vorbis, pcm + len, 41 - len, NULL);
+    }
+    EXPECT_EQ(len, 40);
+    COMPARE_PCM_FLOAT(pcm, expected_pcm, 40);
+    vorbis_mux_close(mux);
+
+    /* A file truncated within the headers should be rejected. */
+    stream_size = 200;
+    read_pos = 0;
+    error = (vorbis_error_t)-1;
+    EXPECT_FALSE(vorbis_mux_open_callbacks(memory_callbacks, NULL, 0,
+                                           &error));
+    EXPECT_EQ(error, VORBIS_ERROR_STREAM_INVALID);
+
+    /* Closing a null handle should do nothing. */
+    vorbis_mux_close(NULL);
+
+    free(data);
+    return EXIT_SUCCESS;
+}
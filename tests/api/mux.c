@@ -0,0 +1,114 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "tests/common.h"
+
+#define expected_pcm expected_pcm_mono
+#include "tests/data/square_float.h"
+#undef expected_pcm
+#define expected_pcm expected_pcm_stereo
+#include "tests/data/square-stereo_float.h"
+#undef expected_pcm
+
+/* Stream data and read state for the memory callbacks. */
+static char *file_data;
+static long file_size;
+static long read_pos;
+static long total_read;
+
+static int32_t memory_read(void *opaque, void *buffer, int32_t length)
+{
+    (void) opaque;
+    if (length > file_size - read_pos) {
+        length = (int32_t)(file_size - read_pos);
+    }
+    memcpy(buffer, file_data + read_pos, length);
+    read_pos += length;
+    total_read += length;
+    return length;
+}
+
+static int close_count;
+static void memory_close(void *opaque)
+{
+    (void) opaque;
+    close_count++;
+}
+
+
+int main(void)
+{
+    FILE *f;
+    EXPECT(f = fopen("tests/data/square-interleaved.ogg", "rb"));
+    EXPECT_EQ(fseek(f, 0, SEEK_END), 0);
+    EXPECT_GT(file_size = ftell(f), 0);
+    EXPECT_EQ(fseek(f, 0, SEEK_SET), 0);
+    EXPECT(file_data = malloc(file_size));
+    EXPECT_EQ(fread(file_data, 1, file_size, f), (size_t)file_size);
+    fclose(f);
+
+    vorbis_mux_t *mux;
+    vorbis_error_t error = (vorbis_error_t)-1;
+    EXPECT(mux = vorbis_mux_open_callbacks(
+               ((vorbis_callbacks_t){.read = memory_read,
+                                     .close = memory_close}),
+               NULL, 0, &error));
+    EXPECT_EQ(error, VORBIS_NO_ERROR);
+    EXPECT_EQ(vorbis_mux_streams(mux), 2);
+    vorbis_t *mono, *stereo;
+    EXPECT(mono = vorbis_mux_stream(mux, 0));
+    EXPECT(stereo = vorbis_mux_stream(mux, 1));
+    EXPECT_FALSE(vorbis_mux_stream(mux, 2));
+    EXPECT_FALSE(vorbis_mux_stream(mux, -1));
+    EXPECT_EQ(vorbis_channels(mono), 1);
+    EXPECT_EQ(vorbis_channels(stereo), 2);
+
+    float mono_pcm[41], stereo_pcm[41*2];
+    int mono_len = 0, stereo_len = 0;
+    int index;
+    while ((index = vorbis_mux_next(mux, &error)) >= 0) {
+        EXPECT_EQ(error, VORBIS_NO_ERROR);
+        if (index == 0) {
+            int count;
+            while ((count = vorbis_read_float(
+                        mono, mono_pcm + mono_len, 41 - mono_len,
+                        &error)) > 0) {
+                mono_len += count;
+            }
+        } else {
+            EXPECT_EQ(index, 1);
+            int count;
+            while ((count = vorbis_read_float(
+                        stereo, stereo_pcm + stereo_len*2, 41 - stereo_len,
+                        &error)) > 0) {
+                stereo_len += count;
+            }
+        }
+        EXPECT_EQ(error, VORBIS_ERROR_STREAM_END);
+    }
+    EXPECT_EQ(error, VORBIS_ERROR_STREAM_END);
+    EXPECT_EQ(vorbis_mux_next(mux, &error), -1);
+    EXPECT_EQ(error, VORBIS_ERROR_STREAM_END);
+
+    EXPECT_EQ(mono_len, 40);
+    COMPARE_PCM_FLOAT(mono_pcm, expected_pcm_mono, 40);
+    EXPECT_EQ(vorbis_tell(mono), 40);
+    EXPECT_EQ(stereo_len, 20);
+    COMPARE_PCM_FLOAT(stereo_pcm, expected_pcm_stereo, 40);
+    EXPECT_EQ(vorbis_tell(stereo), 20);
+
+    /* The file should have been read exactly once. */
+    EXPECT_EQ(total_read, file_size);
+
+    vorbis_mux_close(mux);
+    EXPECT_EQ(close_count, 1);
+    free(file_data);
+    return EXIT_SUCCESS;
+}
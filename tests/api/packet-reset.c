@@ -0,0 +1,144 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "tests/common.h"
+
+/* Number of audio packets to decode from the test stream. */
+#define NUM_PACKETS  100
+
+/* Maximum number of samples to keep from the reference decode. */
+#define MAX_SAMPLES  (NUM_PACKETS * 4096)
+
+
+/* Packet data extracted from the test stream (headers first). */
+static const uint8_t *packets[NUM_PACKETS + 3];
+static int32_t packet_len[NUM_PACKETS + 3];
+
+/* Reference PCM data and packet start positions. */
+static float expect[MAX_SAMPLES];
+static int64_t packet_pos[NUM_PACKETS];
+static int32_t packet_samples[NUM_PACKETS];
+
+/*-----------------------------------------------------------------------*/
+
+/* Split the given Ogg stream into packets, storing pointers to the packet
+ * data in packets[] (the stream is modified in place to make packets
+ * contiguous).  Return the number of packets found. */
+static int split_packets(uint8_t *data, long size)
+{
+    int num_packets = 0;
+    uint8_t *out = data;  // Data is compacted toward the start of the buffer.
+    uint8_t *packet_start = out;
+    long pos = 0;
+    while (pos + 27 <= size && num_packets < NUM_PACKETS + 3) {
+        const int num_segments = data[pos+26];
+        uint8_t lacing[255];  // Copied since the header may be overwritten.
+        memcpy(lacing, &data[pos+27], num_segments);
+        long segment_pos = pos + 27 + num_segments;
+        for (int i = 0; i < num_segments && num_packets < NUM_PACKETS + 3;
+             i++)
+        {
+            memmove(out, &data[segment_pos], lacing[i]);
+            out += lacing[i];
+            segment_pos += lacing[i];
+            if (lacing[i] < 255) {
+                packets[num_packets] = packet_start;
+                packet_len[num_packets] = (int32_t)(out - packet_start);
+                num_packets++;
+                packet_start = out;
+            }
+        }
+        pos = segment_pos;
+    }
+    return num_packets;
+}
+
+/*-----------------------------------------------------------------------*/
+
+/* Submit the given packet and append all resulting samples to buf, which
+ * has room for bufsize samples.  Return the number of samples read, or -1
+ * on error. */
+static int32_t submit_and_read(vorbis_t *vorbis, int index, float *buf,
+                               int32_t bufsize)
+{
+    vorbis_error_t error;
+    if (!vorbis_submit_packet(vorbis, packets[index], packet_len[index],
+                              &error)) {
+        LOG("submit of packet %d failed: %d", index, error);
+        return -1;
+    }
+    int32_t total = 0, count;
+    while ((count = vorbis_read_float(vorbis, buf + total, bufsize - total,
+                                      &error)) > 0) {
+        total += count;
+    }
+    if (error != VORBIS_ERROR_STREAM_END) {
+        LOG("read of packet %d failed: %d", index, error);
+        return -1;
+    }
+    return total;
+}
+
+/*************************************************************************/
+/*************************************************************************/
+
+int main(void)
+{
+    FILE *f;
+    uint8_t *data;
+    long size;
+    EXPECT(f = fopen("tests/data/thingy.ogg", "rb"));
+    EXPECT_EQ(fseek(f, 0, SEEK_END), 0);
+    EXPECT_GT(size = ftell(f), 0);
+    EXPECT_EQ(fseek(f, 0, SEEK_SET), 0);
+    EXPECT(data = malloc(size));
+    EXPECT_EQ(fread(data, 1, size, f), size);
+    fclose(f);
+    EXPECT_EQ(split_packets(data, size), NUM_PACKETS + 3);
+
+    vorbis_t *vorbis;
+    vorbis_callbacks_t callbacks = {.malloc = NULL, .free = NULL};
+    EXPECT(vorbis = vorbis_open_packet(packets[0], packet_len[0],
+                                       packets[2], packet_len[2],
+                                       callbacks, NULL, 0, NULL));
+
+    /* Decode the stream straight through to get reference data. */
+    for (int i = 0; i < NUM_PACKETS; i++) {
+        packet_pos[i] = vorbis_tell(vorbis);
+        const int32_t count = submit_and_read(
+            vorbis, 3+i, expect + packet_pos[i], MAX_SAMPLES - packet_pos[i]);
+        EXPECT(count >= 0);
+        packet_samples[i] = count;
+    }
+
+    /* Jump backward and forward within the stream, priming the decoder
+     * with the preceding packet each time. */
+    static const int targets[] = {50, 10, 80, 2, 99, 51};
+    for (int i = 0; i < (int)(sizeof(targets) / sizeof(*targets)); i++) {
+        const int target = targets[i];
+        float buf[4096];
+        vorbis_error_t error = (vorbis_error_t)-1;
+        EXPECT(vorbis_packet_reset(vorbis, packet_pos[target], &error));
+        EXPECT_EQ(error, VORBIS_NO_ERROR);
+        EXPECT_EQ(vorbis_tell(vorbis), packet_pos[target]);
+        EXPECT_EQ(submit_and_read(vorbis, 3+target-1, buf, 4096), 0);
+        EXPECT_EQ(vorbis_tell(vorbis), packet_pos[target]);
+        EXPECT_EQ(submit_and_read(vorbis, 3+target, buf, 4096),
+                  packet_samples[target]);
+        EXPECT_EQ(vorbis_tell(vorbis),
+                  packet_pos[target] + packet_samples[target]);
+        COMPARE_PCM_FLOAT(buf, expect + packet_pos[target],
+                          packet_samples[target]);
+    }
+
+    vorbis_close(vorbis);
+    free(data);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,55 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "tests/common.h"
+
+#include <math.h>
+
+
+int main(void)
+{
+    /* As in read-int32-6ch, we compare against the float output of a
+     * second decoder. */
+    vorbis_t *vorbis, *vorbis_float;
+    EXPECT(vorbis = TEST___open_file("tests/data/6ch-moving-sine.ogg",
+                                     0, NULL));
+    EXPECT(vorbis_float = TEST___open_file("tests/data/6ch-moving-sine.ogg",
+                                           0, NULL));
+
+    static uint8_t pcm[3073*6*3];
+    static float pcm_float[3072*6];
+    vorbis_error_t error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_read_int24(vorbis, pcm, 3073, &error), 3072);
+    EXPECT_EQ(error, VORBIS_ERROR_STREAM_END);
+    EXPECT_EQ(vorbis_read_float(vorbis_float, pcm_float, 3072, NULL), 3072);
+
+    for (int i = 0; i < 3072*6; i++) {
+        const float sample = pcm_float[i];
+        int32_t expected;
+        if (sample < -1.0f) {
+            expected = -8388607;
+        } else if (sample <= 1.0f) {
+            expected = (int32_t)rintf(sample * 8388607.0f);
+        } else {
+            expected = 8388607;
+        }
+        const int32_t value = (int32_t)((uint32_t)pcm[i*3+0] << 8
+                                        | (uint32_t)pcm[i*3+1] << 16
+                                        | (uint32_t)pcm[i*3+2] << 24) >> 8;
+        if (value != expected) {
+            FAIL("Sample %d was %d but should have been %d",
+                 i, value, expected);
+        }
+    }
+
+    vorbis_close(vorbis);
+    vorbis_close(vorbis_float);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,43 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "tests/common.h"
+
+
+int main(void)
+{
+    vorbis_t *vorbis;
+    EXPECT(vorbis = TEST___open_file("tests/data/square.ogg", 0, NULL));
+
+    uint8_t pcm[4];
+    vorbis_error_t error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_read_int24(vorbis, NULL, 1, &error), 0);
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_read_int24(vorbis, pcm, -1, &error), 0);
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+    vorbis_close(vorbis);
+
+    EXPECT(vorbis = TEST___open_file("tests/data/square.ogg",
+                                     VORBIS_OPTION_READ_INT16_ONLY, NULL));
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_read_int24(vorbis, pcm, 1, &error), 0);
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_OPERATION);
+    vorbis_close(vorbis);
+
+    EXPECT(vorbis = TEST___open_file("tests/data/square.ogg",
+                                     VORBIS_OPTION_READ_INT32_ONLY, NULL));
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_read_int24(vorbis, pcm, 1, &error), 0);
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_OPERATION);
+    vorbis_close(vorbis);
+
+    return EXIT_SUCCESS;
+}
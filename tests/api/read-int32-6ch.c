@@ -0,0 +1,53 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "tests/common.h"
+
+#include <math.h>
+
+
+int main(void)
+{
+    /* We compare against the float output of a second decoder rather
+     * than a fixed table so that the test is not sensitive to the last
+     * few bits of decoder precision. */
+    vorbis_t *vorbis, *vorbis_float;
+    EXPECT(vorbis = TEST___open_file("tests/data/6ch-moving-sine.ogg",
+                                     0, NULL));
+    EXPECT(vorbis_float = TEST___open_file("tests/data/6ch-moving-sine.ogg",
+                                           0, NULL));
+
+    static int32_t pcm[3073*6];
+    static float pcm_float[3072*6];
+    vorbis_error_t error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_read_int32(vorbis, pcm, 3073, &error), 3072);
+    EXPECT_EQ(error, VORBIS_ERROR_STREAM_END);
+    EXPECT_EQ(vorbis_read_float(vorbis_float, pcm_float, 3072, NULL), 3072);
+
+    for (int i = 0; i < 3072*6; i++) {
+        const float sample = pcm_float[i];
+        int32_t expected;
+        if (sample <= -1.0f) {
+            expected = -2147483647;
+        } else if (sample < 1.0f) {
+            expected = (int32_t)rint(sample * 2147483647.0);
+        } else {
+            expected = 2147483647;
+        }
+        if (pcm[i] != expected) {
+            FAIL("Sample %d was %d but should have been %d",
+                 i, pcm[i], expected);
+        }
+    }
+
+    vorbis_close(vorbis);
+    vorbis_close(vorbis_float);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,44 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "tests/common.h"
+
+
+static int32_t read(void *opaque, void *buf, int32_t len)
+{
+    return fread(buf, 1, len, (FILE *)opaque);
+}
+
+
+int main(void)
+{
+    vorbis_t *vorbis;
+    vorbis_error_t error;
+
+    EXPECT(vorbis = TEST___open_file("tests/data/square.ogg", 0, NULL));
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_seek_approximate(vorbis, -1, &error), -1);
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+    /* The error return pointer is optional. */
+    EXPECT_EQ(vorbis_seek_approximate(vorbis, 20, NULL), 20);
+    vorbis_close(vorbis);
+
+    FILE *f;
+    EXPECT(f = fopen("tests/data/square.ogg", "rb"));
+    EXPECT(vorbis = vorbis_open_callbacks(
+               ((const vorbis_callbacks_t){.read = read}), f, 0, NULL));
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_seek_approximate(vorbis, 0, &error), -1);
+    EXPECT_EQ(error, VORBIS_ERROR_STREAM_NOT_SEEKABLE);
+    vorbis_close(vorbis);
+    fclose(f);
+
+    return EXIT_SUCCESS;
+}
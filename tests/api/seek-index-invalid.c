@@ -0,0 +1,102 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "tests/common.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+
+static int32_t read(void *opaque, void *buf, int32_t len)
+{
+    return fread(buf, 1, len, (FILE *)opaque);
+}
+
+
+int main(void)
+{
+    vorbis_t *vorbis;
+    vorbis_error_t error;
+
+    /* Unseekable streams cannot have an index. */
+    FILE *f;
+    EXPECT(f = fopen("tests/data/square.ogg", "rb"));
+    EXPECT(vorbis = vorbis_open_callbacks(
+               ((const vorbis_callbacks_t){.read = read}), f, 0, NULL));
+    error = (vorbis_error_t)-1;
+    EXPECT_FALSE(vorbis_build_seek_index(vorbis, &error));
+    EXPECT_EQ(error, VORBIS_ERROR_STREAM_NOT_SEEKABLE);
+    error = (vorbis_error_t)-1;
+    EXPECT_FALSE(vorbis_load_seek_index(vorbis, "NgSx", 4, &error));
+    EXPECT_EQ(error, VORBIS_ERROR_STREAM_NOT_SEEKABLE);
+    vorbis_close(vorbis);
+    fclose(f);
+
+    /* Export fails if there is no index. */
+    EXPECT(vorbis = TEST___open_file("tests/data/square.ogg", 0, NULL));
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_export_seek_index(vorbis, NULL, 0, &error), 0);
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_OPERATION);
+
+    /* A buffer which is too small is rejected, but the required size is
+     * still returned. */
+    EXPECT(vorbis_build_seek_index(vorbis, NULL));
+    const int32_t size = vorbis_export_seek_index(vorbis, NULL, 0, NULL);
+    EXPECT_GT(size, 5);
+    char data[256];
+    EXPECT(size <= (int32_t)sizeof(data));
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_export_seek_index(vorbis, data, size-1, &error), size);
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_export_seek_index(vorbis, data, -1, &error), 0);
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+    EXPECT_EQ(vorbis_export_seek_index(vorbis, data, size, NULL), size);
+    vorbis_close(vorbis);
+
+    /* Invalid, truncated, or corrupted data is rejected. */
+    EXPECT(vorbis = TEST___open_file("tests/data/square.ogg", 0, NULL));
+    error = (vorbis_error_t)-1;
+    EXPECT_FALSE(vorbis_load_seek_index(vorbis, NULL, size, &error));
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+    for (int32_t i = 0; i < size; i++) {
+        error = (vorbis_error_t)-1;
+        if (vorbis_load_seek_index(vorbis, data, i, &error)) {
+            FAIL("Truncated data (%d of %d bytes) was accepted", i, size);
+        }
+        EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+    }
+    char bad_data[256];
+    for (int32_t i = 0; i < size; i++) {
+        for (int32_t j = 0; j < size; j++) {
+            bad_data[j] = data[j];
+        }
+        bad_data[i] ^= 0x01;
+        error = (vorbis_error_t)-1;
+        if (vorbis_load_seek_index(vorbis, bad_data, size, &error)) {
+            /* Some bit flips yield a different but still valid index;
+             * that's acceptable as long as the library doesn't crash. */
+            continue;
+        }
+        EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+    }
+    EXPECT(vorbis_load_seek_index(vorbis, data, size, NULL));
+    vorbis_close(vorbis);
+
+    /* An index for a different stream is rejected. */
+    EXPECT(vorbis = TEST___open_file("tests/data/square-stereo.ogg", 0,
+                                     NULL));
+    error = (vorbis_error_t)-1;
+    EXPECT_FALSE(vorbis_load_seek_index(vorbis, data, size, &error));
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+    vorbis_close(vorbis);
+
+    return EXIT_SUCCESS;
+}
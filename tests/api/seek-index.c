@@ -0,0 +1,119 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "tests/common.h"
+
+#include <stdlib.h>
+
+
+/* Seek both handles to the given position and check that they return
+ * identical data from that point. */
+static int check_seek(vorbis_t *vorbis, vorbis_t *reference, int64_t offset)
+{
+    static float pcm[1000], pcm2[1000];
+    if (!vorbis_seek(reference, offset)) {
+        LOG("Reference seek to %lld failed", (long long)offset);
+        return 0;
+    }
+    if (!vorbis_seek(vorbis, offset)) {
+        LOG("Indexed seek to %lld failed", (long long)offset);
+        return 0;
+    }
+    if (vorbis_tell(vorbis) != offset) {
+        LOG("After seek to %lld, position was %lld", (long long)offset,
+            (long long)vorbis_tell(vorbis));
+        return 0;
+    }
+    const int count = vorbis_read_float(reference, pcm, 1000, NULL);
+    if (vorbis_read_float(vorbis, pcm2, 1000, NULL) != count) {
+        LOG("After seek to %lld, read count differed", (long long)offset);
+        return 0;
+    }
+    for (int i = 0; i < count; i++) {
+        if (pcm2[i] != pcm[i]) {
+            LOG("After seek to %lld, sample %d was %.8g but should have"
+                " been %.8g", (long long)offset, i, pcm2[i], pcm[i]);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+int main(void)
+{
+    static const int64_t offsets[] = {
+        0, 1, 4000, 123456, 3000000, 6601752, 6602751, 6602752, 2000000};
+
+    vorbis_t *reference;
+    EXPECT(reference = TEST___open_file("tests/data/thingy.ogg", 0, NULL));
+
+    vorbis_t *vorbis;
+    vorbis_error_t error = (vorbis_error_t)-1;
+    EXPECT(vorbis = TEST___open_file("tests/data/thingy.ogg", 0, NULL));
+
+    /* Building the index should not disturb the decode position. */
+    static float pcm[10000], pcm2[5000];
+    EXPECT_EQ(vorbis_read_float(reference, pcm, 10000, NULL), 10000);
+    EXPECT_EQ(vorbis_read_float(vorbis, pcm2, 5000, NULL), 5000);
+    EXPECT(vorbis_build_seek_index(vorbis, &error));
+    EXPECT_EQ(error, VORBIS_NO_ERROR);
+    EXPECT_EQ(vorbis_tell(vorbis), 5000);
+    EXPECT_EQ(vorbis_read_float(vorbis, pcm2, 5000, NULL), 5000);
+    for (int i = 0; i < 5000; i++) {
+        if (pcm2[i] != pcm[5000+i]) {
+            FAIL("After building index, sample %d was %.8g but should have"
+                 " been %.8g", 5000+i, pcm2[i], pcm[5000+i]);
+        }
+    }
+
+    EXPECT_EQ(vorbis_length(vorbis), 6602752);
+    for (int i = 0; i < (int)(sizeof(offsets)/sizeof(*offsets)); i++) {
+        EXPECT(check_seek(vorbis, reference, offsets[i]));
+    }
+
+    /* Export the index and load it into a fresh handle. */
+    error = (vorbis_error_t)-1;
+    const int32_t size = vorbis_export_seek_index(vorbis, NULL, 0, &error);
+    EXPECT_EQ(error, VORBIS_NO_ERROR);
+    EXPECT_GT(size, 0);
+    char *data;
+    EXPECT(data = malloc(size));
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_export_seek_index(vorbis, data, size, &error), size);
+    EXPECT_EQ(error, VORBIS_NO_ERROR);
+    vorbis_close(vorbis);
+
+    EXPECT(vorbis = TEST___open_file("tests/data/thingy.ogg", 0, NULL));
+    error = (vorbis_error_t)-1;
+    EXPECT(vorbis_load_seek_index(vorbis, data, size, &error));
+    EXPECT_EQ(error, VORBIS_NO_ERROR);
+    EXPECT_EQ(vorbis_length(vorbis), 6602752);
+    for (int i = 0; i < (int)(sizeof(offsets)/sizeof(*offsets)); i++) {
+        EXPECT(check_seek(vorbis, reference, offsets[i]));
+    }
+
+    /* The reloaded index should export to the same data. */
+    char *data2;
+    EXPECT(data2 = malloc(size));
+    EXPECT_EQ(vorbis_export_seek_index(vorbis, data2, size, NULL), size);
+    for (int i = 0; i < size; i++) {
+        if (data2[i] != data[i]) {
+            FAIL("Reexported byte %d was 0x%02X but should have been 0x%02X",
+                 i, (uint8_t)data2[i], (uint8_t)data[i]);
+        }
+    }
+
+    free(data2);
+    free(data);
+    vorbis_close(vorbis);
+    vorbis_close(reference);
+    return EXIT_SUCCESS;
+}
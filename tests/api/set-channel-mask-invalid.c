@@ -0,0 +1,38 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "tests/common.h"
+
+
+int main(void)
+{
+    vorbis_t *vorbis;
+    EXPECT(vorbis = TEST___open_file("tests/data/square-stereo.ogg",
+                                     0, NULL));
+
+    vorbis_error_t error = (vorbis_error_t)-1;
+    EXPECT_FALSE(vorbis_set_channel_mask(vorbis, 0, &error));
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+    error = (vorbis_error_t)-1;
+    EXPECT_FALSE(vorbis_set_channel_mask(vorbis, 0x4, &error));
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+
+    /* A failed call should leave the previous mask in effect. */
+    float pcm[20*2];
+    EXPECT_EQ(vorbis_read_float(vorbis, pcm, 20, NULL), 20);
+    int nonzero = 0;
+    for (int i = 0; i < 20; i++) {
+        nonzero += (pcm[i*2+0] != 0) + (pcm[i*2+1] != 0);
+    }
+    EXPECT_GT(nonzero, 20);
+
+    vorbis_close(vorbis);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,61 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "tests/common.h"
+
+
+int main(void)
+{
+    /* Selected channels should be bit-identical to a full decode, and
+     * unselected channels should be silent.  Check every single-channel
+     * mask (which exercises the coupling dependencies between channel
+     * pairs) as well as a few multichannel masks. */
+    static const uint64_t masks[] = {
+        1<<0, 1<<1, 1<<2, 1<<3, 1<<4, 1<<5, 0x05, 0x18, 0x2A,
+        /* Bits beyond the stream's channel count are ignored. */
+        0x42,
+    };
+
+    vorbis_t *vorbis_full;
+    EXPECT(vorbis_full = TEST___open_file("tests/data/6ch-all-page-types.ogg",
+                                          0, NULL));
+    static float pcm_full[8500*6];
+    EXPECT_EQ(vorbis_read_float(vorbis_full, pcm_full, 8500, NULL), 8500);
+    vorbis_close(vorbis_full);
+
+    for (int i = 0; i < (int)(sizeof(masks)/sizeof(*masks)); i++) {
+        const uint64_t mask = masks[i];
+        vorbis_t *vorbis;
+        EXPECT(vorbis = TEST___open_file("tests/data/6ch-all-page-types.ogg",
+                                         0, NULL));
+        vorbis_error_t error = (vorbis_error_t)-1;
+        EXPECT(vorbis_set_channel_mask(vorbis, mask, &error));
+        EXPECT_EQ(error, VORBIS_NO_ERROR);
+
+        static float pcm[8501*6];
+        error = (vorbis_error_t)-1;
+        EXPECT_EQ(vorbis_read_float(vorbis, pcm, 8501, &error), 8500);
+        EXPECT_EQ(error, VORBIS_ERROR_STREAM_END);
+        for (int j = 0; j < 8500*6; j++) {
+            const int channel = j % 6;
+            const float expected =
+                (mask & (UINT64_C(1) << channel)) ? pcm_full[j] : 0.0f;
+            if (pcm[j] != expected) {
+                FAIL("Mask 0x%X: sample %d channel %d was %.8g but should"
+                     " have been %.8g", (unsigned int)mask, j/6, channel,
+                     pcm[j], expected);
+            }
+        }
+
+        vorbis_close(vorbis);
+    }
+
+    return EXIT_SUCCESS;
+}
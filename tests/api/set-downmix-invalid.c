@@ -0,0 +1,52 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "tests/common.h"
+
+
+int main(void)
+{
+    static const float matrix[3*2] = {1, 0, 0, 1, 0.5f, 0.5f};
+
+    vorbis_t *vorbis;
+    EXPECT(vorbis = TEST___open_file("tests/data/square-stereo.ogg",
+                                     0, NULL));
+
+    vorbis_error_t error = (vorbis_error_t)-1;
+    EXPECT_FALSE(vorbis_set_downmix(vorbis, -1, matrix, &error));
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+    error = (vorbis_error_t)-1;
+    EXPECT_FALSE(vorbis_set_downmix(vorbis, 3, matrix, &error));
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+    error = (vorbis_error_t)-1;
+    EXPECT_FALSE(vorbis_set_downmix(vorbis, 1, NULL, &error));
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+    EXPECT_EQ(vorbis_channels(vorbis), 2);
+
+    /* Setting and then clearing the downmix should restore the original
+     * channel count. */
+    EXPECT(vorbis_set_downmix(vorbis, 1, &matrix[4], NULL));
+    EXPECT_EQ(vorbis_channels(vorbis), 1);
+    error = (vorbis_error_t)-1;
+    EXPECT(vorbis_set_downmix(vorbis, 0, NULL, &error));
+    EXPECT_EQ(error, VORBIS_NO_ERROR);
+    EXPECT_EQ(vorbis_channels(vorbis), 2);
+
+    /* The downmix cannot be changed once decoding has started. */
+    float pcm[2];
+    EXPECT_EQ(vorbis_read_float(vorbis, pcm, 1, NULL), 1);
+    error = (vorbis_error_t)-1;
+    EXPECT_FALSE(vorbis_set_downmix(vorbis, 1, &matrix[4], &error));
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_OPERATION);
+    EXPECT_EQ(vorbis_channels(vorbis), 2);
+
+    vorbis_close(vorbis);
+    return EXIT_SUCCESS;
+}
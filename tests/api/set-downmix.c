@@ -0,0 +1,86 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "tests/common.h"
+
+#include <math.h>
+
+
+/* Standard 5.1-to-stereo mix for Vorbis channel order (FL, C, FR, RL, RR,
+ * LFE). */
+static const float matrix[2*6] = {
+    0.5f, 0.35f, 0.0f, 0.35f, 0.0f,  0.0f,
+    0.0f, 0.35f, 0.5f, 0.0f,  0.35f, 0.0f,
+};
+
+/*-----------------------------------------------------------------------*/
+
+/* Returns true if all samples in pcm match the mix of pcm_6ch. */
+static int check_mix(const float *pcm, const float *pcm_6ch, int samples)
+{
+    for (int i = 0; i < samples; i++) {
+        for (int o = 0; o < 2; o++) {
+            float expected = 0;
+            for (int c = 0; c < 6; c++) {
+                expected += pcm_6ch[i*6+c] * matrix[o*6+c];
+            }
+            if (fabsf(pcm[i*2+o] - expected) > 1.0e-6f) {
+                LOG("Sample %d channel %d was %.8g but should have been"
+                    " %.8g", i, o, pcm[i*2+o], expected);
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+/*-----------------------------------------------------------------------*/
+
+int main(void)
+{
+    vorbis_t *vorbis, *vorbis_6ch;
+    EXPECT(vorbis = TEST___open_file("tests/data/6ch-moving-sine.ogg",
+                                     0, NULL));
+    EXPECT(vorbis_6ch = TEST___open_file("tests/data/6ch-moving-sine.ogg",
+                                         0, NULL));
+    vorbis_error_t error = (vorbis_error_t)-1;
+    EXPECT(vorbis_set_downmix(vorbis, 2, matrix, &error));
+    EXPECT_EQ(error, VORBIS_NO_ERROR);
+    EXPECT_EQ(vorbis_channels(vorbis), 2);
+
+    static float pcm[3073*2], pcm_6ch[3072*6];
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_read_float(vorbis, pcm, 3073, &error), 3072);
+    EXPECT_EQ(error, VORBIS_ERROR_STREAM_END);
+    EXPECT_EQ(vorbis_read_float(vorbis_6ch, pcm_6ch, 3072, NULL), 3072);
+    EXPECT(check_mix(pcm, pcm_6ch, 3072));
+    vorbis_close(vorbis);
+    vorbis_close(vorbis_6ch);
+
+    /* The mix should be applied after resampling, regardless of the
+     * order in which the two are configured. */
+    EXPECT(vorbis = TEST___open_file("tests/data/6ch-moving-sine.ogg",
+                                     0, NULL));
+    EXPECT(vorbis_6ch = TEST___open_file("tests/data/6ch-moving-sine.ogg",
+                                         0, NULL));
+    EXPECT(vorbis_set_downmix(vorbis, 2, matrix, NULL));
+    EXPECT(vorbis_set_output_rate(vorbis, 48000,
+                                  VORBIS_RESAMPLE_QUALITY_LOW, NULL));
+    EXPECT(vorbis_set_output_rate(vorbis_6ch, 48000,
+                                  VORBIS_RESAMPLE_QUALITY_LOW, NULL));
+    static float pcm_rs[3344*2], pcm_rs_6ch[3344*6];
+    EXPECT_EQ(vorbis_read_float(vorbis, pcm_rs, 3344, NULL), 3344);
+    EXPECT_EQ(vorbis_read_float(vorbis_6ch, pcm_rs_6ch, 3344, NULL), 3344);
+    EXPECT(check_mix(pcm_rs, pcm_rs_6ch, 3344));
+    vorbis_close(vorbis);
+    vorbis_close(vorbis_6ch);
+
+    return EXIT_SUCCESS;
+}
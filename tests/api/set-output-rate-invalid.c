@@ -0,0 +1,76 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "tests/common.h"
+
+
+int main(void)
+{
+    vorbis_t *vorbis;
+    EXPECT(vorbis = TEST___open_file("tests/data/square.ogg", 0, NULL));
+
+    vorbis_error_t error = (vorbis_error_t)-1;
+    EXPECT_FALSE(vorbis_set_output_rate(vorbis, 8000, -1, &error));
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+    error = (vorbis_error_t)-1;
+    EXPECT_FALSE(vorbis_set_output_rate(
+                     vorbis, 8000, VORBIS_RESAMPLE_QUALITY_HIGH + 1, &error));
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+    error = (vorbis_error_t)-1;
+    EXPECT_FALSE(vorbis_set_output_rate(
+                     vorbis, 2000000, VORBIS_RESAMPLE_QUALITY_LOW, &error));
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+    /* Ratios beyond 16:1 in either direction are rejected. */
+    error = (vorbis_error_t)-1;
+    EXPECT_FALSE(vorbis_set_output_rate(
+                     vorbis, 64001, VORBIS_RESAMPLE_QUALITY_LOW, &error));
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+    error = (vorbis_error_t)-1;
+    EXPECT_FALSE(vorbis_set_output_rate(
+                     vorbis, 249, VORBIS_RESAMPLE_QUALITY_LOW, &error));
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+    EXPECT_EQ(vorbis_rate(vorbis), 4000);
+
+    /* Setting and then clearing the output rate should leave the stream
+     * unchanged. */
+    EXPECT(vorbis_set_output_rate(vorbis, 8000,
+                                  VORBIS_RESAMPLE_QUALITY_LOW, NULL));
+    EXPECT_EQ(vorbis_rate(vorbis), 8000);
+    EXPECT_EQ(vorbis_length(vorbis), 80);
+    error = (vorbis_error_t)-1;
+    EXPECT(vorbis_set_output_rate(vorbis, 0,
+                                  VORBIS_RESAMPLE_QUALITY_LOW, &error));
+    EXPECT_EQ(error, VORBIS_NO_ERROR);
+    EXPECT_EQ(vorbis_rate(vorbis), 4000);
+    EXPECT_EQ(vorbis_length(vorbis), 40);
+
+    /* The output rate cannot be changed once decoding has started. */
+    float pcm[1];
+    EXPECT_EQ(vorbis_read_float(vorbis, pcm, 1, NULL), 1);
+    error = (vorbis_error_t)-1;
+    EXPECT_FALSE(vorbis_set_output_rate(
+                     vorbis, 8000, VORBIS_RESAMPLE_QUALITY_LOW, &error));
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_OPERATION);
+    vorbis_close(vorbis);
+
+    /* Streams whose own rate exceeds the resampler's limit can only be
+     * "resampled" to their native rate. */
+    EXPECT(vorbis = TEST___open_file("tests/data/sample-rate-max.ogg",
+                                     0, NULL));
+    error = (vorbis_error_t)-1;
+    EXPECT_FALSE(vorbis_set_output_rate(
+                     vorbis, 48000, VORBIS_RESAMPLE_QUALITY_LOW, &error));
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_OPERATION);
+    EXPECT(vorbis_set_output_rate(vorbis, 0,
+                                  VORBIS_RESAMPLE_QUALITY_LOW, NULL));
+    vorbis_close(vorbis);
+
+    return EXIT_SUCCESS;
+}
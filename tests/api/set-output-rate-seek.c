@@ -0,0 +1,49 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "tests/common.h"
+
+#include <string.h>
+
+
+int main(void)
+{
+    vorbis_t *vorbis;
+    EXPECT(vorbis = TEST___open_file("tests/data/sketch008.ogg", 0, NULL));
+    EXPECT(vorbis_set_output_rate(vorbis, 48000,
+                                  VORBIS_RESAMPLE_QUALITY_HIGH, NULL));
+
+    /* Read a stretch of data straight through, then seek to various
+     * points within it and check that we get exactly the same output. */
+    static float pcm[20000*2];
+    EXPECT_EQ(vorbis_read_float(vorbis, pcm, 20000, NULL), 20000);
+    EXPECT_EQ(vorbis_tell(vorbis), 20000);
+
+    static const int offsets[] = {0, 1, 147, 4000, 12345, 19999, 5};
+    for (int i = 0; i < (int)(sizeof(offsets)/sizeof(*offsets)); i++) {
+        const int offset = offsets[i];
+        const int count = 20000 - offset;
+        static float pcm2[20000*2];
+        EXPECT(vorbis_seek(vorbis, offset));
+        EXPECT_EQ(vorbis_tell(vorbis), offset);
+        EXPECT_EQ(vorbis_read_float(vorbis, pcm2, count, NULL), count);
+        EXPECT_EQ(vorbis_tell(vorbis), 20000);
+        for (int j = 0; j < count*2; j++) {
+            if (pcm2[j] != pcm[offset*2+j]) {
+                FAIL("After seek to %d, sample %d was %.8g but should have"
+                     " been %.8g", offset, offset*2+j, pcm2[j],
+                     pcm[offset*2+j]);
+            }
+        }
+    }
+
+    vorbis_close(vorbis);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,73 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "tests/common.h"
+
+#include <math.h>
+
+#include "tests/data/6ch-moving-sine_float.h"
+
+
+int main(void)
+{
+    /* Resampling to exactly twice the input rate lets us check every
+     * other output sample against the original data.  We skip a few
+     * samples at each end, where the filter sees the implicit silence
+     * outside the stream. */
+    static const float tolerance[3] = {0.001f, 0.0001f, 0.00001f};
+    for (int quality = VORBIS_RESAMPLE_QUALITY_LOW;
+         quality <= VORBIS_RESAMPLE_QUALITY_HIGH; quality++)
+    {
+        vorbis_t *vorbis;
+        EXPECT(vorbis = TEST___open_file("tests/data/6ch-moving-sine.ogg",
+                                         0, NULL));
+        vorbis_error_t error = (vorbis_error_t)-1;
+        EXPECT(vorbis_set_output_rate(vorbis, 88200, quality, &error));
+        EXPECT_EQ(error, VORBIS_NO_ERROR);
+        EXPECT_EQ(vorbis_rate(vorbis), 88200);
+        EXPECT_EQ(vorbis_length(vorbis), 6144);
+
+        static float pcm[6145*6];
+        error = (vorbis_error_t)-1;
+        EXPECT_EQ(vorbis_read_float(vorbis, pcm, 6145, &error), 6144);
+        EXPECT_EQ(error, VORBIS_ERROR_STREAM_END);
+
+        for (int i = 32; i < 3072-32; i++) {
+            for (int c = 0; c < 6; c++) {
+                const float expected = expected_pcm[i*6+c];
+                const float sample = pcm[(i*2)*6+c];
+                if (fabsf(sample - expected) > tolerance[quality]) {
+                    FAIL("Quality %d, sample %d channel %d was %.8g but"
+                         " should have been near %.8g", quality, i, c,
+                         sample, expected);
+                }
+            }
+        }
+
+        vorbis_close(vorbis);
+    }
+
+    /* Check that a non-integer ratio also produces the expected number
+     * of samples. */
+    vorbis_t *vorbis;
+    EXPECT(vorbis = TEST___open_file("tests/data/6ch-moving-sine.ogg",
+                                     0, NULL));
+    EXPECT(vorbis_set_output_rate(vorbis, 48000,
+                                  VORBIS_RESAMPLE_QUALITY_MEDIUM, NULL));
+    EXPECT_EQ(vorbis_rate(vorbis), 48000);
+    EXPECT_EQ(vorbis_length(vorbis), 3344);
+    static int16_t pcm16[3345*6];
+    vorbis_error_t error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_read_int16(vorbis, pcm16, 3345, &error), 3344);
+    EXPECT_EQ(error, VORBIS_ERROR_STREAM_END);
+    vorbis_close(vorbis);
+
+    return EXIT_SUCCESS;
+}
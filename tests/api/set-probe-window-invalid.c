@@ -0,0 +1,66 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "tests/common.h"
+
+
+static int32_t read(void *opaque, void *buf, int32_t len)
+{
+    return fread(buf, 1, len, (FILE *)opaque);
+}
+
+
+int main(void)
+{
+    vorbis_t *vorbis;
+    vorbis_error_t error;
+
+    EXPECT(vorbis = TEST___open_file("tests/data/square.ogg", 0, NULL));
+    error = (vorbis_error_t)-1;
+    EXPECT_FALSE(vorbis_set_probe_window(vorbis, -1, &error));
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+    error = (vorbis_error_t)-1;
+    EXPECT_FALSE(vorbis_set_probe_window(vorbis, (1<<24) + 1, &error));
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+    /* The error return pointer is optional. */
+    EXPECT(vorbis_set_probe_window(vorbis, 4096, NULL));
+    EXPECT(vorbis_seek(vorbis, 20));
+    EXPECT_EQ(vorbis_tell(vorbis), 20);
+    vorbis_close(vorbis);
+
+    FILE *f;
+    EXPECT(f = fopen("tests/data/square.ogg", "rb"));
+    EXPECT(vorbis = vorbis_open_callbacks(
+               ((const vorbis_callbacks_t){.read = read}), f, 0, NULL));
+    error = (vorbis_error_t)-1;
+    EXPECT_FALSE(vorbis_set_probe_window(vorbis, 4096, &error));
+    EXPECT_EQ(error, VORBIS_ERROR_STREAM_NOT_SEEKABLE);
+    vorbis_close(vorbis);
+
+    /* Packet-submission decoders have no stream to probe. */
+    uint8_t *data;
+    long size;
+    EXPECT_EQ(fseek(f, 0, SEEK_END), 0);
+    EXPECT_GT(size = ftell(f), 0);
+    EXPECT_EQ(fseek(f, 0, SEEK_SET), 0);
+    EXPECT(data = malloc(size));
+    EXPECT_EQ(fread(data, 1, size, f), size);
+    fclose(f);
+    EXPECT(vorbis = vorbis_open_packet(data+0x1C, 0x1E, data+0xB9, 0x9AC,
+                                       (vorbis_callbacks_t){.malloc = NULL},
+                                       NULL, 0, NULL));
+    error = (vorbis_error_t)-1;
+    EXPECT_FALSE(vorbis_set_probe_window(vorbis, 4096, &error));
+    EXPECT_EQ(error, VORBIS_ERROR_STREAM_NOT_SEEKABLE);
+    vorbis_close(vorbis);
+    free(data);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,47 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "tests/common.h"
+
+
+int main(void)
+{
+    vorbis_t *vorbis;
+    vorbis_error_t error;
+
+    EXPECT(vorbis = TEST___open_file("tests/data/square.ogg", 0, NULL));
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_skip(vorbis, -1, &error), 0);
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+    EXPECT_EQ(vorbis_tell(vorbis), 0);
+    vorbis_close(vorbis);
+
+    /* Skipping is not supported for packet-submission decoders. */
+    FILE *f;
+    uint8_t *data;
+    long size;
+    EXPECT(f = fopen("tests/data/square.ogg", "rb"));
+    EXPECT_EQ(fseek(f, 0, SEEK_END), 0);
+    EXPECT_GT(size = ftell(f), 0);
+    EXPECT_EQ(fseek(f, 0, SEEK_SET), 0);
+    EXPECT(data = malloc(size));
+    EXPECT_EQ(fread(data, 1, size, f), size);
+    fclose(f);
+    EXPECT(vorbis = vorbis_open_packet(data+0x1C, 0x1E, data+0xB9, 0x9AC,
+                                       (vorbis_callbacks_t){.malloc = NULL},
+                                       NULL, 0, NULL));
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_skip(vorbis, 1, &error), 0);
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_OPERATION);
+    vorbis_close(vorbis);
+    free(data);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,155 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "tests/common.h"
+
+
+static int32_t read(void *opaque, void *buf, int32_t len)
+{
+    return fread(buf, 1, len, (FILE *)opaque);
+}
+
+/*-----------------------------------------------------------------------*/
+
+/* Open the given file as an unseekable stream. */
+static vorbis_t *open_unseekable(const char *path, FILE **f_ret)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        LOG("fopen(%s) failed", path);
+        return NULL;
+    }
+    vorbis_t *vorbis = vorbis_open_callbacks(
+        ((const vorbis_callbacks_t){.read = read}), f, 0, NULL);
+    if (!vorbis) {
+        LOG("vorbis_open_callbacks(%s) failed", path);
+        fclose(f);
+        return NULL;
+    }
+    *f_ret = f;
+    return vorbis;
+}
+
+/*-----------------------------------------------------------------------*/
+
+/* Check that skipping the given number of samples after first reading
+ * initial_read samples gives the same data as reading straight through. */
+static int check_skip(const char *path, int32_t initial_read, int64_t skip)
+{
+    static float buf[4096], expect[4096];
+    FILE *f1, *f2;
+    vorbis_t *vorbis1, *vorbis2;
+    vorbis_error_t error;
+
+    if (!(vorbis1 = open_unseekable(path, &f1))) {
+        return 0;
+    }
+    if (!(vorbis2 = open_unseekable(path, &f2))) {
+        return 0;
+    }
+    const int channels = vorbis_channels(vorbis1);
+    const int32_t bufsize = (int32_t)(sizeof(buf) / sizeof(*buf)) / channels;
+
+    int64_t pos = 0;
+    const int64_t target = initial_read + skip;
+    while (pos < target) {
+        const int32_t toread = (int32_t)(target - pos < bufsize
+                                         ? target - pos : bufsize);
+        const int32_t count = vorbis_read_float(vorbis2, expect, toread,
+                                                NULL);
+        if (count != toread) {
+            LOG("%s: failed to read %d samples at %lld", path, toread,
+                (long long)pos);
+            return 0;
+        }
+        pos += count;
+    }
+    const int32_t expect_len =
+        vorbis_read_float(vorbis2, expect, bufsize, NULL);
+
+    for (int32_t done = 0; done < initial_read; ) {
+        const int32_t toread = (initial_read - done < bufsize
+                                ? initial_read - done : bufsize);
+        if (vorbis_read_float(vorbis1, buf, toread, NULL) != toread) {
+            LOG("%s: failed to read %d samples", path, initial_read);
+            return 0;
+        }
+        done += toread;
+    }
+    error = (vorbis_error_t)-1;
+    const int64_t skipped = vorbis_skip(vorbis1, skip, &error);
+    if (skipped != skip || error != VORBIS_NO_ERROR) {
+        LOG("%s: skip(%lld) after %d returned %lld, error %d", path,
+            (long long)skip, initial_read, (long long)skipped, error);
+        return 0;
+    }
+    if (vorbis_tell(vorbis1) != target) {
+        LOG("%s: tell after skip was %lld, expected %lld", path,
+            (long long)vorbis_tell(vorbis1), (long long)target);
+        return 0;
+    }
+    const int32_t len = vorbis_read_float(vorbis1, buf, bufsize, NULL);
+    if (len != expect_len) {
+        LOG("%s: read after skip returned %d, expected %d", path, len,
+            expect_len);
+        return 0;
+    }
+    for (int32_t i = 0; i < len * channels; i++) {
+        if (buf[i] != expect[i]) {
+            LOG("%s: sample %d (after skip to %lld) was %g, expected %g",
+                path, i, (long long)target, buf[i], expect[i]);
+            return 0;
+        }
+    }
+
+    vorbis_close(vorbis1);
+    vorbis_close(vorbis2);
+    fclose(f1);
+    fclose(f2);
+    return 1;
+}
+
+/*************************************************************************/
+/*************************************************************************/
+
+int main(void)
+{
+    EXPECT(check_skip("tests/data/thingy.ogg", 0, 0));
+    EXPECT(check_skip("tests/data/thingy.ogg", 0, 100));
+    EXPECT(check_skip("tests/data/thingy.ogg", 0, 1000000));
+    EXPECT(check_skip("tests/data/thingy.ogg", 1000, 1000000));
+    EXPECT(check_skip("tests/data/thingy.ogg", 12345, 6500000));
+    EXPECT(check_skip("tests/data/6ch-all-page-types.ogg", 100, 8000));
+
+    /* Skipping past the end of the stream should stop at the end. */
+    FILE *f;
+    vorbis_t *vorbis;
+    vorbis_error_t error = (vorbis_error_t)-1;
+    EXPECT(vorbis = open_unseekable("tests/data/thingy.ogg", &f));
+    EXPECT_EQ(vorbis_skip(vorbis, 10000000, &error), 6602752);
+    EXPECT_EQ(error, VORBIS_ERROR_STREAM_END);
+    EXPECT_EQ(vorbis_tell(vorbis), 6602752);
+    vorbis_close(vorbis);
+    fclose(f);
+
+    /* Skipping should also work with resampling enabled, though in that
+     * case all data is decoded. */
+    EXPECT(vorbis = open_unseekable("tests/data/thingy.ogg", &f));
+    EXPECT(vorbis_set_output_rate(vorbis, 22050,
+                                  VORBIS_RESAMPLE_QUALITY_LOW, NULL));
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_skip(vorbis, 100000, &error), 100000);
+    EXPECT_EQ(error, VORBIS_NO_ERROR);
+    EXPECT_EQ(vorbis_tell(vorbis), 100000);
+    vorbis_close(vorbis);
+    fclose(f);
+
+    return EXIT_SUCCESS;
+}
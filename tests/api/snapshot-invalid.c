@@ -0,0 +1,102 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "tests/common.h"
+
+
+static int32_t read(void *opaque, void *buf, int32_t len)
+{
+    return fread(buf, 1, len, (FILE *)opaque);
+}
+
+static void close(void *opaque)
+{
+    fclose((FILE *)opaque);
+}
+
+
+int main(void)
+{
+    vorbis_t *vorbis;
+    vorbis_error_t error;
+    char snapshot[16384];
+    int32_t size;
+
+    EXPECT(vorbis = TEST___open_file("tests/data/square.ogg", 0, NULL));
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_snapshot(vorbis, snapshot, -1, &error), 0);
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_snapshot(vorbis, NULL, 1, &error), 0);
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+    float pcm[10];
+    EXPECT_EQ(vorbis_read_float(vorbis, pcm, 10, NULL), 10);
+    EXPECT_GT(size = vorbis_snapshot(vorbis, snapshot, sizeof(snapshot),
+                                     NULL), 0);
+
+    error = (vorbis_error_t)-1;
+    EXPECT_FALSE(vorbis_restore(vorbis, NULL, size, &error));
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+    error = (vorbis_error_t)-1;
+    EXPECT_FALSE(vorbis_restore(vorbis, snapshot, 4, &error));
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+    error = (vorbis_error_t)-1;
+    EXPECT_FALSE(vorbis_restore(vorbis, snapshot, size-1, &error));
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+    snapshot[0] ^= 1;
+    error = (vorbis_error_t)-1;
+    EXPECT_FALSE(vorbis_restore(vorbis, snapshot, size, &error));
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+    snapshot[0] ^= 1;
+    /* A failed restore should not change the decode position. */
+    EXPECT_EQ(vorbis_tell(vorbis), 10);
+    /* The error return pointer is optional. */
+    EXPECT(vorbis_restore(vorbis, snapshot, size, NULL));
+    EXPECT_EQ(vorbis_tell(vorbis), 10);
+
+    /* Output rate conversion is not supported. */
+    vorbis_t *resampled;
+    EXPECT(resampled = TEST___open_file("tests/data/square.ogg", 0, NULL));
+    EXPECT(vorbis_set_output_rate(resampled, 8000,
+                                  VORBIS_RESAMPLE_QUALITY_LOW, NULL));
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_snapshot(resampled, NULL, 0, &error), 0);
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_OPERATION);
+    error = (vorbis_error_t)-1;
+    EXPECT_FALSE(vorbis_restore(resampled, snapshot, size, &error));
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_OPERATION);
+    vorbis_close(resampled);
+
+    /* A snapshot from a stream with a different channel count should be
+     * rejected. */
+    vorbis_t *stereo;
+    EXPECT(stereo = TEST___open_file("tests/data/square-stereo.ogg", 0, NULL));
+    error = (vorbis_error_t)-1;
+    EXPECT_FALSE(vorbis_restore(stereo, snapshot, size, &error));
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+    vorbis_close(stereo);
+    vorbis_close(vorbis);
+
+    /* Unseekable streams cannot be restored. */
+    FILE *f;
+    EXPECT(f = fopen("tests/data/square.ogg", "rb"));
+    EXPECT(vorbis = vorbis_open_callbacks(
+               ((const vorbis_callbacks_t){.read = read, .close = close}),
+               f, 0, NULL));
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_snapshot(vorbis, NULL, 0, &error), 0);
+    EXPECT_EQ(error, VORBIS_ERROR_STREAM_NOT_SEEKABLE);
+    error = (vorbis_error_t)-1;
+    EXPECT_FALSE(vorbis_restore(vorbis, snapshot, size, &error));
+    EXPECT_EQ(error, VORBIS_ERROR_STREAM_NOT_SEEKABLE);
+    vorbis_close(vorbis);
+
+    return EXIT_SUCCESS;
+}
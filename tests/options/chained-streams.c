@@ -0,0 +1,199 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "tests/common.h"
+
+#define expected_pcm expected_pcm_mono
+#include "tests/data/square_float.h"
+#undef expected_pcm
+#define expected_pcm expected_pcm_stereo
+#include "tests/data/square-stereo_float.h"
+#undef expected_pcm
+
+
+/**
+ * load_file:  Load the given file into a newly allocated buffer, leaving
+ * extra_space bytes free at the end of the buffer.  Returns NULL on error.
+ */
+static uint8_t *load_file(const char *path, long extra_space, long *size_ret)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        LOG("Failed to open %s", path);
+        return NULL;
+    }
+    uint8_t *data = NULL;
+    long size;
+    if (fseek(f, 0, SEEK_END) == 0 && (size = ftell(f)) > 0
+     && fseek(f, 0, SEEK_SET) == 0
+     && (data = malloc(size + extra_space)) != NULL) {
+        if ((long)fread(data, 1, size, f) == size) {
+            *size_ret = size;
+        } else {
+            LOG("Failed to read %s", path);
+            free(data);
+            data = NULL;
+        }
+    }
+    fclose(f);
+    return data;
+}
+
+/**
+ * append_file:  Append the given file to data, changing the bitstream ID
+ * in every page to the given value.  Returns false on error.
+ */
+static bool append_file(uint8_t *data, long *size_ptr, const char *path,
+                        uint32_t bitstream_id)
+{
+    long size;
+    uint8_t *file_data = load_file(path, 0, &size);
+    if (!file_data) {
+        return false;
+    }
+    for (long pos = 0; pos < size; ) {
+        const int segment_count = file_data[pos+26];
+        long page_size = 27 + segment_count;
+        for (int i = 0; i < segment_count; i++) {
+            page_size += file_data[pos+27+i];
+        }
+        file_data[pos+14] = (uint8_t)(bitstream_id >> 0);
+        file_data[pos+15] = (uint8_t)(bitstream_id >> 8);
+        file_data[pos+16] = (uint8_t)(bitstream_id >> 16);
+        file_data[pos+17] = (uint8_t)(bitstream_id >> 24);
+        pos += page_size;
+    }
+    memcpy(data + *size_ptr, file_data, size);
+    *size_ptr += size;
+    free(file_data);
+    return true;
+}
+
+
+int main(void)
+{
+    uint8_t *data;
+    long size;
+    vorbis_t *vorbis;
+    vorbis_error_t error;
+    float pcm[81*2];
+
+    /* A second link with the same format should be decoded seamlessly. */
+    EXPECT(data = load_file("tests/data/square.ogg", 10000, &size));
+    EXPECT(append_file(data, &size, "tests/data/square.ogg", 0x12345678));
+    EXPECT(vorbis = vorbis_open_buffer(
+               data, size, VORBIS_OPTION_CHAINED_STREAMS, NULL));
+    EXPECT_EQ(vorbis_length(vorbis), -1);
+    EXPECT_FALSE(vorbis_seek(vorbis, 0));
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_read_float(vorbis, pcm, 81, &error), 80);
+    EXPECT_EQ(error, VORBIS_ERROR_STREAM_END);
+    COMPARE_PCM_FLOAT(pcm, expected_pcm_mono, 40);
+    COMPARE_PCM_FLOAT(pcm+40, expected_pcm_mono, 40);
+    EXPECT_EQ(vorbis_tell(vorbis), 80);
+    vorbis_close(vorbis);
+
+    /* Resampling should also continue across the link boundary. */
+    EXPECT(vorbis = vorbis_open_buffer(
+               data, size, VORBIS_OPTION_CHAINED_STREAMS, NULL));
+    EXPECT(vorbis_set_output_rate(vorbis, 8000,
+                                  VORBIS_RESAMPLE_QUALITY_LOW, NULL));
+    static float pcm_8k[161];
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_read_float(vorbis, pcm_8k, 161, &error), 160);
+    EXPECT_EQ(error, VORBIS_ERROR_STREAM_END);
+    EXPECT_EQ(vorbis_rate(vorbis), 8000);
+    EXPECT_EQ(vorbis_tell(vorbis), 160);
+    vorbis_close(vorbis);
+
+    /* Analysis should also continue across the link boundary. */
+    EXPECT(vorbis = vorbis_open_buffer(
+               data, size, VORBIS_OPTION_CHAINED_STREAMS, NULL));
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_analyze(vorbis, NULL, NULL, 0, NULL, 0, &error), 80);
+    EXPECT_EQ(error, VORBIS_NO_ERROR);
+    EXPECT_EQ(vorbis_tell(vorbis), 80);
+    vorbis_close(vorbis);
+
+    /* Without the option, only the first link should be decoded. */
+    EXPECT(vorbis = vorbis_open_buffer(data, size, 0, NULL));
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_read_float(vorbis, pcm, 81, &error), 40);
+    EXPECT_EQ(error, VORBIS_ERROR_STREAM_END);
+    COMPARE_PCM_FLOAT(pcm, expected_pcm_mono, 40);
+    vorbis_close(vorbis);
+    free(data);
+
+    /* A change in format should stop the read at the end of the link. */
+    EXPECT(data = load_file("tests/data/square.ogg", 10000, &size));
+    EXPECT(append_file(data, &size, "tests/data/square-stereo.ogg",
+                       0x12345678));
+    EXPECT(append_file(data, &size, "tests/data/square.ogg", 0x9ABCDEF0));
+    EXPECT(vorbis = vorbis_open_buffer(
+               data, size, VORBIS_OPTION_CHAINED_STREAMS, NULL));
+    EXPECT(vorbis_set_downmix(vorbis, 0, NULL, NULL));
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_read_float(vorbis, pcm, 81, &error), 40);
+    EXPECT_EQ(error, VORBIS_ERROR_STREAM_CHANGED);
+    COMPARE_PCM_FLOAT(pcm, expected_pcm_mono, 40);
+    EXPECT_EQ(vorbis_channels(vorbis), 2);
+    EXPECT_EQ(vorbis_rate(vorbis), 4000);
+    EXPECT_EQ(vorbis_tell(vorbis), 40);
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_read_float(vorbis, pcm, 81, &error), 20);
+    EXPECT_EQ(error, VORBIS_ERROR_STREAM_CHANGED);
+    COMPARE_PCM_FLOAT(pcm, expected_pcm_stereo, 40);
+    EXPECT_EQ(vorbis_channels(vorbis), 1);
+    EXPECT_EQ(vorbis_tell(vorbis), 60);
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_read_float(vorbis, pcm, 81, &error), 40);
+    EXPECT_EQ(error, VORBIS_ERROR_STREAM_END);
+    COMPARE_PCM_FLOAT(pcm, expected_pcm_mono, 40);
+    EXPECT_EQ(vorbis_tell(vorbis), 100);
+    vorbis_close(vorbis);
+
+    /* Analysis should likewise stop at the end of each link and leave the
+     * stream at the start of the next one. */
+    float peak_mono = 0, peak_stereo[2] = {0, 0};
+    for (int i = 0; i < 40; i++) {
+        peak_mono = fmaxf(peak_mono, fabsf(expected_pcm_mono[i]));
+    }
+    for (int i = 0; i < 20; i++) {
+        for (int c = 0; c < 2; c++) {
+            peak_stereo[c] = fmaxf(peak_stereo[c],
+                                   fabsf(expected_pcm_stereo[i*2+c]));
+        }
+    }
+    vorbis_stats_t stats[2];
+    EXPECT(vorbis = vorbis_open_buffer(
+               data, size, VORBIS_OPTION_CHAINED_STREAMS, NULL));
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_analyze(vorbis, stats, NULL, 0, NULL, 0, &error), 40);
+    EXPECT_EQ(error, VORBIS_ERROR_STREAM_CHANGED);
+    EXPECT(fabsf(stats[0].peak - peak_mono) <= PCM_FLOAT_ERROR);
+    EXPECT_EQ(vorbis_channels(vorbis), 2);
+    EXPECT_EQ(vorbis_tell(vorbis), 40);
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_analyze(vorbis, stats, NULL, 0, NULL, 0, &error), 20);
+    EXPECT_EQ(error, VORBIS_ERROR_STREAM_CHANGED);
+    EXPECT(fabsf(stats[0].peak - peak_stereo[0]) <= PCM_FLOAT_ERROR);
+    EXPECT(fabsf(stats[1].peak - peak_stereo[1]) <= PCM_FLOAT_ERROR);
+    EXPECT_EQ(vorbis_channels(vorbis), 1);
+    EXPECT_EQ(vorbis_tell(vorbis), 60);
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_read_float(vorbis, pcm, 81, &error), 40);
+    EXPECT_EQ(error, VORBIS_ERROR_STREAM_END);
+    COMPARE_PCM_FLOAT(pcm, expected_pcm_mono, 40);
+    EXPECT_EQ(vorbis_tell(vorbis), 100);
+    vorbis_close(vorbis);
+    free(data);
+
+    return EXIT_SUCCESS;
+}
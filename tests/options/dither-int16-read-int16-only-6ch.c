@@ -0,0 +1,43 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "tests/common.h"
+
+#include "tests/data/6ch-moving-sine_int16.h"  // Defines expected_pcm[].
+
+
+int main(void)
+{
+    vorbis_t *vorbis;
+    EXPECT(vorbis = TEST___open_file("tests/data/6ch-moving-sine.ogg",
+                                     VORBIS_OPTION_DITHER_INT16
+                                     | VORBIS_OPTION_READ_INT16_ONLY, NULL));
+
+    static int16_t pcm[3073*6];
+    vorbis_error_t error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_read_int16(vorbis, pcm, 3073, &error), 3072);
+    EXPECT_EQ(error, VORBIS_ERROR_STREAM_END);
+
+    /* Dither noise is at most 1 LSB in either direction, so every sample
+     * should be within 1 of the undithered value, and at least some
+     * samples should differ. */
+    int num_changed = 0;
+    for (int i = 0; i < 3072*6; i++) {
+        if (pcm[i] < expected_pcm[i] - 1 || pcm[i] > expected_pcm[i] + 1) {
+            FAIL("Sample %d was %d but should have been within 1 of %d",
+                 i, pcm[i], expected_pcm[i]);
+        }
+        num_changed += (pcm[i] != expected_pcm[i]);
+    }
+    EXPECT_GT(num_changed, 0);
+
+    vorbis_close(vorbis);
+    return EXIT_SUCCESS;
+}
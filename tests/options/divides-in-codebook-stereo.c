@@ -0,0 +1,30 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "tests/common.h"
+
+#include "tests/data/square-stereo_float.h"  // Defines expected_pcm[].
+
+
+int main(void)
+{
+    vorbis_t *vorbis;
+    EXPECT(vorbis = TEST___open_file("tests/data/square-stereo.ogg",
+                                     VORBIS_OPTION_DIVIDES_IN_CODEBOOK, NULL));
+
+    float pcm[42];
+    vorbis_error_t error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_read_float(vorbis, pcm, 21, &error), 20);
+    EXPECT_EQ(error, VORBIS_ERROR_STREAM_END);
+    COMPARE_PCM_FLOAT(pcm, expected_pcm, 20);
+
+    vorbis_close(vorbis);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,42 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "tests/common.h"
+
+
+int main(void)
+{
+    /* Mixing down to two channels exercises the stereo-specific int16
+     * interleave path; the result should match the general path with
+     * int16 conversion. */
+    static const float matrix[2*6] = {
+        0.5f, 0.35f, 0.0f, 0.35f, 0.0f,  0.0f,
+        0.0f, 0.35f, 0.5f, 0.0f,  0.35f, 0.0f,
+    };
+
+    vorbis_t *vorbis, *vorbis_ref;
+    EXPECT(vorbis = TEST___open_file("tests/data/6ch-moving-sine.ogg",
+                                     VORBIS_OPTION_READ_INT16_ONLY, NULL));
+    EXPECT(vorbis_ref = TEST___open_file("tests/data/6ch-moving-sine.ogg",
+                                         0, NULL));
+    EXPECT(vorbis_set_downmix(vorbis, 2, matrix, NULL));
+    EXPECT(vorbis_set_downmix(vorbis_ref, 2, matrix, NULL));
+
+    static int16_t pcm[3073*2], pcm_ref[3072*2];
+    vorbis_error_t error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_read_int16(vorbis, pcm, 3073, &error), 3072);
+    EXPECT_EQ(error, VORBIS_ERROR_STREAM_END);
+    EXPECT_EQ(vorbis_read_int16(vorbis_ref, pcm_ref, 3072, NULL), 3072);
+    COMPARE_PCM_INT16(pcm, pcm_ref, 3072*2);
+
+    vorbis_close(vorbis);
+    vorbis_close(vorbis_ref);
+    return EXIT_SUCCESS;
+}
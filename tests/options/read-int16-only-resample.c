@@ -0,0 +1,39 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "tests/common.h"
+
+
+int main(void)
+{
+    /* Output from the int16-only path should match that from the
+     * general path with int16 conversion. */
+    vorbis_t *vorbis, *vorbis_ref;
+    EXPECT(vorbis = TEST___open_file("tests/data/noise-stereo.ogg",
+                                     VORBIS_OPTION_READ_INT16_ONLY, NULL));
+    EXPECT(vorbis_ref = TEST___open_file("tests/data/noise-stereo.ogg",
+                                         0, NULL));
+    EXPECT(vorbis_set_output_rate(vorbis, 22050,
+                                  VORBIS_RESAMPLE_QUALITY_MEDIUM, NULL));
+    EXPECT(vorbis_set_output_rate(vorbis_ref, 22050,
+                                  VORBIS_RESAMPLE_QUALITY_MEDIUM, NULL));
+    EXPECT_EQ(vorbis_length(vorbis), 256);
+
+    int16_t pcm[257*2], pcm_ref[256*2];
+    vorbis_error_t error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_read_int16(vorbis, pcm, 257, &error), 256);
+    EXPECT_EQ(error, VORBIS_ERROR_STREAM_END);
+    EXPECT_EQ(vorbis_read_int16(vorbis_ref, pcm_ref, 256, NULL), 256);
+    COMPARE_PCM_INT16(pcm, pcm_ref, 256*2);
+
+    vorbis_close(vorbis);
+    vorbis_close(vorbis_ref);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,46 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "tests/common.h"
+
+
+int main(void)
+{
+    /* Output converted while interleaving should be identical to output
+     * converted from float data when read. */
+    vorbis_t *vorbis, *vorbis_ref;
+    EXPECT(vorbis = TEST___open_file("tests/data/square.ogg",
+                                     VORBIS_OPTION_READ_INT24_ONLY, NULL));
+    EXPECT(vorbis_ref = TEST___open_file("tests/data/square.ogg", 0, NULL));
+
+    float pcm_float[1];
+    int16_t pcm_int16[1];
+    int32_t pcm_int32[1];
+    vorbis_error_t error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_read_float(vorbis, pcm_float, 1, &error), 0);
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_OPERATION);
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_read_int16(vorbis, pcm_int16, 1, &error), 0);
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_OPERATION);
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_read_int32(vorbis, pcm_int32, 1, &error), 0);
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_OPERATION);
+
+    uint8_t pcm[41*3], pcm_ref[40*3];
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_read_int24(vorbis, pcm, 41, &error), 40);
+    EXPECT_EQ(error, VORBIS_ERROR_STREAM_END);
+    EXPECT_EQ(vorbis_read_int24(vorbis_ref, pcm_ref, 40, NULL), 40);
+    EXPECT_MEMEQ(pcm, pcm_ref, sizeof(pcm_ref));
+
+    vorbis_close(vorbis);
+    vorbis_close(vorbis_ref);
+    return EXIT_SUCCESS;
+}
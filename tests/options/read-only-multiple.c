@@ -0,0 +1,32 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "tests/common.h"
+
+
+int main(void)
+{
+    /* At most one of the READ_*_ONLY options may be given. */
+    static const unsigned int options[] = {
+        VORBIS_OPTION_READ_INT16_ONLY | VORBIS_OPTION_READ_INT24_ONLY,
+        VORBIS_OPTION_READ_INT16_ONLY | VORBIS_OPTION_READ_INT32_ONLY,
+        VORBIS_OPTION_READ_INT24_ONLY | VORBIS_OPTION_READ_INT32_ONLY,
+        VORBIS_OPTION_READ_INT16_ONLY | VORBIS_OPTION_READ_INT24_ONLY
+            | VORBIS_OPTION_READ_INT32_ONLY,
+    };
+    for (int i = 0; i < (int)(sizeof(options) / sizeof(*options)); i++) {
+        vorbis_error_t error = (vorbis_error_t)-1;
+        EXPECT_FALSE(TEST___open_file("tests/data/square.ogg", options[i],
+                                      &error));
+        EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,150 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "tests/common.h"
+
+#include <stdio.h>
+
+
+/* Number of bytes read from the stream. */
+static long read_count;
+
+static int64_t length(void *opaque)
+{
+    FILE *f = (FILE *)opaque;
+    const long saved_offset = ftell(f);
+    fseek(f, 0, SEEK_END);
+    const long len = ftell(f);
+    fseek(f, saved_offset, SEEK_SET);
+    return len;
+}
+
+static int64_t tell(void *opaque)
+{
+    return ftell((FILE *)opaque);
+}
+
+static void seek(void *opaque, int64_t offset)
+{
+    fseek((FILE *)opaque, offset, SEEK_SET);
+}
+
+static int32_t read(void *opaque, void *buf, int32_t len)
+{
+    const int32_t result = fread(buf, 1, len, (FILE *)opaque);
+    read_count += result;
+    return result;
+}
+
+static void close(void *opaque)
+{
+    fclose((FILE *)opaque);
+}
+
+static vorbis_t *open_counted(void)
+{
+    FILE *f = fopen("tests/data/thingy.ogg", "rb");
+    if (!f) {
+        LOG("Failed to open tests/data/thingy.ogg");
+        return NULL;
+    }
+    vorbis_t *vorbis = vorbis_open_callbacks(((const vorbis_callbacks_t){
+        .length = length, .tell = tell, .seek = seek, .read = read,
+        .close = close}), f, 0, NULL);
+    if (!vorbis) {
+        LOG("Failed to open tests/data/thingy.ogg as Ogg Vorbis");
+        fclose(f);
+    }
+    return vorbis;
+}
+
+/* Seek the handle to the given position, check that it returns the same
+ * data as a fresh handle seeked to the same position, and return the
+ * number of bytes read by the seek operation (or -1 on error). */
+static long check_seek(vorbis_t *vorbis, int64_t offset)
+{
+    vorbis_t *reference;
+    if (!(reference = open_counted())) {
+        return -1;
+    }
+    if (vorbis_length(reference) != 6602752) {
+        LOG("Bad reference length %lld",
+            (long long)vorbis_length(reference));
+        vorbis_close(reference);
+        return -1;
+    }
+    static float pcm[1000], pcm2[1000];
+    if (!vorbis_seek(reference, offset)
+     || vorbis_read_float(reference, pcm, 1000, NULL) != 1000) {
+        LOG("Reference seek to %lld failed", (long long)offset);
+        vorbis_close(reference);
+        return -1;
+    }
+    vorbis_close(reference);
+
+    read_count = 0;
+    if (!vorbis_seek(vorbis, offset)) {
+        LOG("Seek to %lld failed", (long long)offset);
+        return -1;
+    }
+    const long seek_read_count = read_count;
+    if (vorbis_read_float(vorbis, pcm2, 1000, NULL) != 1000) {
+        LOG("Read after seek to %lld failed", (long long)offset);
+        return -1;
+    }
+    for (int i = 0; i < 1000; i++) {
+        if (pcm2[i] != pcm[i]) {
+            LOG("After seek to %lld, sample %d was %.8g but should have"
+                " been %.8g", (long long)offset, i, pcm2[i], pcm[i]);
+            return -1;
+        }
+    }
+    return seek_read_count;
+}
+
+
+int main(void)
+{
+    vorbis_t *vorbis;
+    EXPECT(vorbis = open_counted());
+    EXPECT_EQ(vorbis_length(vorbis), 6602752);
+
+    /* The first seek has to search for the target page. */
+    long first_read;
+    EXPECT((first_read = check_seek(vorbis, 3000000)) > 0);
+
+    /* Seeks around the same position (as when scrubbing) should reuse
+     * pages found by earlier seeks, and thus need less data. */
+    static const int64_t offsets[] = {
+        3000500, 2999000, 3001234, 2998000, 3000000};
+    for (int i = 0; i < (int)(sizeof(offsets)/sizeof(*offsets)); i++) {
+        long this_read;
+        EXPECT((this_read = check_seek(vorbis, offsets[i])) > 0);
+        if (this_read >= first_read) {
+            FAIL("Seek to %lld read %ld bytes, but initial seek read only"
+                 " %ld", (long long)offsets[i], this_read, first_read);
+        }
+    }
+
+    /* Seeks elsewhere in the stream should still work correctly, as
+     * should seeks back to the original area. */
+    EXPECT(check_seek(vorbis, 100000) > 0);
+    EXPECT(check_seek(vorbis, 6000000) > 0);
+    EXPECT(check_seek(vorbis, 3000700) > 0);
+    for (int64_t offset = 0; offset < 6602752; offset += 250000) {
+        EXPECT(check_seek(vorbis, offset) > 0);
+    }
+    for (int64_t offset = 6500000; offset > 0; offset -= 190000) {
+        EXPECT(check_seek(vorbis, offset) > 0);
+    }
+
+    vorbis_close(vorbis);
+    return EXIT_SUCCESS;
+}
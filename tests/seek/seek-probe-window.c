@@ -0,0 +1,124 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "tests/common.h"
+
+#include <stdio.h>
+
+
+/* Number of read calls made on the stream. */
+static long read_count;
+
+static int64_t length(void *opaque)
+{
+    FILE *f = (FILE *)opaque;
+    const long saved_offset = ftell(f);
+    fseek(f, 0, SEEK_END);
+    const long len = ftell(f);
+    fseek(f, saved_offset, SEEK_SET);
+    return len;
+}
+
+static int64_t tell(void *opaque)
+{
+    return ftell((FILE *)opaque);
+}
+
+static void seek(void *opaque, int64_t offset)
+{
+    fseek((FILE *)opaque, offset, SEEK_SET);
+}
+
+static int32_t read(void *opaque, void *buf, int32_t len)
+{
+    const int32_t result = fread(buf, 1, len, (FILE *)opaque);
+    read_count++;
+    return result;
+}
+
+static void close(void *opaque)
+{
+    fclose((FILE *)opaque);
+}
+
+static vorbis_t *open_counted(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        LOG("Failed to open %s", path);
+        return NULL;
+    }
+    vorbis_t *vorbis = vorbis_open_callbacks(((const vorbis_callbacks_t){
+        .length = length, .tell = tell, .seek = seek, .read = read,
+        .close = close}), f, 0, NULL);
+    if (!vorbis) {
+        LOG("Failed to open %s as Ogg Vorbis", path);
+        fclose(f);
+    }
+    return vorbis;
+}
+
+
+int main(void)
+{
+    vorbis_t *reference, *vorbis;
+    EXPECT(reference = open_counted("tests/data/thingy.ogg"));
+    EXPECT(vorbis = open_counted("tests/data/thingy.ogg"));
+    EXPECT_EQ(vorbis_length(reference), 6602752);
+    EXPECT_EQ(vorbis_length(vorbis), 6602752);
+
+    vorbis_error_t error = (vorbis_error_t)-1;
+    EXPECT(vorbis_set_probe_window(vorbis, 65536, &error));
+    EXPECT_EQ(error, VORBIS_NO_ERROR);
+
+    static const int64_t offsets[] = {
+        0, 1, 53632, 1000000, 3000000, 3000001, 6602000, 6602751, 500,
+        1000500, 2999000};
+    long plain_reads = 0, window_reads = 0;
+    for (int i = 0; i < (int)(sizeof(offsets)/sizeof(*offsets)); i++) {
+        const int64_t offset = offsets[i];
+        static float pcm[2000], pcm2[2000];
+
+        read_count = 0;
+        EXPECT(vorbis_seek(reference, offset));
+        plain_reads += read_count;
+        read_count = 0;
+        EXPECT(vorbis_seek(vorbis, offset));
+        window_reads += read_count;
+        EXPECT_EQ(vorbis_tell(vorbis), offset);
+
+        const int count = vorbis_read_float(reference, pcm, 2000, NULL);
+        EXPECT_EQ(vorbis_read_float(vorbis, pcm2, 2000, NULL), count);
+        for (int j = 0; j < count; j++) {
+            if (pcm2[j] != pcm[j]) {
+                FAIL("After seek to %lld, sample %d was %.8g but should"
+                     " have been %.8g", (long long)offset, j, pcm2[j],
+                     pcm[j]);
+            }
+        }
+    }
+
+    /* Each probe should need at most one read call, so the probe window
+     * should reduce the number of reads considerably. */
+    if (window_reads * 2 > plain_reads) {
+        FAIL("Seeks with probe window made %ld read calls, but seeks"
+             " without it made only %ld", window_reads, plain_reads);
+    }
+
+    /* Disabling the window should restore normal behavior. */
+    EXPECT(vorbis_set_probe_window(vorbis, 0, &error));
+    EXPECT_EQ(error, VORBIS_NO_ERROR);
+    EXPECT(vorbis_seek(vorbis, 1000000));
+    EXPECT_EQ(vorbis_tell(vorbis), 1000000);
+
+    vorbis_close(vorbis);
+    vorbis_close(reference);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,125 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "tests/common.h"
+
+#include <stdio.h>
+
+
+/* Number of bytes read from the stream. */
+static long read_count;
+
+static int64_t length(void *opaque)
+{
+    FILE *f = (FILE *)opaque;
+    const long saved_offset = ftell(f);
+    fseek(f, 0, SEEK_END);
+    const long len = ftell(f);
+    fseek(f, saved_offset, SEEK_SET);
+    return len;
+}
+
+static int64_t tell(void *opaque)
+{
+    return ftell((FILE *)opaque);
+}
+
+static void seek(void *opaque, int64_t offset)
+{
+    fseek((FILE *)opaque, offset, SEEK_SET);
+}
+
+static int32_t read(void *opaque, void *buf, int32_t len)
+{
+    const int32_t result = fread(buf, 1, len, (FILE *)opaque);
+    read_count += result;
+    return result;
+}
+
+static void close(void *opaque)
+{
+    fclose((FILE *)opaque);
+}
+
+static vorbis_t *open_counted(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        LOG("Failed to open %s", path);
+        return NULL;
+    }
+    vorbis_t *vorbis = vorbis_open_callbacks(((const vorbis_callbacks_t){
+        .length = length, .tell = tell, .seek = seek, .read = read,
+        .close = close}), f, 0, NULL);
+    if (!vorbis) {
+        LOG("Failed to open %s as Ogg Vorbis", path);
+        fclose(f);
+    }
+    return vorbis;
+}
+
+
+int main(void)
+{
+    /* thingy-skeleton.ogg is thingy.ogg with an Ogg Skeleton 4.0 stream
+     * (including a keypoint index) multiplexed in.  Keypoint times are
+     * stored in milliseconds, so they do not exactly match page start
+     * positions. */
+    vorbis_t *reference, *vorbis;
+    EXPECT(reference = open_counted("tests/data/thingy.ogg"));
+    EXPECT(vorbis = open_counted("tests/data/thingy-skeleton.ogg"));
+    static float pcm[2000], pcm2[2000];
+    EXPECT_EQ(vorbis_read_float(reference, pcm, 2000, NULL), 2000);
+    EXPECT_EQ(vorbis_read_float(vorbis, pcm2, 2000, NULL), 2000);
+    for (int i = 0; i < 2000; i++) {
+        if (pcm2[i] != pcm[i]) {
+            FAIL("Sample %d was %.8g but should have been %.8g",
+                 i, pcm2[i], pcm[i]);
+        }
+    }
+    EXPECT_EQ(vorbis_length(reference), 6602752);
+    EXPECT_EQ(vorbis_length(vorbis), 6602752);
+
+    static const int64_t offsets[] = {
+        0, 1, 53632, 1000000, 3000000, 3000001, 6602000, 6602751, 500};
+    long reference_read = 0, indexed_read = 0;
+    for (int i = 0; i < (int)(sizeof(offsets)/sizeof(*offsets)); i++) {
+        const int64_t offset = offsets[i];
+
+        read_count = 0;
+        EXPECT(vorbis_seek(reference, offset));
+        reference_read += read_count;
+        read_count = 0;
+        EXPECT(vorbis_seek(vorbis, offset));
+        indexed_read += read_count;
+
+        EXPECT_EQ(vorbis_tell(vorbis), offset);
+        const int count = vorbis_read_float(reference, pcm, 2000, NULL);
+        EXPECT_EQ(vorbis_read_float(vorbis, pcm2, 2000, NULL), count);
+        for (int j = 0; j < count; j++) {
+            if (pcm2[j] != pcm[j]) {
+                FAIL("After seek to %lld, sample %d was %.8g but should"
+                     " have been %.8g", (long long)offset, j, pcm2[j],
+                     pcm[j]);
+            }
+        }
+    }
+
+    /* Since the index lets us skip the bisection search, we should read
+     * less data overall. */
+    if (indexed_read >= reference_read) {
+        FAIL("Indexed seeks read %ld bytes, but unindexed seeks read only"
+             " %ld", indexed_read, reference_read);
+    }
+
+    vorbis_close(vorbis);
+    vorbis_close(reference);
+    return EXIT_SUCCESS;
+}
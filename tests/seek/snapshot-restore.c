@@ -0,0 +1,166 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "tests/common.h"
+
+#include <stdio.h>
+
+
+/* Number of read calls made on the stream. */
+static long read_count;
+
+static int64_t length(void *opaque)
+{
+    FILE *f = (FILE *)opaque;
+    const long saved_offset = ftell(f);
+    fseek(f, 0, SEEK_END);
+    const long len = ftell(f);
+    fseek(f, saved_offset, SEEK_SET);
+    return len;
+}
+
+static int64_t tell(void *opaque)
+{
+    return ftell((FILE *)opaque);
+}
+
+static void seek(void *opaque, int64_t offset)
+{
+    fseek((FILE *)opaque, offset, SEEK_SET);
+}
+
+static int32_t read(void *opaque, void *buf, int32_t len)
+{
+    const int32_t result = fread(buf, 1, len, (FILE *)opaque);
+    read_count++;
+    return result;
+}
+
+static void close(void *opaque)
+{
+    fclose((FILE *)opaque);
+}
+
+static vorbis_t *open_counted(const char *path, unsigned int options)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        LOG("Failed to open %s", path);
+        return NULL;
+    }
+    vorbis_t *vorbis = vorbis_open_callbacks(((const vorbis_callbacks_t){
+        .length = length, .tell = tell, .seek = seek, .read = read,
+        .close = close}), f, options, NULL);
+    if (!vorbis) {
+        LOG("Failed to open %s as Ogg Vorbis", path);
+        fclose(f);
+    }
+    return vorbis;
+}
+
+
+int main(void)
+{
+    /* thingy.ogg is a mono stream. */
+    static float pcm[2][30000];
+    static int16_t pcm16[2][30000];
+    static uint8_t pcm24[2][30000*3];
+    static char snapshot[65536];
+    vorbis_t *vorbis;
+    vorbis_error_t error;
+    int32_t size;
+
+    EXPECT(vorbis = open_counted("tests/data/thingy.ogg", 0));
+    EXPECT_EQ(vorbis_read_float(vorbis, pcm[0], 12345, NULL), 12345);
+
+    /* Check that the required size is returned for a null buffer and
+     * that a buffer which is too small is rejected. */
+    error = (vorbis_error_t)-1;
+    EXPECT_GT(size = vorbis_snapshot(vorbis, NULL, 0, &error), 0);
+    EXPECT_EQ(error, VORBIS_NO_ERROR);
+    EXPECT(size <= (int32_t)sizeof(snapshot));
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_snapshot(vorbis, snapshot, size-1, &error), size);
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+
+    /* Take a snapshot in the middle of a frame, read past it, and check
+     * that restoring gives the same data without reading the stream. */
+    error = (vorbis_error_t)-1;
+    EXPECT_EQ(vorbis_snapshot(vorbis, snapshot, sizeof(snapshot), &error),
+              size);
+    EXPECT_EQ(error, VORBIS_NO_ERROR);
+    EXPECT_EQ(vorbis_read_float(vorbis, pcm[0], 20000, NULL), 20000);
+    EXPECT_EQ(vorbis_tell(vorbis), 32345);
+    const long saved_read_count = read_count;
+    error = (vorbis_error_t)-1;
+    EXPECT(vorbis_restore(vorbis, snapshot, size, &error));
+    EXPECT_EQ(error, VORBIS_NO_ERROR);
+    EXPECT_EQ(read_count, saved_read_count);
+    EXPECT_EQ(vorbis_tell(vorbis), 12345);
+    EXPECT_EQ(vorbis_read_float(vorbis, pcm[1], 20000, NULL), 20000);
+    EXPECT_MEMEQ(pcm[1], pcm[0], sizeof(*pcm[0]) * 20000);
+
+    /* The snapshot should remain usable after reading further. */
+    EXPECT_EQ(vorbis_read_float(vorbis, pcm[1], 20000, NULL), 20000);
+    EXPECT(vorbis_restore(vorbis, snapshot, size, NULL));
+    EXPECT_EQ(vorbis_read_float(vorbis, pcm[1], 20000, NULL), 20000);
+    EXPECT_MEMEQ(pcm[1], pcm[0], sizeof(*pcm[0]) * 20000);
+    vorbis_close(vorbis);
+
+    /* A snapshot taken before any data is read should return to the
+     * beginning of the stream. */
+    EXPECT(vorbis = open_counted("tests/data/thingy.ogg", 0));
+    EXPECT_GT(size = vorbis_snapshot(vorbis, snapshot, sizeof(snapshot),
+                                     NULL), 0);
+    EXPECT_EQ(vorbis_read_float(vorbis, pcm[0], 20000, NULL), 20000);
+    EXPECT(vorbis_restore(vorbis, snapshot, size, NULL));
+    EXPECT_EQ(vorbis_tell(vorbis), 0);
+    EXPECT_EQ(vorbis_read_float(vorbis, pcm[1], 20000, NULL), 20000);
+    EXPECT_MEMEQ(pcm[1], pcm[0], sizeof(*pcm[0]) * 20000);
+    vorbis_close(vorbis);
+
+    /* Check restoring with int16 output and dither, which must also
+     * restore the dither generator state. */
+    EXPECT(vorbis = open_counted(
+               "tests/data/thingy.ogg",
+               VORBIS_OPTION_READ_INT16_ONLY | VORBIS_OPTION_DITHER_INT16));
+    EXPECT_EQ(vorbis_read_int16(vorbis, pcm16[0], 30000, NULL), 30000);
+    EXPECT_EQ(vorbis_read_int16(vorbis, pcm16[0], 24321, NULL), 24321);
+    EXPECT_GT(size = vorbis_snapshot(vorbis, snapshot, sizeof(snapshot),
+                                     NULL), 0);
+    EXPECT_EQ(vorbis_read_int16(vorbis, pcm16[0], 20000, NULL), 20000);
+    EXPECT(vorbis_restore(vorbis, snapshot, size, NULL));
+    EXPECT_EQ(vorbis_tell(vorbis), 54321);
+    EXPECT_EQ(vorbis_read_int16(vorbis, pcm16[1], 20000, NULL), 20000);
+    EXPECT_MEMEQ(pcm16[1], pcm16[0], sizeof(*pcm16[0]) * 20000);
+    vorbis_close(vorbis);
+
+    /* Check restoring with packed int24 pending data, and that the
+     * snapshot is rejected by a handle using a different output format. */
+    EXPECT(vorbis = open_counted("tests/data/thingy.ogg",
+                                 VORBIS_OPTION_READ_INT24_ONLY));
+    EXPECT_EQ(vorbis_read_int24(vorbis, pcm24[0], 12345, NULL), 12345);
+    EXPECT_GT(size = vorbis_snapshot(vorbis, snapshot, sizeof(snapshot),
+                                     NULL), 0);
+    EXPECT_EQ(vorbis_read_int24(vorbis, pcm24[0], 20000, NULL), 20000);
+    EXPECT(vorbis_restore(vorbis, snapshot, size, NULL));
+    EXPECT_EQ(vorbis_tell(vorbis), 12345);
+    EXPECT_EQ(vorbis_read_int24(vorbis, pcm24[1], 20000, NULL), 20000);
+    EXPECT_MEMEQ(pcm24[1], pcm24[0], 20000*3);
+    vorbis_close(vorbis);
+    EXPECT(vorbis = open_counted("tests/data/thingy.ogg",
+                                 VORBIS_OPTION_READ_INT32_ONLY));
+    error = (vorbis_error_t)-1;
+    EXPECT_FALSE(vorbis_restore(vorbis, snapshot, size, &error));
+    EXPECT_EQ(error, VORBIS_ERROR_INVALID_ARGUMENT);
+    vorbis_close(vorbis);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,97 @@
+/*
+ * libnogg: a decoder library for Ogg Vorbis streams
+ * Copyright (c) 2014-2024 Andrew Church <achurch@achurch.org>
+ *
+ * This software may be copied and redistributed under certain conditions;
+ * see the file "COPYING" in the source code distribution for details.
+ * NO WARRANTY is provided with this software.
+ */
+
+#include "include/nogg.h"
+#include "tests/common.h"
+
+/* We call the conversion functions directly so we can check clamping of
+ * out-of-range values in both the optimized and unoptimized paths. */
+#include "src/common.h"
+#include "src/util/float-to-int32.h"
+
+#include <string.h>
+
+
+int main(void)
+{
+    /* 17 values covers one full 16-value SIMD block plus a scalar tail. */
+    ALIGN(64) static const float data[17] = {
+        0.0f, 0.5f, -0.5f, 1.0f, -1.0f, 2.0f, -2.0f, 0.99999994f,
+        -0.99999994f, 1.0e10f, -1.0e10f, 0.25f, -0.25f, 1.0f, -1.0f,
+        2.0f, -2.0f,
+    };
+    static const int32_t expected_32[17] = {
+        0, 1073741824, -1073741824, 2147483647, -2147483647,
+        2147483647, -2147483647, 2147483519, -2147483519,
+        2147483647, -2147483647, 536870912, -536870912,
+        2147483647, -2147483647, 2147483647, -2147483647,
+    };
+    /* Halfway cases (such as 0.99999994 * 8388607 == 8388606.5 in single
+     * precision) round to even. */
+    static const int32_t expected_24[17] = {
+        0, 4194304, -4194304, 8388607, -8388607, 8388607, -8388607,
+        8388606, -8388606, 8388607, -8388607, 2097152, -2097152,
+        8388607, -8388607, 8388607, -8388607,
+    };
+
+    int32_t pcm_32[17];
+    float_to_int32(pcm_32, data, 17);
+    for (int i = 0; i < 17; i++) {
+        EXPECT_EQ(pcm_32[i], expected_32[i]);
+    }
+
+    uint8_t pcm_24[17*3];
+    float_to_int24(pcm_24, data, 17);
+    for (int i = 0; i < 17; i++) {
+        const int32_t value = (int32_t)((uint32_t)pcm_24[i*3+0] << 8
+                                        | (uint32_t)pcm_24[i*3+1] << 16
+                                        | (uint32_t)pcm_24[i*3+2] << 24) >> 8;
+        EXPECT_EQ(value, expected_24[i]);
+    }
+
+    /* Check the interleaving versions as well, with the second channel
+     * holding the same data in reverse order. */
+    ALIGN(64) static float data_rev[17];
+    for (int i = 0; i < 17; i++) {
+        data_rev[i] = data[16-i];
+    }
+    float *channels[2] = {(float *)data, data_rev};
+
+    ALIGN(64) static int32_t pcm_32x2[17*2];
+    float_to_int32_interleave_2(pcm_32x2, data, data_rev, 17);
+    for (int i = 0; i < 17; i++) {
+        EXPECT_EQ(pcm_32x2[i*2+0], expected_32[i]);
+        EXPECT_EQ(pcm_32x2[i*2+1], expected_32[16-i]);
+    }
+    memset(pcm_32x2, 0, sizeof(pcm_32x2));
+    float_to_int32_interleave(pcm_32x2, channels, 2, 17);
+    for (int i = 0; i < 17; i++) {
+        EXPECT_EQ(pcm_32x2[i*2+0], expected_32[i]);
+        EXPECT_EQ(pcm_32x2[i*2+1], expected_32[16-i]);
+    }
+
+    uint8_t pcm_24x2[17*2*3];
+    for (int pass = 0; pass < 2; pass++) {
+        memset(pcm_24x2, 0, sizeof(pcm_24x2));
+        if (pass == 0) {
+            float_to_int24_interleave_2(pcm_24x2, data, data_rev, 17);
+        } else {
+            float_to_int24_interleave(pcm_24x2, channels, 2, 17);
+        }
+        for (int i = 0; i < 17*2; i++) {
+            const int32_t value = (int32_t)((uint32_t)pcm_24x2[i*3+0] << 8
+                                            | (uint32_t)pcm_24x2[i*3+1] << 16
+                                            | (uint32_t)pcm_24x2[i*3+2] << 24)
+                                  >> 8;
+            EXPECT_EQ(value, expected_24[i%2 ? 16-i/2 : i/2]);
+        }
+    }
+
+    return EXIT_SUCCESS;
+}